@@ -12,9 +12,12 @@ public class FPSDemo : ModuleRules
 			"Core",
 			"CoreUObject",
 			"Engine",
+			"NetCore",
+			"ReplicationGraph",
 			"InputCore",
 			"EnhancedInput",
 			"AIModule",
+			"AnimationBudgetAllocator",
 			"StateTreeModule",
 			"GameplayStateTreeModule",
 			"UMG",
@@ -5,4 +5,5 @@
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, FPSDemo, "FPSDemo" );
 
-DEFINE_LOG_CATEGORY(LogFPSDemo)
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogFPSDemo)
+DEFINE_LOG_CATEGORY(LogShooterGameplay)
\ No newline at end of file
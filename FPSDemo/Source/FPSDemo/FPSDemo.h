@@ -3,6 +3,35 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
 /** Main log category used across the project */
-DECLARE_LOG_CATEGORY_EXTERN(LogFPSDemo, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(LogFPSDemo, Log, All);
+
+/** Shooter gameplay log (kills, scores, match flow). Verbose lines compile out of Shipping and Test builds */
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+DECLARE_LOG_CATEGORY_EXTERN(LogShooterGameplay, Log, Log);
+#else
+DECLARE_LOG_CATEGORY_EXTERN(LogShooterGameplay, Log, All);
+#endif
+
+/** Gameplay stats for the shooter variant */
+DECLARE_STATS_GROUP(TEXT("Shooter"), STATGROUP_Shooter, STATCAT_Advanced);
+
+/** Networking stats for the shooter variant */
+DECLARE_STATS_GROUP(TEXT("ShooterNet"), STATGROUP_ShooterNet, STATCAT_Advanced);
+
+namespace ShooterStats
+{
+	/** Returns the given percentile (0..1, nearest rank) of a sorted array. Shared by the latency and shot trace reports */
+	inline float Percentile(const TArray<float>& Sorted, float Percent)
+	{
+		if (Sorted.Num() == 0)
+		{
+			return 0.0f;
+		}
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percent * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+}
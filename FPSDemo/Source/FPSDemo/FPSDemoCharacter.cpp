@@ -5,34 +5,126 @@
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "IAnimationBudgetAllocator.h"
 #include "EnhancedInputComponent.h"
 #include "InputActionValue.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "FPSDemo.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
 
-AFPSDemoCharacter::AFPSDemoCharacter()
+namespace FPSDemoMeshReport
+{
+	/** Skeletal mesh component totals for one pawn, including its attached weapons */
+	struct FMeshCounts
+	{
+		int32 Components = 0;
+		int32 Ticking = 0;
+		int32 Visible = 0;
+		SIZE_T ResourceBytes = 0;
+
+		void Add(const AActor* Actor)
+		{
+			TInlineComponentArray<USkeletalMeshComponent*> MeshComponents(Actor);
+
+			for (USkeletalMeshComponent* MeshComponent : MeshComponents)
+			{
+				++Components;
+				Ticking += MeshComponent->IsComponentTickEnabled() ? 1 : 0;
+				Visible += MeshComponent->IsVisible() ? 1 : 0;
+				ResourceBytes += MeshComponent->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+		}
+	};
+
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("FPSDemo.MeshReport"),
+		TEXT("Logs skeletal mesh components, ticking and visible counts and exclusive resource size per pawn on this machine."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			FMeshCounts Total;
+			int32 NumPawns = 0;
+
+			for (TActorIterator<AFPSDemoCharacter> It(World); It; ++It)
+			{
+				FMeshCounts Counts;
+				Counts.Add(*It);
+
+				TArray<AActor*> AttachedActors;
+				It->GetAttachedActors(AttachedActors);
+
+				for (const AActor* AttachedActor : AttachedActors)
+				{
+					Counts.Add(AttachedActor);
+				}
+
+				UE_LOG(LogFPSDemo, Display, TEXT("%-40s %s meshes %d ticking %d visible %d exclusive %.1f KB"),
+					*It->GetName(), It->IsFirstPersonViewer() ? TEXT("first person") : TEXT("remote      "),
+					Counts.Components, Counts.Ticking, Counts.Visible, Counts.ResourceBytes / 1024.0f);
+
+				Total.Components += Counts.Components;
+				Total.Ticking += Counts.Ticking;
+				Total.Visible += Counts.Visible;
+				Total.ResourceBytes += Counts.ResourceBytes;
+				++NumPawns;
+			}
+
+			UE_LOG(LogFPSDemo, Display, TEXT("%d pawns: meshes %d ticking %d visible %d exclusive %.1f KB"),
+				NumPawns, Total.Components, Total.Ticking, Total.Visible, Total.ResourceBytes / 1024.0f);
+		}));
+}
+
+namespace FPSDemoFirstPersonCamera
+{
+	/** Arms socket the first person camera hangs off */
+	static const FName HeadSocketName(TEXT("head"));
+
+	/** Camera offset in head socket space */
+	static const FVector HeadOffset(-2.8f, 5.89f, 0.0f);
+}
+
+const FName AFPSDemoCharacter::FirstPersonMeshName(TEXT("First Person Mesh"));
+const FName AFPSDemoCharacter::FirstPersonCameraName(TEXT("First Person Camera"));
+
+AFPSDemoCharacter::AFPSDemoCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
 	// 设置碰撞胶囊体大小
 	GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
 	
 	// 创建第一人称网格（手臂模型，仅玩家自己可见）
-	FirstPersonMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("First Person Mesh"));
-	FirstPersonMesh->SetupAttachment(GetMesh());
-	FirstPersonMesh->SetOnlyOwnerSee(true);  // 仅拥有者可见
-	FirstPersonMesh->FirstPersonPrimitiveType = EFirstPersonPrimitiveType::FirstPerson;
-	FirstPersonMesh->SetCollisionProfileName(FName("NoCollision"));  // 无碰撞
+	FirstPersonMesh = CreateOptionalDefaultSubobject<USkeletalMeshComponent>(FirstPersonMeshName);
+	if (FirstPersonMesh)
+	{
+		FirstPersonMesh->SetupAttachment(GetMesh());
+		FirstPersonMesh->SetOnlyOwnerSee(true);  // 仅拥有者可见
+		FirstPersonMesh->FirstPersonPrimitiveType = EFirstPersonPrimitiveType::FirstPerson;
+		FirstPersonMesh->SetCollisionProfileName(FName("NoCollision"));  // 无碰撞
+	}
 
 	// 创建第一人称相机组件，附加到手臂网格的头部插槽
-	FirstPersonCameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("First Person Camera"));
-	FirstPersonCameraComponent->SetupAttachment(FirstPersonMesh, FName("head"));
-	FirstPersonCameraComponent->SetRelativeLocationAndRotation(FVector(-2.8f, 5.89f, 0.0f), FRotator(0.0f, 90.0f, -90.0f));
-	FirstPersonCameraComponent->bUsePawnControlRotation = true;  // 使用 Pawn 控制旋转
-	FirstPersonCameraComponent->bEnableFirstPersonFieldOfView = true;  // 启用第一人称 FOV
-	FirstPersonCameraComponent->bEnableFirstPersonScale = true;  // 启用第一人称缩放
-	FirstPersonCameraComponent->FirstPersonFieldOfView = 70.0f;  // 第一人称视野角度
-	FirstPersonCameraComponent->FirstPersonScale = 0.6f;  // 第一人称缩放比例
+	// 专用服务器不渲染，不创建相机，瞄准视点由 GetFirstPersonViewPoint 直接从头部插槽计算
+	// 手臂网格在服务器上仍然需要（头部插槽和武器枪口插槽都在第一人称骨架上）
+	FirstPersonCameraComponent = FirstPersonMesh && !IsRunningDedicatedServer() ? CreateOptionalDefaultSubobject<UCameraComponent>(FirstPersonCameraName) : nullptr;
+	if (FirstPersonCameraComponent)
+	{
+		FirstPersonCameraComponent->SetupAttachment(FirstPersonMesh, FPSDemoFirstPersonCamera::HeadSocketName);
+		FirstPersonCameraComponent->SetRelativeLocationAndRotation(FPSDemoFirstPersonCamera::HeadOffset, FRotator(0.0f, 90.0f, -90.0f));
+		FirstPersonCameraComponent->bUsePawnControlRotation = true;  // 使用 Pawn 控制旋转
+		FirstPersonCameraComponent->bEnableFirstPersonFieldOfView = true;  // 启用第一人称 FOV
+		FirstPersonCameraComponent->bEnableFirstPersonScale = true;  // 启用第一人称缩放
+		FirstPersonCameraComponent->FirstPersonFieldOfView = 70.0f;  // 第一人称视野角度
+		FirstPersonCameraComponent->FirstPersonScale = 0.6f;  // 第一人称缩放比例
+	}
 
 	// 配置第三人称网格（其他玩家看到的身体模型）
+	// 网格可以由动画预算分配器降频更新，由游戏代码决定何时注册（专用服务器不注册）
+	if (USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh()))
+	{
+		BudgetedMesh->SetAutoRegisterWithBudgetAllocator(false);
+	}
+
 	GetMesh()->SetOwnerNoSee(true);  // 拥有者不可见（避免手臂和身体重叠）
 	GetMesh()->FirstPersonPrimitiveType = EFirstPersonPrimitiveType::WorldSpaceRepresentation;
 
@@ -66,6 +158,89 @@ void AFPSDemoCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	}
 }
 
+void AFPSDemoCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UpdateMeshesForViewer();
+}
+
+void AFPSDemoCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	UpdateMeshesForViewer();
+}
+
+bool AFPSDemoCharacter::IsFirstPersonViewer() const
+{
+	return IsLocallyControlled() && IsPlayerControlled() && GetNetMode() != NM_DedicatedServer;
+}
+
+void AFPSDemoCharacter::GetFirstPersonViewPoint(FVector& OutLocation, FRotator& OutRotation) const
+{
+	if (FirstPersonCameraComponent)
+	{
+		OutLocation = FirstPersonCameraComponent->GetComponentLocation();
+		OutRotation = FirstPersonCameraComponent->GetComponentRotation();
+	}
+	else if (FirstPersonMesh)
+	{
+		// same point the camera would sit at. The camera follows the pawn control rotation, so its own rotation doesn't matter
+		OutLocation = FirstPersonMesh->GetSocketTransform(FPSDemoFirstPersonCamera::HeadSocketName).TransformPosition(FPSDemoFirstPersonCamera::HeadOffset);
+		OutRotation = GetViewRotation();
+	}
+	else
+	{
+		GetActorEyesViewPoint(OutLocation, OutRotation);
+	}
+}
+
+void AFPSDemoCharacter::UpdateMeshesForViewer()
+{
+	// 第一人称手臂只对本地玩家渲染。服务器从手臂的 head 插槽读取瞄准相机，
+	// 武器枪口也挂在手臂上，所以服务器上手臂隐藏但继续更新姿势和骨骼
+	SetMeshComponentRelevant(FirstPersonMesh, IsFirstPersonViewer(), HasAuthority());
+
+	// 专用服务器不渲染，第三人称网格只为蒙太奇（通知、根运动）更新姿势
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+	}
+}
+
+void AFPSDemoCharacter::SetMeshComponentRelevant(USkeletalMeshComponent* MeshComponent, bool bRelevant, bool bKeepPose)
+{
+	if (!MeshComponent)
+	{
+		return;
+	}
+
+	// 隐藏的图元不会被加入场景，停用 Tick 后也不再更新动画和骨骼
+	MeshComponent->SetVisibility(bRelevant);
+
+	// 隐藏但仍需要插槽变换的网格：不渲染时也更新姿势并刷新骨骼
+	if (!bRelevant && bKeepPose)
+	{
+		MeshComponent->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	}
+
+	const bool bTick = bRelevant || bKeepPose;
+
+	// 已注册到动画预算的网格由分配器管理 Tick
+	USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(MeshComponent);
+	IAnimationBudgetAllocator* Allocator = BudgetedMesh ? IAnimationBudgetAllocator::Get(MeshComponent->GetWorld()) : nullptr;
+
+	if (Allocator)
+	{
+		Allocator->SetComponentTickEnabled(BudgetedMesh, bTick);
+	}
+	else
+	{
+		MeshComponent->SetComponentTickEnabled(bTick);
+	}
+}
+
 /** 处理移动输入，将输入值转换为角色移动 */
 void AFPSDemoCharacter::MoveInput(const FInputActionValue& Value)
 {
@@ -52,8 +52,14 @@ protected:
 	class UInputAction* MouseLookAction;
 	
 public:
-	/** 构造函数，初始化第一人称角色的组件和配置 */
-	AFPSDemoCharacter();
+	/** 第一人称网格子对象名称（子类可通过 DoNotCreateDefaultSubobject 排除） */
+	static const FName FirstPersonMeshName;
+
+	/** 第一人称相机子对象名称（子类可通过 DoNotCreateDefaultSubobject 排除） */
+	static const FName FirstPersonCameraName;
+
+	/** 构造函数，初始化第一人称角色的组件和配置（第一人称网格和相机为可选子对象） */
+	AFPSDemoCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 protected:
 
@@ -83,14 +89,45 @@ protected:
 
 	/** 设置输入绑定（绑定 Enhanced Input 动作到对应的函数） */
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
+
+	/** 初始化时按本机视角配置网格组件 */
+	virtual void BeginPlay() override;
+
+	/** 控制器变化时（服务器占有/客户端收到控制器复制）重新配置网格组件 */
+	virtual void NotifyControllerChanged() override;
+
+	/**
+	 *  按本机视角启用或停用网格组件的渲染和动画更新
+	 *  - 第一人称网格只在本地玩家控制的角色上渲染；服务器上不渲染但继续更新姿势和骨骼（瞄准相机和枪口插槽都挂在第一人称骨架上）
+	 *  - 第三人称网格在客户端保留（远程观察者看到的身体，本地玩家的阴影）
+	 *  - 专用服务器不渲染任何网格，第三人称网格只在播放蒙太奇时更新姿势
+	 */
+	virtual void UpdateMeshesForViewer();
+
+public:
+
+	/**
+	 *  返回第一人称视点（瞄准的起点和方向）
+	 *  有相机时取相机变换；专用服务器没有相机，从手臂头部插槽加相机偏移计算，方向取控制旋转；没有第一人称骨架时取眼睛视点
+	 */
+	void GetFirstPersonViewPoint(FVector& OutLocation, FRotator& OutRotation) const;
+
+	/** 返回本机是否以第一人称观察此角色（本地玩家控制且会渲染） */
+	bool IsFirstPersonViewer() const;
+
+	/**
+	 *  启用或停用一个网格组件的渲染和组件 Tick（组件仍然保留，作为附加点和插槽变换来源）
+	 *  bKeepPose：不渲染时仍然更新姿势并刷新骨骼，用于服务器需要读取插槽变换的网格
+	 */
+	static void SetMeshComponentRelevant(USkeletalMeshComponent* MeshComponent, bool bRelevant, bool bKeepPose = false);
 	
 
 public:
 
-	/** Returns the first person mesh **/
+	/** Returns the first person mesh, or nullptr if this character has no first person rig **/
 	USkeletalMeshComponent* GetFirstPersonMesh() const { return FirstPersonMesh; }
 
-	/** Returns first person camera component **/
+	/** Returns first person camera component, or nullptr if this character has no first person rig or runs on a dedicated server **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
 
 };
@@ -3,10 +3,12 @@
 
 #include "Variant_Shooter/AI/ShooterAIController.h"
 #include "ShooterNPC.h"
+#include "ShooterAIPopulationSubsystem.h"
 #include "Components/StateTreeAIComponent.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "AI/Navigation/PathFollowingAgentInterface.h"
+#include "FPSDemo.h"
 
 AShooterAIController::AShooterAIController()
 {
@@ -21,6 +23,27 @@ AShooterAIController::AShooterAIController()
 	AIPerception->OnTargetPerceptionForgotten.AddDynamic(this, &AShooterAIController::OnPerceptionForgotten);
 }
 
+void AShooterAIController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// track this controller for the bulk pause, stop and restart operations
+	if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
+	{
+		Population->RegisterController(this);
+	}
+}
+
+void AShooterAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
+	{
+		Population->UnregisterController(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AShooterAIController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
@@ -36,6 +59,21 @@ void AShooterAIController::OnPossess(APawn* InPawn)
 		{
 			NPC->OnPawnDeath.AddDynamic(this, &AShooterAIController::OnPawnDeath);
 		}
+
+		if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
+		{
+			Population->SetControlledNPC(this, NPC);
+		}
+	}
+}
+
+void AShooterAIController::OnUnPossess()
+{
+	Super::OnUnPossess();
+
+	if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
+	{
+		Population->SetControlledNPC(this, nullptr);
 	}
 }
 
@@ -127,6 +165,72 @@ void AShooterAIController::StopAIBehavior(const FString& Reason)
 	}
 }
 
+void AShooterAIController::PauseAIBehavior(const FString& Reason)
+{
+	// 暂停移动（保留当前路径，恢复时继续）
+	if (GetPathFollowingComponent())
+	{
+		GetPathFollowingComponent()->PauseMove();
+	}
+
+	// 暂停 StateTree 逻辑
+	if (StateTreeAI)
+	{
+		StateTreeAI->PauseLogic(Reason.IsEmpty() ? FString("Paused") : Reason);
+	}
+
+	// 停止 NPC 射击
+	if (AShooterNPC* NPC = Cast<AShooterNPC>(GetPawn()))
+	{
+		NPC->StopShooting();
+	}
+}
+
+void AShooterAIController::ResumeAIBehavior(const FString& Reason)
+{
+	// 恢复 StateTree 逻辑
+	if (StateTreeAI)
+	{
+		StateTreeAI->ResumeLogic(Reason.IsEmpty() ? FString("Resumed") : Reason);
+	}
+
+	// 继续之前的移动
+	if (GetPathFollowingComponent())
+	{
+		GetPathFollowingComponent()->ResumeMove();
+	}
+}
+
+void AShooterAIController::RestartAIBehavior()
+{
+	// 清除当前目标
+	ClearCurrentTarget();
+
+	// 确保 NPC 停止射击（重要：防止重生后卡在射击状态）
+	if (AShooterNPC* NPC = Cast<AShooterNPC>(GetPawn()))
+	{
+		NPC->StopShooting();
+	}
+
+	// 停止并重启 StateTree（这会重置所有 StateTree 状态）
+	if(StateTreeAI)
+	{
+		StateTreeAI->StopLogic(TEXT("Respawn"));
+		StateTreeAI->StartLogic();
+		UE_LOG(LogShooterGameplay, Verbose, TEXT("StateTreeAI Restarted Successfully"));
+	}
+	else
+	{
+		UE_LOG(LogShooterGameplay, Warning, TEXT("StateTreeAI is null - cannot restart"));
+	}
+
+	// 重启会让 StateTree 重新运行，全部暂停期间（例如暂停时重生）需要重新加入暂停
+	if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
+	{
+		Population->OnBehaviorRestarted(this);
+	}
+}
+
 void AShooterAIController::RequestRepossess(AShooterNPC* NPC)
 {
 	if(!NPC) return;
@@ -139,27 +243,7 @@ void AShooterAIController::RequestRepossess(AShooterNPC* NPC)
 	else
 	{
 		// 如果已经占据了这个 Pawn，重置状态并重启 StateTree
-		
-		// 清除当前目标
-		ClearCurrentTarget();
-		
-		// 确保 NPC 停止射击（重要：防止重生后卡在射击状态）
-		if (NPC && NPC->IsValidLowLevel())
-		{
-			NPC->StopShooting();
-		}
-		
-		// 停止并重启 StateTree（这会重置所有 StateTree 状态）
-		if(StateTreeAI)
-		{
-			StateTreeAI->StopLogic(TEXT("Respawn"));
-			StateTreeAI->StartLogic();
-			UE_LOG(LogTemp, Display, TEXT("StateTreeAI Restarted Successfully"));
-		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("StateTreeAI is null - cannot restart"));
-		}
+		RestartAIBehavior();
 	}
 }
 
@@ -59,9 +59,18 @@ public:
 
 protected:
 
+	/** Registers with the AI population */
+	virtual void BeginPlay() override;
+
+	/** Unregisters from the AI population */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+	/** Tells the AI population the NPC is gone */
+	virtual void OnUnPossess() override;
+
 protected:
 
 	/** Called when the possessed pawn dies */
@@ -87,6 +96,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category="AI")
 	void StopAIBehavior(const FString& Reason = TEXT(""));
 
+	/** 暂停 AI 行为（StateTree 和路径跟随暂停，停止射击），可以用 ResumeAIBehavior 恢复 */
+	UFUNCTION(BlueprintCallable, Category="AI")
+	void PauseAIBehavior(const FString& Reason = TEXT(""));
+
+	/** 恢复被暂停的 AI 行为 */
+	UFUNCTION(BlueprintCallable, Category="AI")
+	void ResumeAIBehavior(const FString& Reason = TEXT(""));
+
+	/** 重置目标和射击状态并重启 StateTree（重生和回合重置时使用） */
+	UFUNCTION(BlueprintCallable, Category="AI")
+	void RestartAIBehavior();
+
 protected:
 
 	/** AI 感知更新回调：当感知到 Actor 或感知信息更新时调用（如看到玩家、听到声音） */
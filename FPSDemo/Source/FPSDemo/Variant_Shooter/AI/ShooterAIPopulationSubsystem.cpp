@@ -0,0 +1,318 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterAIPopulationSubsystem.h"
+#include "ShooterAIController.h"
+#include "ShooterNPC.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Population Bulk Operation"), STAT_ShooterAIPopulationBulk, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("AI Population Restarts"), STAT_ShooterAIPopulationRestarts, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered AI Controllers"), STAT_ShooterAIPopulationControllers, STATGROUP_Shooter);
+
+namespace ShooterAIPopulation
+{
+	static int32 RestartsPerFrame = 4;
+	static FAutoConsoleVariableRef CVarRestartsPerFrame(
+		TEXT("Shooter.AIPopulation.RestartsPerFrame"),
+		RestartsPerFrame,
+		TEXT("Maximum number of AI controllers restarted per frame by a time-sliced restart."));
+
+	static UShooterAIPopulationSubsystem* GetPopulation(UWorld* World)
+	{
+		return World ? World->GetSubsystem<UShooterAIPopulationSubsystem>() : nullptr;
+	}
+
+	static FAutoConsoleCommandWithWorld CmdPauseAll(
+		TEXT("Shooter.AIPopulation.PauseAll"),
+		TEXT("Pauses every shooter AI."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterAIPopulationSubsystem* Population = GetPopulation(World))
+			{
+				Population->PauseAll(TEXT("Console"));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld CmdResumeAll(
+		TEXT("Shooter.AIPopulation.ResumeAll"),
+		TEXT("Resumes every paused shooter AI."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterAIPopulationSubsystem* Population = GetPopulation(World))
+			{
+				Population->ResumeAll(TEXT("Console"));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs CmdRestartAll(
+		TEXT("Shooter.AIPopulation.RestartAll"),
+		TEXT("Restarts every shooter AI. Shooter.AIPopulation.RestartAll [TimeSliced=1]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UShooterAIPopulationSubsystem* Population = GetPopulation(World))
+			{
+				Population->RestartAll(Args.Num() == 0 || FCString::Atoi(*Args[0]) != 0);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs CmdStopTeam(
+		TEXT("Shooter.AIPopulation.StopTeam"),
+		TEXT("Stops the behavior of every shooter AI on a team. Shooter.AIPopulation.StopTeam <Team>"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UShooterAIPopulationSubsystem* Population = GetPopulation(World);
+			if (Population && Args.Num() > 0)
+			{
+				Population->StopTeam((uint8)FCString::Atoi(*Args[0]), TEXT("Console"));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld CmdReport(
+		TEXT("Shooter.AIPopulation.Report"),
+		TEXT("Logs every registered shooter AI with its NPC, team and pause state."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterAIPopulationSubsystem* Population = GetPopulation(World))
+			{
+				Population->LogReport();
+			}
+		}));
+}
+
+bool UShooterAIPopulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterAIPopulationSubsystem::RegisterController(AShooterAIController* Controller)
+{
+	if (!Controller || !Controller->HasAuthority() || FindEntry(Controller) != INDEX_NONE)
+	{
+		return;
+	}
+
+	FShooterAIEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Controller = Controller;
+	IndexByController.Add(Controller, Entries.Num() - 1);
+
+	// placed NPCs are possessed before their controller begins play
+	SetControlledNPC(Controller, Cast<AShooterNPC>(Controller->GetPawn()));
+
+	SET_DWORD_STAT(STAT_ShooterAIPopulationControllers, Entries.Num());
+}
+
+void UShooterAIPopulationSubsystem::UnregisterController(AShooterAIController* Controller)
+{
+	const int32 Index = FindEntry(Controller);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	IndexByController.Remove(Controller);
+
+	// swap the last entry into the hole and fix up its lookup
+	const int32 LastIndex = Entries.Num() - 1;
+	if (Index != LastIndex)
+	{
+		if (AShooterAIController* LastController = Entries[LastIndex].Controller.Get())
+		{
+			IndexByController.Add(LastController, Index);
+		}
+	}
+
+	Entries.RemoveAtSwap(Index);
+
+	SET_DWORD_STAT(STAT_ShooterAIPopulationControllers, Entries.Num());
+}
+
+void UShooterAIPopulationSubsystem::SetControlledNPC(AShooterAIController* Controller, AShooterNPC* NPC)
+{
+	const int32 Index = FindEntry(Controller);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	FShooterAIEntry& Entry = Entries[Index];
+	Entry.NPC = NPC;
+	Entry.TeamByte = NPC ? NPC->GetTeamByte() : 255;
+	Entry.bPaused = false;
+
+	// NPCs that respawn while everything is paused join the pause
+	if (NPC && bAllPaused)
+	{
+		Controller->PauseAIBehavior(TEXT("PopulationPaused"));
+		Entry.bPaused = true;
+	}
+}
+
+void UShooterAIPopulationSubsystem::OnBehaviorRestarted(AShooterAIController* Controller)
+{
+	const int32 Index = FindEntry(Controller);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// StartLogic runs a fresh tree, so a pause applied on possess no longer holds
+	FShooterAIEntry& Entry = Entries[Index];
+	Entry.bPaused = false;
+
+	if (bAllPaused && Entry.NPC.IsValid())
+	{
+		Controller->PauseAIBehavior(TEXT("PopulationPaused"));
+		Entry.bPaused = true;
+	}
+}
+
+void UShooterAIPopulationSubsystem::PauseAll(const FString& Reason)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAIPopulationBulk);
+
+	bAllPaused = true;
+
+	for (FShooterAIEntry& Entry : Entries)
+	{
+		AShooterAIController* Controller = Entry.Controller.Get();
+		if (Controller && Entry.NPC.IsValid() && !Entry.bPaused)
+		{
+			Controller->PauseAIBehavior(Reason);
+			Entry.bPaused = true;
+		}
+	}
+}
+
+void UShooterAIPopulationSubsystem::ResumeAll(const FString& Reason)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAIPopulationBulk);
+
+	bAllPaused = false;
+
+	for (FShooterAIEntry& Entry : Entries)
+	{
+		AShooterAIController* Controller = Entry.Controller.Get();
+		if (Controller && Entry.bPaused)
+		{
+			Controller->ResumeAIBehavior(Reason);
+		}
+
+		Entry.bPaused = false;
+	}
+}
+
+void UShooterAIPopulationSubsystem::StopAll(const FString& Reason)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAIPopulationBulk);
+
+	PendingRestarts.Reset();
+
+	for (FShooterAIEntry& Entry : Entries)
+	{
+		if (AShooterAIController* Controller = Entry.Controller.Get())
+		{
+			Controller->StopAIBehavior(Reason);
+		}
+
+		Entry.bPaused = false;
+	}
+}
+
+void UShooterAIPopulationSubsystem::StopTeam(uint8 TeamByte, const FString& Reason)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAIPopulationBulk);
+
+	for (FShooterAIEntry& Entry : Entries)
+	{
+		if (Entry.TeamByte != TeamByte)
+		{
+			continue;
+		}
+
+		if (AShooterAIController* Controller = Entry.Controller.Get())
+		{
+			Controller->StopAIBehavior(Reason);
+		}
+
+		Entry.bPaused = false;
+	}
+}
+
+void UShooterAIPopulationSubsystem::RestartAll(bool bTimeSliced)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAIPopulationBulk);
+
+	bAllPaused = false;
+	PendingRestarts.Reset(Entries.Num());
+
+	for (FShooterAIEntry& Entry : Entries)
+	{
+		Entry.bPaused = false;
+
+		// controllers waiting for their NPC to respawn restart on repossess
+		if (!Entry.NPC.IsValid())
+		{
+			continue;
+		}
+
+		if (bTimeSliced)
+		{
+			PendingRestarts.Add(Entry.Controller);
+		}
+		else if (AShooterAIController* Controller = Entry.Controller.Get())
+		{
+			Controller->RestartAIBehavior();
+		}
+	}
+}
+
+void UShooterAIPopulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingRestarts.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAIPopulationRestarts);
+
+	// restart from the back so the queue never shifts
+	const int32 NumToRestart = FMath::Min(PendingRestarts.Num(), FMath::Max(1, ShooterAIPopulation::RestartsPerFrame));
+
+	for (int32 Count = 0; Count < NumToRestart; ++Count)
+	{
+		if (AShooterAIController* Controller = PendingRestarts.Pop(EAllowShrinking::No).Get())
+		{
+			Controller->RestartAIBehavior();
+		}
+	}
+}
+
+TStatId UShooterAIPopulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterAIPopulationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UShooterAIPopulationSubsystem::FindEntry(const AShooterAIController* Controller) const
+{
+	const int32* Index = Controller ? IndexByController.Find(Controller) : nullptr;
+	return Index ? *Index : INDEX_NONE;
+}
+
+void UShooterAIPopulationSubsystem::LogReport() const
+{
+	UE_LOG(LogFPSDemo, Display, TEXT("%d registered AI controllers, %d pending restarts%s:"),
+		Entries.Num(), PendingRestarts.Num(), bAllPaused ? TEXT(", all paused") : TEXT(""));
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		const FShooterAIEntry& Entry = Entries[Index];
+		UE_LOG(LogFPSDemo, Display, TEXT("  [%d] %s npc=%s team=%d%s"),
+			Index, *GetNameSafe(Entry.Controller.Get()), *GetNameSafe(Entry.NPC.Get()), Entry.TeamByte, Entry.bPaused ? TEXT(" paused") : TEXT(""));
+	}
+}
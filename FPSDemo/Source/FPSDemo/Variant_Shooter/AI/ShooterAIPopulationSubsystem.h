@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "ShooterAIPopulationSubsystem.generated.h"
+
+class AShooterAIController;
+class AShooterNPC;
+
+/** 一个已注册的 AI 控制器和它当前控制的 NPC */
+struct FShooterAIEntry
+{
+	/** AI 控制器 */
+	TWeakObjectPtr<AShooterAIController> Controller;
+
+	/** 当前控制的 NPC（死亡等待重生时为空） */
+	TWeakObjectPtr<AShooterNPC> NPC;
+
+	/** NPC 的团队（占有时缓存，批量按团队操作时不需要访问 NPC） */
+	uint8 TeamByte = 255;
+
+	/** 是否处于暂停状态 */
+	bool bPaused = false;
+};
+
+/**
+ *  AI 种群子系统，仅在服务器运行
+ *  功能：
+ *  - 在连续数组中跟踪所有存活的射击 AI 控制器和它们控制的 NPC（控制器 BeginPlay/EndPlay 注册注销，占有时更新 NPC）
+ *  - 批量操作：全部暂停、全部恢复、全部停止、按团队停止，游戏结束和回合重置的开销不再依赖 Actor 遍历
+ *  - 全部重启可以分帧执行，每帧最多重启 Shooter.AIPopulation.RestartsPerFrame 个，避免 StateTree 同时启动的尖峰
+ *  - 全部暂停期间重新占有的 NPC（重生）会立即进入暂停状态
+ *  - 控制台命令：Shooter.AIPopulation.PauseAll / ResumeAll / RestartAll / StopTeam <团队> / Report
+ */
+UCLASS()
+class FPSDEMO_API UShooterAIPopulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 注册一个 AI 控制器 */
+	void RegisterController(AShooterAIController* Controller);
+
+	/** 注销一个 AI 控制器 */
+	void UnregisterController(AShooterAIController* Controller);
+
+	/** 控制器占有或取消占有 NPC 时更新（NPC 为空表示取消占有） */
+	void SetControlledNPC(AShooterAIController* Controller, AShooterNPC* NPC);
+
+	/** 控制器重启 StateTree 后调用（重启会清掉之前的暂停，全部暂停期间需要重新暂停） */
+	void OnBehaviorRestarted(AShooterAIController* Controller);
+
+	/** 暂停所有 AI（StateTree 和路径跟随暂停，停止射击） */
+	void PauseAll(const FString& Reason);
+
+	/** 恢复所有暂停的 AI */
+	void ResumeAll(const FString& Reason);
+
+	/** 停止所有 AI 的行为 */
+	void StopAll(const FString& Reason);
+
+	/** 停止指定团队所有 AI 的行为 */
+	void StopTeam(uint8 TeamByte, const FString& Reason);
+
+	/** 重启所有控制着 NPC 的 AI，bTimeSliced 时分帧执行 */
+	void RestartAll(bool bTimeSliced = true);
+
+	/** 返回已注册的 AI 控制器数量 */
+	int32 Num() const { return Entries.Num(); }
+
+	/** 返回还在等待分帧重启的 AI 数量 */
+	int32 GetNumPendingRestarts() const { return PendingRestarts.Num(); }
+
+	/** 输出已注册的 AI */
+	void LogReport() const;
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Runs the time-sliced restarts */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 返回控制器的下标，未注册时返回 INDEX_NONE */
+	int32 FindEntry(const AShooterAIController* Controller) const;
+
+	/** 已注册的 AI（连续存储） */
+	TArray<FShooterAIEntry> Entries;
+
+	/** 控制器到下标 */
+	TMap<TObjectKey<AShooterAIController>, int32> IndexByController;
+
+	/** 等待分帧重启的控制器 */
+	TArray<TWeakObjectPtr<AShooterAIController>> PendingRestarts;
+
+	/** 是否处于全部暂停状态 */
+	bool bAllPaused = false;
+};
@@ -0,0 +1,230 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterMovementLODSubsystem.h"
+#include "ShooterNPC.h"
+#include "ShooterNPCMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Movement LOD Update"), STAT_ShooterMovementLODUpdate, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPCs at Full Movement LOD"), STAT_ShooterMovementLODFull, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPCs at Mid Movement LOD"), STAT_ShooterMovementLODMid, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPCs at Far Movement LOD"), STAT_ShooterMovementLODFar, STATGROUP_Shooter);
+
+namespace ShooterMovementLOD
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Shooter.MovementLOD.Enabled"),
+		bEnabled,
+		TEXT("If false, every NPC uses the full movement simulation."));
+
+	static int32 ForceLOD = -1;
+	static FAutoConsoleVariableRef CVarForceLOD(
+		TEXT("Shooter.MovementLOD.ForceLOD"),
+		ForceLOD,
+		TEXT("Forces every NPC to one movement LOD (0 = full, 1 = mid, 2 = far). -1 picks by distance."));
+
+	static float UpdateInterval = 0.25f;
+	static FAutoConsoleVariableRef CVarUpdateInterval(
+		TEXT("Shooter.MovementLOD.UpdateInterval"),
+		UpdateInterval,
+		TEXT("Seconds between movement LOD evaluations."));
+
+	static float FullDistance = 2500.0f;
+	static FAutoConsoleVariableRef CVarFullDistance(
+		TEXT("Shooter.MovementLOD.FullDistance"),
+		FullDistance,
+		TEXT("NPCs closer than this to a player use the full movement simulation, in cm."));
+
+	static float MidDistance = 6000.0f;
+	static FAutoConsoleVariableRef CVarMidDistance(
+		TEXT("Shooter.MovementLOD.MidDistance"),
+		MidDistance,
+		TEXT("NPCs closer than this to a player use nav walking. Farther NPCs also update sparsely, in cm."));
+
+	static float Hysteresis = 500.0f;
+	static FAutoConsoleVariableRef CVarHysteresis(
+		TEXT("Shooter.MovementLOD.Hysteresis"),
+		Hysteresis,
+		TEXT("Extra distance an NPC must move past a threshold before dropping to a lower movement LOD, in cm."));
+
+	static const TCHAR* LODNames[(int32)EShooterMovementLOD::Num] = { TEXT("Full"), TEXT("Mid"), TEXT("Far") };
+
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("Shooter.MovementLOD.Report"),
+		TEXT("Logs the server movement CPU cost per NPC for each movement LOD in this world since the last reset."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UShooterMovementLODSubsystem* Subsystem = World ? World->GetSubsystem<UShooterMovementLODSubsystem>() : nullptr)
+			{
+				Subsystem->LogTimingReport();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("Shooter.MovementLOD.ResetStats"),
+		TEXT("Clears the movement LOD timings of this world."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterMovementLODSubsystem* Subsystem = World ? World->GetSubsystem<UShooterMovementLODSubsystem>() : nullptr)
+			{
+				Subsystem->ResetTimings();
+			}
+		}));
+}
+
+bool UShooterMovementLODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterMovementLODSubsystem::RegisterNPC(AShooterNPC* NPC)
+{
+	if (NPC && NPC->HasAuthority())
+	{
+		NPCs.AddUnique(NPC);
+
+		// pick a LOD before the first movement tick
+		TimeUntilUpdate = 0.0f;
+	}
+}
+
+void UShooterMovementLODSubsystem::UnregisterNPC(AShooterNPC* NPC)
+{
+	NPCs.RemoveSwap(NPC);
+}
+
+void UShooterMovementLODSubsystem::RecordMovementTick(EShooterMovementLOD LOD, uint64 Cycles, float DeltaTime)
+{
+	FShooterMovementLODTiming& Timing = Timings[(int32)LOD];
+	Timing.Cycles += Cycles;
+	Timing.NPCSeconds += DeltaTime;
+	++Timing.Ticks;
+}
+
+void UShooterMovementLODSubsystem::LogTimingReport() const
+{
+	for (int32 Index = 0; Index < (int32)EShooterMovementLOD::Num; ++Index)
+	{
+		const FShooterMovementLODTiming& Timing = Timings[Index];
+		const double Microseconds = FPlatformTime::ToSeconds64(Timing.Cycles) * 1000000.0;
+
+		UE_LOG(LogFPSDemo, Display, TEXT("%-4s ticks %8llu  %7.2f us per tick  %8.2f us per NPC-second"),
+			ShooterMovementLOD::LODNames[Index], Timing.Ticks,
+			Timing.Ticks > 0 ? Microseconds / Timing.Ticks : 0.0,
+			Timing.NPCSeconds > 0.0 ? Microseconds / Timing.NPCSeconds : 0.0);
+	}
+}
+
+void UShooterMovementLODSubsystem::ResetTimings()
+{
+	for (FShooterMovementLODTiming& Timing : Timings)
+	{
+		Timing = FShooterMovementLODTiming();
+	}
+}
+
+void UShooterMovementLODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (NPCs.Num() == 0)
+	{
+		return;
+	}
+
+	TimeUntilUpdate -= DeltaTime;
+	if (TimeUntilUpdate <= 0.0f)
+	{
+		TimeUntilUpdate = ShooterMovementLOD::UpdateInterval;
+		UpdateMovementLODs();
+	}
+}
+
+TStatId UShooterMovementLODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterMovementLODSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterMovementLODSubsystem::UpdateMovementLODs()
+{
+	using namespace ShooterMovementLOD;
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterMovementLODUpdate);
+
+	// gather the player locations
+	TArray<FVector, TInlineAllocator<16>> PlayerLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* PlayerPawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(PlayerPawn->GetActorLocation());
+		}
+	}
+
+	int32 NumPerLOD[(int32)EShooterMovementLOD::Num] = {};
+
+	for (int32 Index = NPCs.Num() - 1; Index >= 0; --Index)
+	{
+		AShooterNPC* NPC = NPCs[Index].Get();
+		if (!NPC)
+		{
+			NPCs.RemoveAtSwap(Index);
+			continue;
+		}
+
+		UShooterNPCMovementComponent* Movement = Cast<UShooterNPCMovementComponent>(NPC->GetCharacterMovement());
+		if (!Movement || NPC->IsDead())
+		{
+			continue;
+		}
+
+		EShooterMovementLOD NewLOD = EShooterMovementLOD::Full;
+
+		if (ForceLOD >= 0)
+		{
+			NewLOD = (EShooterMovementLOD)FMath::Min(ForceLOD, (int32)EShooterMovementLOD::Num - 1);
+		}
+		else if (bEnabled && PlayerLocations.Num() > 0)
+		{
+			float NearestDistSquared = UE_BIG_NUMBER;
+			for (const FVector& PlayerLocation : PlayerLocations)
+			{
+				NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(PlayerLocation, NPC->GetActorLocation()));
+			}
+
+			// stay at a higher LOD until we're clearly past its threshold
+			const EShooterMovementLOD CurrentLOD = Movement->GetMovementLOD();
+			const float FullLimit = FullDistance + (CurrentLOD == EShooterMovementLOD::Full ? Hysteresis : 0.0f);
+			const float MidLimit = MidDistance + (CurrentLOD != EShooterMovementLOD::Far ? Hysteresis : 0.0f);
+
+			if (NearestDistSquared > FMath::Square(MidLimit))
+			{
+				NewLOD = EShooterMovementLOD::Far;
+			}
+			else if (NearestDistSquared > FMath::Square(FullLimit))
+			{
+				NewLOD = EShooterMovementLOD::Mid;
+			}
+
+			// shooters need to keep up with their target
+			if (NewLOD == EShooterMovementLOD::Far && NPC->IsShooting())
+			{
+				NewLOD = EShooterMovementLOD::Mid;
+			}
+		}
+
+		Movement->SetMovementLOD(NewLOD);
+		++NumPerLOD[(int32)NewLOD];
+	}
+
+	SET_DWORD_STAT(STAT_ShooterMovementLODFull, NumPerLOD[(int32)EShooterMovementLOD::Full]);
+	SET_DWORD_STAT(STAT_ShooterMovementLODMid, NumPerLOD[(int32)EShooterMovementLOD::Mid]);
+	SET_DWORD_STAT(STAT_ShooterMovementLODFar, NumPerLOD[(int32)EShooterMovementLOD::Far]);
+}
@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterNPCMovementComponent.h"
+#include "ShooterMovementLODSubsystem.generated.h"
+
+class AShooterNPC;
+
+/** 一个移动精度等级累计的服务器移动开销 */
+struct FShooterMovementLODTiming
+{
+	/** 移动 Tick 的 CPU 周期数 */
+	uint64 Cycles = 0;
+
+	/** 移动 Tick 次数 */
+	uint64 Ticks = 0;
+
+	/** 模拟的时间（秒，所有 NPC 累加） */
+	double NPCSeconds = 0.0;
+};
+
+/**
+ *  NPC 移动精度（LOD）子系统，仅在服务器运行
+ *  功能：
+ *  - 定期按到最近玩家的距离为每个 NPC 选择移动精度：近处完整模拟，中距离导航网格行走，远处低频更新
+ *  - 降级需要超出阈值一段额外距离（滞后），避免在边界上来回切换
+ *  - 正在射击的 NPC 至少使用中等精度
+ *  - Shooter.MovementLOD.ForceLOD 可以把所有 NPC 固定在一个等级，配合 Shooter.MovementLOD.Report 做基准测试
+ *  - 按等级累计本世界的移动 Tick 耗时（每个世界单独统计，PIE 多窗口时互不混合）
+ *  - 客户端的模拟代理不分级，平滑和代理 Tick 始终按完整精度运行
+ */
+UCLASS()
+class FPSDEMO_API UShooterMovementLODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 注册一个 NPC */
+	void RegisterNPC(AShooterNPC* NPC);
+
+	/** 注销一个 NPC */
+	void UnregisterNPC(AShooterNPC* NPC);
+
+	/** 记录一次移动 Tick 的耗时 */
+	void RecordMovementTick(EShooterMovementLOD LOD, uint64 Cycles, float DeltaTime);
+
+	/** 输出各等级每个 NPC 的移动耗时 */
+	void LogTimingReport() const;
+
+	/** 清空累计的移动耗时 */
+	void ResetTimings();
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Periodically reevaluates the NPC movement LODs */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 为所有 NPC 重新选择移动精度 */
+	void UpdateMovementLODs();
+
+	/** 已注册的 NPC */
+	TArray<TWeakObjectPtr<AShooterNPC>> NPCs;
+
+	/** 距离下次评估的时间 */
+	float TimeUntilUpdate = 0.0f;
+
+	/** 各等级累计的移动耗时 */
+	FShooterMovementLODTiming Timings[(int32)EShooterMovementLOD::Num];
+};
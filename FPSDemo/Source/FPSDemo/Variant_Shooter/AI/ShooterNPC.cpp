@@ -5,15 +5,51 @@
 #include "ShooterWeapon.h"
 #include "ShooterCharacter.h"  // Needed for AShooterCharacter
 #include "Components/SkeletalMeshComponent.h"
-#include "Camera/CameraComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
 #include "ShooterGameMode.h"
+#include "ShooterSpawnPointSubsystem.h"
+#include "ShooterDamageSubsystem.h"
+#include "ShooterCombatantSubsystem.h"
+#include "ShooterAnimationBudgetSubsystem.h"
+#include "ShooterMovementLODSubsystem.h"
+#include "ShooterRoundSubsystem.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterTelemetry.h"
+#include "ShooterGameplayTrace.h"
+#include "ShooterNPCMovementComponent.h"
 #include "ShooterAIController.h"  // Include the AI controller header
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "TimerManager.h"
+#include "ShooterTimerSubsystem.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "FPSDemo.h"
+
+AShooterNPC::AShooterNPC(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer
+		.DoNotCreateDefaultSubobject(AFPSDemoCharacter::FirstPersonMeshName)
+		.DoNotCreateDefaultSubobject(AFPSDemoCharacter::FirstPersonCameraName)
+		.SetDefaultSubobjectClass<UShooterNPCMovementComponent>(ACharacter::CharacterMovementComponentName))
+{
+}
+
+FVector AShooterNPC::GetEyeLocation() const
+{
+	// the eye socket follows the third person animation
+	if (GetMesh()->DoesSocketExist(EyeSocketName))
+	{
+		return GetMesh()->GetSocketLocation(EyeSocketName) + GetActorRotation().RotateVector(EyeOffset);
+	}
+
+	return GetActorLocation() + FVector(0.0f, 0.0f, BaseEyeHeight) + GetActorRotation().RotateVector(EyeOffset);
+}
+
+void AShooterNPC::GetActorEyesViewPoint(FVector& OutLocation, FRotator& OutRotation) const
+{
+	OutLocation = GetEyeLocation();
+	OutRotation = GetBaseAimRotation();
+}
 
 void AShooterNPC::BeginPlay()
 {
@@ -21,11 +57,32 @@ void AShooterNPC::BeginPlay()
 
 	//记录NPC出生地点
 	StartTransform = GetActorTransform();
+
+	// remember the spawn so a round reset can restore or respawn this NPC in place
+	if (UShooterRoundSubsystem* Round = GetWorld()->GetSubsystem<UShooterRoundSubsystem>())
+	{
+		Round->RegisterNPC(this, StartTransform);
+	}
 	
 	// Enable replication
 	bReplicates = true;
 	SetReplicateMovement(true);
 
+	// publish the initial HP and team
+	UpdateCombatState();
+
+	// update the third person mesh at a rate based on its significance
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->RegisterPawn(this);
+	}
+
+	// simulate movement at a fidelity based on the distance to players
+	if (UShooterMovementLODSubsystem* MovementLOD = GetWorld()->GetSubsystem<UShooterMovementLODSubsystem>())
+	{
+		MovementLOD->RegisterNPC(this);
+	}
+
 	// spawn the weapon
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.Owner = this;
@@ -43,15 +100,37 @@ void AShooterNPC::BeginPlay()
 	}
 }
 
+void AShooterNPC::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	// keep the registry's controller lookup current on possess and unpossess
+	UpdateCombatantRegistry();
+}
+
 void AShooterNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the death timer
-	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
-	
-	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	// stop budgeting our meshes
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->UnregisterPawn(this);
+	}
+
+	if (UShooterMovementLODSubsystem* MovementLOD = GetWorld()->GetSubsystem<UShooterMovementLODSubsystem>())
+	{
+		MovementLOD->UnregisterNPC(this);
+	}
+
+	if (UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		Combatants->UnregisterCombatant(this);
+	}
+
+	// clear the death and respawn timers
+	UShooterTimerSubsystem::ClearWorldTimer(this, DeathTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, RespawnTimer);
 }
 
 float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -68,14 +147,48 @@ float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEve
 		return 0.0f;
 	}
 
+	// damage is merged per frame and resolved after all actors have ticked
+	if (UShooterDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UShooterDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(this, Damage, EventInstigator, DamageCauser);
+	}
+	else
+	{
+		ApplyAccumulatedDamage(Damage, EventInstigator);
+	}
+
+	return Damage;
+}
+
+bool AShooterNPC::ApplyAccumulatedDamage(float Damage, AController* LastInstigator)
+{
+	// we may have died while the damage was queued
+	if (bIsDead)
+	{
+		return false;
+	}
+
 	// Store the instigator for kill tracking
-	if (EventInstigator)
+	if (LastInstigator)
 	{
-		LastDamageInstigator = EventInstigator;
+		LastDamageInstigator = LastInstigator;
 	}
 
 	// Reduce HP
 	CurrentHP -= Damage;
+	UpdateCombatState();
+
+	// let spawn point selection avoid active fights
+	if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+	{
+		SpawnPoints->ReportCombat(GetActorLocation());
+	}
+
+	// damaged NPCs animate at a higher budget priority
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->ReportCombat(this);
+	}
 
 	// Have we depleted HP?
 	if (CurrentHP <= 0.0f)
@@ -83,7 +196,18 @@ float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEve
 		Die();
 	}
 
-	return Damage;
+	return bIsDead;
+}
+
+float AShooterNPC::GetApplicableDamage(float Damage) const
+{
+	if (bIsDead)
+	{
+		return 0.0f;
+	}
+
+	// overkill doesn't count
+	return FMath::Clamp(Damage, 0.0f, FMath::Max(CurrentHP, 0.0f));
 }
 
 void AShooterNPC::AttachWeaponMeshes(AShooterWeapon* WeaponToAttach)
@@ -93,9 +217,10 @@ void AShooterNPC::AttachWeaponMeshes(AShooterWeapon* WeaponToAttach)
 	// attach the weapon actor
 	WeaponToAttach->AttachToActor(this, AttachmentRule);
 
-	// attach the weapon meshes
-	WeaponToAttach->GetFirstPersonMesh()->AttachToComponent(GetFirstPersonMesh(), AttachmentRule, FirstPersonWeaponSocket);
-	WeaponToAttach->GetThirdPersonMesh()->AttachToComponent(GetMesh(), AttachmentRule, FirstPersonWeaponSocket);
+	// attach the weapon meshes. We have no first person rig, so the first person weapon mesh
+	// (which provides the muzzle socket) follows the third person hands as well
+	WeaponToAttach->GetFirstPersonMesh()->AttachToComponent(GetMesh(), AttachmentRule, ThirdPersonWeaponSocket);
+	WeaponToAttach->GetThirdPersonMesh()->AttachToComponent(GetMesh(), AttachmentRule, ThirdPersonWeaponSocket);
 }
 
 void AShooterNPC::PlayFiringMontage(UAnimMontage* Montage)
@@ -115,8 +240,8 @@ void AShooterNPC::UpdateWeaponHUD(int32 CurrentAmmo, int32 MagazineSize)
 
 FVector AShooterNPC::GetWeaponTargetLocation()
 {
-	// start aiming from the camera location
-	const FVector AimSource = GetFirstPersonCameraComponent()->GetComponentLocation();
+	// start aiming from the eye location
+	const FVector AimSource = GetEyeLocation();
 
 	FVector AimDir, AimTarget = FVector::ZeroVector;
 
@@ -136,8 +261,8 @@ FVector AShooterNPC::GetWeaponTargetLocation()
 		
 	} else {
 
-		// no aim target, so just use the camera facing
-		AimDir = UKismetMathLibrary::RandomUnitVectorInConeInDegrees(GetFirstPersonCameraComponent()->GetForwardVector(), AimVarianceHalfAngle);
+		// no aim target, so just use the aim facing
+		AimDir = UKismetMathLibrary::RandomUnitVectorInConeInDegrees(GetBaseAimRotation().Vector(), AimVarianceHalfAngle);
 
 	}
 
@@ -228,14 +353,29 @@ void AShooterNPC::Die()
 	// 停止射击（重要：死亡时确保停止所有射击动作）
 	StopShooting();
 
+	// 记住控制器（AI 控制器会在死亡时取消占有）
+	RespawnController = GetController();
+
+	// 发布击杀和死亡事件
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		Events->PublishCombat(EShooterGameplayEventType::Kill, LastDamageInstigator, this);
+		Events->PublishCombat(EShooterGameplayEventType::Death, LastDamageInstigator, this, bCanRespawn ? RespawnTime : 0.0f);
+	}
+
+	// record the kill and death telemetry, NPCs show up as PlayerId -1 with their team
+	if (UShooterTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UShooterTelemetrySubsystem>())
+	{
+		Telemetry->RecordKill(LastDamageInstigator, this);
+	}
+
 	// 设置死亡标志
 	bIsDead = true;
+	UpdateCombatState();
 
 	// Record statistics
 	if (AShooterGameMode* GM = Cast<AShooterGameMode>(GetWorld()->GetAuthGameMode()))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] NPC died - Team: %d"), TeamByte);
-		
 		// Record kill for the killer (NPCs don't have PlayerController, so only record if killer is a player)
 		if (LastDamageInstigator)
 		{
@@ -246,55 +386,25 @@ void AShooterNPC::Die()
 		}
 
 		// 增加击杀者团队的得分（不是 NPC 自己的团队得分！）
-		// 获取击杀者的团队ID（从造成伤害的控制器获取其控制的角色的团队）
+		// 获取击杀者的团队ID（按造成伤害的控制器在战斗者注册表中查找，不需要 Cast 击杀者的角色）
 		uint8 KillerTeamByte = 255;
-		FString KillerType = TEXT("Unknown");
-		
-		if (LastDamageInstigator && LastDamageInstigator->GetPawn())
-		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] LastDamageInstigator: %s, Pawn: %s"), 
-				*GetNameSafe(LastDamageInstigator), *GetNameSafe(LastDamageInstigator->GetPawn()));
-			
-			// 尝试从击杀者角色获取团队ID
-			if (AShooterCharacter* KillerCharacter = Cast<AShooterCharacter>(LastDamageInstigator->GetPawn()))
-			{
-				KillerTeamByte = KillerCharacter->GetTeamByte();
-				KillerType = TEXT("ShooterCharacter");
-				UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] Killer is ShooterCharacter, TeamByte: %d"), KillerTeamByte);
-			}
-			// 如果是另一个 NPC 击杀的，也获取其团队ID
-			else if (AShooterNPC* KillerNPC = Cast<AShooterNPC>(LastDamageInstigator->GetPawn()))
-			{
-				KillerTeamByte = KillerNPC->GetTeamByte();
-				KillerType = TEXT("ShooterNPC");
-				UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] Killer is ShooterNPC, TeamByte: %d"), KillerTeamByte);
-			}
-		}
-		else
+
+		if (UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] LastDamageInstigator or Pawn is null"));
+			KillerTeamByte = Combatants->GetTeamForController(LastDamageInstigator);
 		}
 
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] ===== NPC KILL SCORE LOGIC ====="));
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] NPC TeamByte: %d, Killer TeamByte: %d, Killer Type: %s"), 
-			TeamByte, KillerTeamByte, *KillerType);
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] KillerTeamByte != 255: %d"), (KillerTeamByte != 255));
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] KillerTeamByte != TeamByte: %d"), (KillerTeamByte != TeamByte));
-
 		// 只有当击杀者和被击杀者属于不同团队时才增加得分
 		// 注意：这里应该增加击杀者的团队得分，而不是 NPC 自己的团队得分！
-		if (KillerTeamByte != 255 && KillerTeamByte != TeamByte)
+		const bool bScored = KillerTeamByte != 255 && KillerTeamByte != TeamByte;
+
+		// 记录击杀结算（默认不格式化，见 ShooterGameplayTrace.h）
+		ShooterGameplayLog::LogKill(TEXT("ShooterNPC::Die"), this, LastDamageInstigator, TeamByte, KillerTeamByte, bScored);
+
+		if (bScored)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] ✓ Incrementing score for KILLER team %d (killer) vs NPC team %d (victim)"), 
-				KillerTeamByte, TeamByte);
 			GM->IncrementTeamScore(KillerTeamByte);  // 修复：增加击杀者的团队得分
 		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] ✗ Not incrementing score - KillerTeam: %d, VictimTeam: %d"), 
-				KillerTeamByte, TeamByte);
-		}
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterNPC::Die] =================================="));
 	}
 
 	// disable capsule collision
@@ -313,12 +423,12 @@ void AShooterNPC::Die()
 	if (bCanRespawn && RespawnTime > 0.0f)
 	{
 		// schedule respawn
-		GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterNPC::Respawn, RespawnTime, false);
+		UShooterTimerSubsystem::SetWorldTimer(RespawnTimer, this, &AShooterNPC::Respawn, RespawnTime, false);
 	}
 	else
 	{
 		// schedule actor destruction
-		GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
+		UShooterTimerSubsystem::SetWorldTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
 	}
 }
 
@@ -328,6 +438,19 @@ void AShooterNPC::DeferredDestruction()
 }
 
 void AShooterNPC::Respawn()
+{
+	RestoreSpawnState();
+
+	// 通知重生完成
+	OnAfterRespawn();
+
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		Events->PublishCombat(EShooterGameplayEventType::Respawn, nullptr, this);
+	}
+}
+
+void AShooterNPC::RestoreSpawnState()
 {
 	// 将 NPC 传送回出生点
 	FTransform RespawnTransform = StartTransform;
@@ -339,6 +462,7 @@ void AShooterNPC::Respawn()
 	// 重置生命值
 	CurrentHP = 100.0f; // 或者使用最大生命值
 	bIsDead = false;
+	UpdateCombatState();
 
 	// 重置射击相关状态（重要：防止重生后卡在射击状态）
 	bIsShooting = false;
@@ -386,9 +510,6 @@ void AShooterNPC::Respawn()
 	// 确保 NPC 正确启用
 	SetActorHiddenInGame(false);
 	SetActorEnableCollision(true);
-	
-	// 通知重生完成
-	OnAfterRespawn();
 }
 
 void AShooterNPC::OnAfterRespawn()
@@ -402,12 +523,13 @@ void AShooterNPC::OnAfterRespawn()
 		return;
 	}
 	
-	AController* NPCController = GetController();
+	// 死亡时控制器已经取消占有，使用死亡前记住的控制器
+	AController* NPCController = GetController() ? GetController() : RespawnController.Get();
 	
 	// 如果没有 Controller，可能需要重新创建（这种情况应该很少见）
 	if (!NPCController)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("NPC respawned without AI controller - this may need manual repossessing"));
+		UE_LOG(LogShooterGameplay, Warning, TEXT("NPC respawned without AI controller - this may need manual repossessing"));
 		return;
 	}
 	
@@ -415,14 +537,43 @@ void AShooterNPC::OnAfterRespawn()
 	if (NPCController->GetPawn() != this)
 	{
 		NPCController->Possess(this);
-		UE_LOG(LogTemp, Log, TEXT("AI Controller repossessed NPC after respawn"));
+		UE_LOG(LogShooterGameplay, Verbose, TEXT("AI Controller repossessed NPC after respawn"));
 	}
 	
 	// 如果是 ShooterAIController，调用重新占据方法（这会重置 StateTree 和所有状态）
 	if (AShooterAIController* AIController = Cast<AShooterAIController>(NPCController))
 	{
 		AIController->RequestRepossess(this);
-		UE_LOG(LogTemp, Log, TEXT("AI Controller state reset for respawned NPC"));
+		UE_LOG(LogShooterGameplay, Verbose, TEXT("AI Controller state reset for respawned NPC"));
+	}
+}
+
+void AShooterNPC::ResetForRound()
+{
+	// Only process on server
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	// 取消待执行的销毁和重生
+	UShooterTimerSubsystem::ClearWorldTimer(this, DeathTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, RespawnTimer);
+
+	LastDamageInstigator = nullptr;
+
+	RestoreSpawnState();
+
+	// 重新占有但不重启 StateTree（由 AI 种群子系统分帧重启，避免所有 NPC 同一帧启动）
+	// 不会重生的 NPC 死亡时控制器已被销毁，需要重新生成控制器
+	AController* NPCController = GetController() ? GetController() : RespawnController.Get();
+	if (!NPCController)
+	{
+		SpawnDefaultController();
+	}
+	else if (NPCController->GetPawn() != this)
+	{
+		NPCController->Possess(this);
 	}
 }
 
@@ -465,17 +616,61 @@ void AShooterNPC::StopShooting()
 	}
 }
 
-void AShooterNPC::OnRep_CurrentHP()
+void AShooterNPC::UpdateCombatState()
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	FShooterCombatState NewState;
+	NewState.SetHP(CurrentHP);
+	NewState.TeamByte = TeamByte;
+	NewState.SetFlag(ShooterCombatFlags::Dead, bIsDead);
+
+	// push model: only mark dirty when the packed state actually changed
+	if (NewState != CombatState)
+	{
+		CombatState = NewState;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterNPC, CombatState, this);
+	}
+
+	UpdateCombatantRegistry();
+}
+
+void AShooterNPC::UpdateCombatantRegistry()
 {
-	// Update visual effects or UI when HP changes on clients
-	// This can be extended to show damage indicators, etc.
+	if (UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		Combatants->UpdateCombatant(this, TeamByte, !bIsDead);
+	}
+}
+
+void AShooterNPC::OnRep_CombatState()
+{
+	// damaged NPCs animate at a higher budget priority
+	if (CombatState.GetHP() < CurrentHP)
+	{
+		if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+		{
+			AnimBudget->ReportCombat(this);
+		}
+	}
+
+	// unpack into the properties gameplay code and Blueprints read
+	CurrentHP = CombatState.GetHP();
+	TeamByte = CombatState.TeamByte;
+	bIsDead = CombatState.HasFlag(ShooterCombatFlags::Dead);
+	UpdateCombatantRegistry();
 }
 
 void AShooterNPC::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AShooterNPC, CurrentHP);
-	DOREPLIFETIME(AShooterNPC, TeamByte);
-	DOREPLIFETIME(AShooterNPC, bIsDead);
+	// push model: only properties explicitly marked dirty get compared
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterNPC, CombatState, Params);
 }
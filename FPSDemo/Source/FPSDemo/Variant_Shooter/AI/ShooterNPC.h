@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "FPSDemoCharacter.h"
 #include "ShooterWeaponHolder.h"
+#include "ShooterCombatState.h"
+#include "ShooterTimerSubsystem.h"
 #include "ShooterNPC.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPawnDeathDelegate);
@@ -27,8 +29,8 @@ class FPSDEMO_API AShooterNPC : public AFPSDemoCharacter, public IShooterWeaponH
 
 public:
 
-	/** NPC 当前生命值（降至 0 时死亡，网络同步） */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, ReplicatedUsing=OnRep_CurrentHP, Category="Damage")
+	/** NPC 当前生命值（降至 0 时死亡，通过 CombatState 同步） */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Damage")
 	float CurrentHP = 100.0f;
 	
 	/** 是否允许 NPC 死亡后重生 */
@@ -50,7 +52,7 @@ protected:
 	float DeferredDestructionTime = 5.0f;
 
 	/** NPC 所属团队 ID（用于团队识别，默认 1 = 敌人团队） */
-	UPROPERTY(EditAnywhere, Replicated, Category="Team")
+	UPROPERTY(EditAnywhere, Category="Team")
 	uint8 TeamByte = 1;
 
 	/** NPC 装备的武器指针 */
@@ -60,11 +62,7 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Weapon")
 	TSubclassOf<AShooterWeapon> WeaponClass;
 
-	/** 第一人称网格武器插槽名称 */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category ="Weapons")
-	FName FirstPersonWeaponSocket = FName("HandGrip_R");
-
-	/** 第三人称网格武器插槽名称 */
+	/** 第三人称网格武器插槽名称（NPC 没有第一人称网格，武器的两个网格都附加到这里） */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category ="Weapons")
 	FName ThirdPersonWeaponSocket = FName("HandGrip_R");
 
@@ -72,6 +70,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Aim")
 	float AimRange = 10000.0f;
 
+	/** 第三人称网格上作为眼睛位置的插槽（瞄准和视线检查的起点） */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	FName EyeSocketName = FName("head");
+
+	/** 眼睛位置相对插槽的偏移（插槽不存在时相对胶囊体 BaseEyeHeight） */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	FVector EyeOffset = FVector::ZeroVector;
+
 	/** 瞄准时的散布半角（度数，增加 AI 射击难度） */
 	UPROPERTY(EditAnywhere, Category="Aim")
 	float AimVarianceHalfAngle = 10.0f;
@@ -91,14 +97,17 @@ protected:
 	bool bIsShooting = false;
 
 	/** If true, this character has already died */
-	UPROPERTY(Replicated)
 	bool bIsDead = false;
 
+	/** Packed HP, team and dead flag, replicated as a single property */
+	UPROPERTY(ReplicatedUsing=OnRep_CombatState)
+	FShooterCombatState CombatState;
+
 	/** Deferred destruction on death timer */
-	FTimerHandle DeathTimer;
+	FShooterTimerHandle DeathTimer;
 
 	/** Timer handle for respawn */
-	FTimerHandle RespawnTimer;
+	FShooterTimerHandle RespawnTimer;
 
 	// 保存NPC出生时的Transform
 	UPROPERTY(BlueprintReadOnly,Category="Shooter|AI")
@@ -107,6 +116,9 @@ protected:
 	/** Controller that last damaged this NPC (for kill tracking) */
 	TObjectPtr<AController> LastDamageInstigator;
 
+	/** 死亡前控制这个 NPC 的控制器（死亡时会取消占有，重生和回合重置时用来重新占有） */
+	TWeakObjectPtr<AController> RespawnController;
+
 public:
 
 	/** Delegate called when this NPC dies */
@@ -120,11 +132,20 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	/** Updates the controller in the combatant registry */
+	virtual void NotifyControllerChanged() override;
+
 public:
 
 	/** Handle incoming damage */
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	/** Applies the damage merged over one frame. Returns true if it killed the NPC */
+	bool ApplyAccumulatedDamage(float Damage, AController* LastInstigator);
+
+	/** Returns the HP ApplyAccumulatedDamage would take off, 0 if the NPC is already dead */
+	float GetApplicableDamage(float Damage) const;
+
 public:
 
 	//~Begin IShooterWeaponHolder interface
@@ -166,12 +187,30 @@ protected:
 	/** Called after death to destroy the actor */
 	void DeferredDestruction();
 
-	/** Replication function for CurrentHP */
+	/** 回到出生点并恢复生命值、射击、物理和移动状态 */
+	void RestoreSpawnState();
+
+	/** Server only. Packs HP, team and dead flag into CombatState and marks it dirty if it changed */
+	void UpdateCombatState();
+
+	/** Unpacks the replicated combat state */
 	UFUNCTION()
-	void OnRep_CurrentHP();
+	void OnRep_CombatState();
+
+	/** Writes the team, alive state and controller into the combatant registry */
+	void UpdateCombatantRegistry();
 
 public:
 
+	/** Constructor. NPCs don't create the first person arms or camera, and use a movement component with LODs */
+	AShooterNPC(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the eye location used for aiming and line of sight checks */
+	FVector GetEyeLocation() const;
+
+	/** Uses the eye point on the third person mesh, so AI perception matches the aim source */
+	virtual void GetActorEyesViewPoint(FVector& OutLocation, FRotator& OutRotation) const override;
+
 	/** Signals this character to start shooting at the passed actor */
 	void StartShooting(AActor* ActorToShoot);
 
@@ -184,10 +223,19 @@ public:
 	/** Called after respawn to notify the AI controller */
 	void OnAfterRespawn();
 
+	/** 服务器端：回合重置。取消死亡和重生定时器，回到出生状态并重新占有（StateTree 由 AI 种群子系统分帧重启） */
+	void ResetForRound();
+
 	/** 获取 NPC 所属的团队 ID */
 	UFUNCTION(BlueprintCallable, Category="Team")
 	uint8 GetTeamByte() const { return TeamByte; }
 
+	/** 返回 NPC 是否已经死亡 */
+	bool IsDead() const { return bIsDead; }
+
+	/** 返回 NPC 是否正在射击 */
+	bool IsShooting() const { return bIsShooting; }
+
 	/** Get the lifetime replicated props */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 };
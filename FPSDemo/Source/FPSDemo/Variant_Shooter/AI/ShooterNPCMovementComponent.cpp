@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterNPCMovementComponent.h"
+#include "ShooterMovementLODSubsystem.h"
+#include "GameFramework/Character.h"
+#include "AIController.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "HAL/PlatformTime.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("NPC Movement (Full)"), STAT_ShooterNPCMovementFull, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("NPC Movement (Mid)"), STAT_ShooterNPCMovementMid, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("NPC Movement (Far)"), STAT_ShooterNPCMovementFar, STATGROUP_Shooter);
+
+namespace ShooterMovementLOD
+{
+	static TStatId GetStatId(EShooterMovementLOD LOD)
+	{
+		switch (LOD)
+		{
+		case EShooterMovementLOD::Mid:
+			return GET_STATID(STAT_ShooterNPCMovementMid);
+		case EShooterMovementLOD::Far:
+			return GET_STATID(STAT_ShooterNPCMovementFar);
+		default:
+			return GET_STATID(STAT_ShooterNPCMovementFull);
+		}
+	}
+}
+
+UShooterNPCMovementComponent::UShooterNPCMovementComponent()
+{
+	// nav walking follows the real floor with a periodic line trace, so switching back to walking doesn't pop
+	bProjectNavMeshWalking = true;
+}
+
+void UShooterNPCMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	bConfiguredAvoidance = bUseRVOAvoidance;
+
+	LODSubsystem = GetWorld()->GetSubsystem<UShooterMovementLODSubsystem>();
+}
+
+void UShooterNPCMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// only the server runs the LODs. Simulated proxies would skew the full LOD timings
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		return;
+	}
+
+	FScopeCycleCounter CycleCounter(ShooterMovementLOD::GetStatId(MovementLOD));
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (LODSubsystem)
+	{
+		LODSubsystem->RecordMovementTick(MovementLOD, FPlatformTime::Cycles64() - StartCycles, DeltaTime);
+	}
+}
+
+void UShooterNPCMovementComponent::SetMovementLOD(EShooterMovementLOD NewLOD)
+{
+	// landing and respawning go back to the default land mode, so keep it in sync
+	const EMovementMode GroundMode = NewLOD == EShooterMovementLOD::Full ? MOVE_Walking : MOVE_NavWalking;
+	DefaultLandMovementMode = GroundMode;
+
+	// never interrupt falling or custom movement
+	if (IsMovingOnGround() && MovementMode != GroundMode)
+	{
+		SetMovementMode(GroundMode);
+	}
+
+	if (NewLOD == MovementLOD)
+	{
+		return;
+	}
+
+	MovementLOD = NewLOD;
+
+	// tick functions with an interval receive the whole elapsed time, so speed and paths are unchanged
+	const float TickInterval = NewLOD == EShooterMovementLOD::Far ? FarTickInterval : 0.0f;
+	SetComponentTickInterval(TickInterval);
+
+	if (const AAIController* AIController = Cast<AAIController>(CharacterOwner ? CharacterOwner->GetController() : nullptr))
+	{
+		if (UPathFollowingComponent* PathFollowing = AIController->GetPathFollowingComponent())
+		{
+			PathFollowing->SetComponentTickInterval(TickInterval);
+		}
+	}
+
+	// nobody is close enough to see far NPCs push past each other
+	if (bConfiguredAvoidance)
+	{
+		SetAvoidanceEnabled(NewLOD != EShooterMovementLOD::Far);
+	}
+}
@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ShooterNPCMovementComponent.generated.h"
+
+class UShooterMovementLODSubsystem;
+
+/** NPC 移动模拟精度等级 */
+enum class EShooterMovementLOD : uint8
+{
+	/** 完整的行走物理、地面检测和避让 */
+	Full,
+
+	/** 导航网格行走，不做地面扫描 */
+	Mid,
+
+	/** 导航网格行走，低频更新移动和路径跟随，不做避让 */
+	Far,
+
+	Num
+};
+
+/**
+ *  AI 射击 NPC 的移动组件
+ *  功能：
+ *  - 服务器根据 UShooterMovementLODSubsystem 计算的等级切换移动精度
+ *  - 中远距离使用导航网格行走（NavWalking），按间隔向下投射贴合几何体，避免切换时高度跳变
+ *  - 远距离降低移动和路径跟随的 Tick 频率（Tick 时累积的 DeltaTime 保证速度和路径不变）
+ *  - 按等级统计移动 Tick 的 CPU 时间（记录在本世界的 UShooterMovementLODSubsystem），用于 Shooter.MovementLOD.Report 基准测试
+ *  - 只在服务器分级；客户端的模拟代理（SmoothClientPosition、代理 Tick）不受影响
+ */
+UCLASS()
+class FPSDEMO_API UShooterNPCMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UShooterNPCMovementComponent();
+
+	/** Remembers the configured avoidance setting */
+	virtual void BeginPlay() override;
+
+	/** Times the movement tick for the current LOD */
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** 服务器：应用移动精度等级。每次评估都会调用，地面移动模式被其他逻辑改回时会重新应用 */
+	void SetMovementLOD(EShooterMovementLOD NewLOD);
+
+	/** 返回当前移动精度等级 */
+	EShooterMovementLOD GetMovementLOD() const { return MovementLOD; }
+
+protected:
+
+	/** 远距离等级下移动和路径跟随的 Tick 间隔（秒） */
+	UPROPERTY(EditAnywhere, Category="Movement LOD")
+	float FarTickInterval = 0.2f;
+
+	/** 当前移动精度等级 */
+	EShooterMovementLOD MovementLOD = EShooterMovementLOD::Full;
+
+	/** 蓝图中配置的避让设置（Full 和 Mid 等级使用） */
+	bool bConfiguredAvoidance = false;
+
+	/** 本世界的移动精度子系统，记录移动耗时 */
+	UPROPERTY(Transient)
+	TObjectPtr<UShooterMovementLODSubsystem> LODSubsystem;
+};
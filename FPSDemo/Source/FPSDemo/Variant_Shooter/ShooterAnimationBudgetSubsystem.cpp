@@ -0,0 +1,319 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterAnimationBudgetSubsystem.h"
+#include "IAnimationBudgetAllocator.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ShooterCharacter.h"
+#include "AI/ShooterNPC.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anim Budget Significance"), STAT_ShooterAnimBudgetSignificance, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Pawns"), STAT_ShooterAnimBudgetPawns, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Meshes"), STAT_ShooterAnimBudgetMeshes, STATGROUP_Shooter);
+
+namespace ShooterAnimBudget
+{
+	static float SignificanceInterval = 0.1f;
+	static FAutoConsoleVariableRef CVarSignificanceInterval(
+		TEXT("Shooter.AnimBudget.SignificanceInterval"),
+		SignificanceInterval,
+		TEXT("Seconds between significance updates for budgeted character meshes."));
+
+	static float MaxDistance = 5000.0f;
+	static FAutoConsoleVariableRef CVarMaxDistance(
+		TEXT("Shooter.AnimBudget.MaxDistance"),
+		MaxDistance,
+		TEXT("Distance to the nearest local viewer at which the distance term of the significance reaches zero, in cm."));
+
+	static float DistanceWeight = 0.5f;
+	static FAutoConsoleVariableRef CVarDistanceWeight(
+		TEXT("Shooter.AnimBudget.DistanceWeight"),
+		DistanceWeight,
+		TEXT("Significance contributed by being close to a local viewer."));
+
+	static float FullScreenSize = 0.25f;
+	static FAutoConsoleVariableRef CVarFullScreenSize(
+		TEXT("Shooter.AnimBudget.FullScreenSize"),
+		FullScreenSize,
+		TEXT("Projected bounds radius, as a fraction of the half screen height, at which the screen size term is at full weight."));
+
+	static float ScreenSizeWeight = 0.5f;
+	static FAutoConsoleVariableRef CVarScreenSizeWeight(
+		TEXT("Shooter.AnimBudget.ScreenSizeWeight"),
+		ScreenSizeWeight,
+		TEXT("Significance contributed by a large projected screen size."));
+
+	static float CombatBonus = 1.0f;
+	static FAutoConsoleVariableRef CVarCombatBonus(
+		TEXT("Shooter.AnimBudget.CombatBonus"),
+		CombatBonus,
+		TEXT("Significance added while a pawn is in combat."));
+
+	static float CombatDuration = 3.0f;
+	static FAutoConsoleVariableRef CVarCombatDuration(
+		TEXT("Shooter.AnimBudget.CombatDuration"),
+		CombatDuration,
+		TEXT("Seconds a pawn counts as in combat after firing or taking damage."));
+
+	/** A local player's view used for significance */
+	struct FViewer
+	{
+		FVector Location;
+
+		/** 1 / tan(half FOV), converts radius over distance into a screen fraction */
+		float ScreenScale = 1.0f;
+
+		const APawn* ViewTarget = nullptr;
+	};
+}
+
+bool UShooterAnimationBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UShooterAnimationBudgetSubsystem::IsBudgetingEnabled() const
+{
+	UWorld* World = GetWorld();
+	return World && World->GetNetMode() != NM_DedicatedServer && IAnimationBudgetAllocator::Get(World) != nullptr;
+}
+
+void UShooterAnimationBudgetSubsystem::RegisterPawn(ACharacter* Pawn)
+{
+	if (!Pawn || !IsBudgetingEnabled())
+	{
+		return;
+	}
+
+	FShooterAnimBudgetPawn& Entry = FindOrAddPawn(Pawn);
+
+	if (USkeletalMeshComponentBudgeted* Mesh = Cast<USkeletalMeshComponentBudgeted>(Pawn->GetMesh()))
+	{
+		AddComponent(Entry, Mesh);
+	}
+}
+
+void UShooterAnimationBudgetSubsystem::UnregisterPawn(ACharacter* Pawn)
+{
+	const int32 Index = Pawns.IndexOfByPredicate([Pawn](const FShooterAnimBudgetPawn& Entry) { return Entry.Pawn.Get() == Pawn; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(GetWorld()))
+	{
+		for (const TWeakObjectPtr<USkeletalMeshComponentBudgeted>& Component : Pawns[Index].Components)
+		{
+			if (Component.IsValid())
+			{
+				Allocator->UnregisterComponent(Component.Get());
+			}
+		}
+	}
+
+	Pawns.RemoveAtSwap(Index);
+}
+
+void UShooterAnimationBudgetSubsystem::RegisterComponent(ACharacter* Pawn, USkeletalMeshComponent* MeshComponent)
+{
+	USkeletalMeshComponentBudgeted* Component = Cast<USkeletalMeshComponentBudgeted>(MeshComponent);
+	if (!Pawn || !Component || !IsBudgetingEnabled())
+	{
+		return;
+	}
+
+	AddComponent(FindOrAddPawn(Pawn), Component);
+}
+
+void UShooterAnimationBudgetSubsystem::UnregisterComponent(USkeletalMeshComponent* MeshComponent)
+{
+	USkeletalMeshComponentBudgeted* Component = Cast<USkeletalMeshComponentBudgeted>(MeshComponent);
+	if (!Component)
+	{
+		return;
+	}
+
+	for (FShooterAnimBudgetPawn& Entry : Pawns)
+	{
+		if (Entry.Components.RemoveSwap(Component) > 0)
+		{
+			if (IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(GetWorld()))
+			{
+				Allocator->UnregisterComponent(Component);
+			}
+
+			return;
+		}
+	}
+}
+
+void UShooterAnimationBudgetSubsystem::ReportCombat(const APawn* Pawn)
+{
+	for (FShooterAnimBudgetPawn& Entry : Pawns)
+	{
+		if (Entry.Pawn.Get() == Pawn)
+		{
+			Entry.LastCombatTime = GetWorld()->GetTimeSeconds();
+			return;
+		}
+	}
+}
+
+FShooterAnimBudgetPawn& UShooterAnimationBudgetSubsystem::FindOrAddPawn(ACharacter* Pawn)
+{
+	if (FShooterAnimBudgetPawn* Existing = Pawns.FindByPredicate([Pawn](const FShooterAnimBudgetPawn& Entry) { return Entry.Pawn.Get() == Pawn; }))
+	{
+		return *Existing;
+	}
+
+	FShooterAnimBudgetPawn& Entry = Pawns.AddDefaulted_GetRef();
+	Entry.Pawn = Pawn;
+	return Entry;
+}
+
+void UShooterAnimationBudgetSubsystem::AddComponent(FShooterAnimBudgetPawn& Entry, USkeletalMeshComponentBudgeted* Component)
+{
+	if (Entry.Components.Contains(Component))
+	{
+		return;
+	}
+
+	IAnimationBudgetAllocator::Get(GetWorld())->RegisterComponent(Component);
+	Entry.Components.Add(Component);
+
+	// start at full significance until the next update
+	TimeUntilSignificanceUpdate = 0.0f;
+}
+
+void UShooterAnimationBudgetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Pawns.Num() == 0)
+	{
+		return;
+	}
+
+	TimeUntilSignificanceUpdate -= DeltaTime;
+	if (TimeUntilSignificanceUpdate <= 0.0f)
+	{
+		TimeUntilSignificanceUpdate = ShooterAnimBudget::SignificanceInterval;
+		UpdateSignificance();
+	}
+}
+
+TStatId UShooterAnimationBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterAnimationBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterAnimationBudgetSubsystem::UpdateSignificance()
+{
+	using namespace ShooterAnimBudget;
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAnimBudgetSignificance);
+
+	UWorld* World = GetWorld();
+	IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(World);
+	if (!Allocator)
+	{
+		return;
+	}
+
+	// gather the local views. Split screen can have several
+	TArray<FViewer, TInlineAllocator<4>> Viewers;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (!PC || !PC->IsLocalController())
+		{
+			continue;
+		}
+
+		FViewer& Viewer = Viewers.AddDefaulted_GetRef();
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(Viewer.Location, ViewRotation);
+		Viewer.ViewTarget = PC->GetPawn();
+
+		const float FOV = PC->PlayerCameraManager ? PC->PlayerCameraManager->GetFOVAngle() : 90.0f;
+		Viewer.ScreenScale = 1.0f / FMath::Max(FMath::Tan(FMath::DegreesToRadians(FOV * 0.5f)), UE_KINDA_SMALL_NUMBER);
+	}
+
+	const double Now = World->GetTimeSeconds();
+	int32 NumMeshes = 0;
+
+	for (int32 Index = Pawns.Num() - 1; Index >= 0; --Index)
+	{
+		FShooterAnimBudgetPawn& Entry = Pawns[Index];
+		ACharacter* Pawn = Entry.Pawn.Get();
+		if (!Pawn)
+		{
+			Pawns.RemoveAtSwap(Index);
+			continue;
+		}
+
+		const FBoxSphereBounds& Bounds = Pawn->GetMesh()->Bounds;
+
+		// take the most significant of the local views
+		float Significance = 0.0f;
+		bool bViewTarget = false;
+
+		for (const FViewer& Viewer : Viewers)
+		{
+			const float Distance = FMath::Max(FVector::Dist(Viewer.Location, Bounds.Origin), 1.0f);
+			const float DistanceTerm = 1.0f - FMath::Clamp(Distance / MaxDistance, 0.0f, 1.0f);
+			const float ScreenSize = Bounds.SphereRadius * Viewer.ScreenScale / Distance;
+			const float ScreenSizeTerm = FMath::Clamp(ScreenSize / FullScreenSize, 0.0f, 1.0f);
+
+			Significance = FMath::Max(Significance, DistanceWeight * DistanceTerm + ScreenSizeWeight * ScreenSizeTerm);
+			bViewTarget |= Viewer.ViewTarget == Pawn;
+		}
+
+		if (Now - Entry.LastCombatTime < CombatDuration)
+		{
+			Significance += CombatBonus;
+		}
+
+		// our own body casts the view's shadow, and ragdolls need every physics blend
+		const bool bNeverSkip = bViewTarget || IsPawnDead(Pawn);
+
+		for (int32 ComponentIndex = Entry.Components.Num() - 1; ComponentIndex >= 0; --ComponentIndex)
+		{
+			if (USkeletalMeshComponentBudgeted* Component = Entry.Components[ComponentIndex].Get())
+			{
+				Allocator->SetComponentSignificance(Component, Significance, bNeverSkip, bViewTarget);
+				++NumMeshes;
+			}
+			else
+			{
+				Entry.Components.RemoveAtSwap(ComponentIndex);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ShooterAnimBudgetPawns, Pawns.Num());
+	SET_DWORD_STAT(STAT_ShooterAnimBudgetMeshes, NumMeshes);
+}
+
+bool UShooterAnimationBudgetSubsystem::IsPawnDead(const ACharacter* Pawn)
+{
+	if (const AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(Pawn))
+	{
+		return ShooterCharacter->IsDead();
+	}
+
+	if (const AShooterNPC* ShooterNPC = Cast<AShooterNPC>(Pawn))
+	{
+		return ShooterNPC->IsDead();
+	}
+
+	return false;
+}
@@ -0,0 +1,91 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterAnimationBudgetSubsystem.generated.h"
+
+class ACharacter;
+class USkeletalMeshComponent;
+class USkeletalMeshComponentBudgeted;
+
+/** 一个在动画预算中注册的角色 */
+struct FShooterAnimBudgetPawn
+{
+	/** 角色 */
+	TWeakObjectPtr<ACharacter> Pawn;
+
+	/** 角色的第三人称网格和附加的武器网格，共享同一个重要性 */
+	TArray<TWeakObjectPtr<USkeletalMeshComponentBudgeted>, TInlineAllocator<2>> Components;
+
+	/** 上次参与战斗（开火、受伤）的时间 */
+	double LastCombatTime = -1000.0;
+};
+
+/**
+ *  射击角色的动画预算子系统
+ *  功能：
+ *  - 把角色、NPC 和武器的第三人称网格注册到引擎的动画预算分配器（AnimationBudgetAllocator 插件）
+ *  - 定期按到本地观察者的距离、屏幕尺寸以及是否处于战斗计算每个角色的重要性
+ *  - 分配器根据 a.Budget.BudgetMs 的 CPU 预算降低低重要性网格的更新频率，跳过的帧使用插值
+ *  - 预算和降频参数通过 a.Budget.* 控制台变量配置，可在 DefaultDeviceProfiles.ini 中按平台覆盖
+ *  - 专用服务器不注册任何网格（不渲染，命中判定需要完整的骨骼更新）
+ */
+UCLASS()
+class FPSDEMO_API UShooterAnimationBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 注册角色的第三人称网格 */
+	void RegisterPawn(ACharacter* Pawn);
+
+	/** 注销角色和它的所有网格 */
+	void UnregisterPawn(ACharacter* Pawn);
+
+	/** 注册附加在角色上的网格（武器），与角色共享重要性 */
+	void RegisterComponent(ACharacter* Pawn, USkeletalMeshComponent* MeshComponent);
+
+	/** 注销一个附加网格 */
+	void UnregisterComponent(USkeletalMeshComponent* MeshComponent);
+
+	/** 报告角色参与了战斗，一段时间内提高其重要性 */
+	void ReportCombat(const APawn* Pawn);
+
+	/** 返回已注册的角色数量 */
+	int32 GetNumPawns() const { return Pawns.Num(); }
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Periodically recalculates significance */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 返回这台机器是否参与动画预算（专用服务器不参与） */
+	bool IsBudgetingEnabled() const;
+
+	/** 查找或添加角色条目 */
+	FShooterAnimBudgetPawn& FindOrAddPawn(ACharacter* Pawn);
+
+	/** 把网格注册到分配器并加入角色条目 */
+	void AddComponent(FShooterAnimBudgetPawn& Entry, USkeletalMeshComponentBudgeted* Component);
+
+	/** 重新计算所有角色的重要性并提交给分配器 */
+	void UpdateSignificance();
+
+	/** 返回角色是否已经死亡 */
+	static bool IsPawnDead(const ACharacter* Pawn);
+
+	/** 已注册的角色 */
+	TArray<FShooterAnimBudgetPawn> Pawns;
+
+	/** 距离下次计算重要性的时间 */
+	float TimeUntilSignificanceUpdate = 0.0f;
+};
@@ -11,11 +11,20 @@
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
 #include "Camera/CameraComponent.h"
-#include "TimerManager.h"
+#include "ShooterTimerSubsystem.h"
 #include "ShooterGameMode.h"
-#include "ShooterUI.h"
+#include "ShooterSpawnPointSubsystem.h"
+#include "ShooterAnimationBudgetSubsystem.h"
+#include "ShooterDamageSubsystem.h"
+#include "ShooterCombatantSubsystem.h"
+#include "ShooterLatencyTrace.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterTelemetry.h"
+#include "ShooterGameplayTrace.h"
 #include "Net/UnrealNetwork.h"
-#include "GameFramework/PlayerState.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Components/CapsuleComponent.h"
+#include "FPSDemo.h"
 
 AShooterCharacter::AShooterCharacter()
 {
@@ -37,38 +46,77 @@ void AShooterCharacter::BeginPlay()
 	// 初始化生命值为最大值
 	CurrentHP = MaxHP;
 
+	// 记录网格初始状态，原地回收时恢复
+	InitialMeshRelativeTransform = GetMesh()->GetRelativeTransform();
+	InitialMeshCollisionProfile = GetMesh()->GetCollisionProfileName();
+
+	// 第三人称网格按重要性降频更新
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->RegisterPawn(this);
+	}
+
 	// 服务器端：启动重生后的无敌时间（防止刚重生就被秒杀）
 	if (HasAuthority())
 	{
 		bIsInvulnerable = true;
-		GetWorld()->GetTimerManager().SetTimer(InvulnerabilityTimer, this, &AShooterCharacter::OnInvulnerabilityExpired, InvulnerabilityDuration, false);
+		UShooterTimerSubsystem::SetWorldTimer(InvulnerabilityTimer, this, &AShooterCharacter::OnInvulnerabilityExpired, InvulnerabilityDuration, false);
+
+		UpdateCombatState();
 	}
 
 	// 调试：记录角色的团队 ID
-	UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::BeginPlay] Character spawned - TeamByte: %d, Character: %s"), 
-		TeamByte, *GetNameSafe(this));
-	if (AController* Ctrl = GetController())
+	UE_LOG(LogShooterGameplay, Verbose, TEXT("[ShooterCharacter::BeginPlay] Character spawned - TeamByte: %d, Character: %s, Controller: %s"), 
+		TeamByte, *GetNameSafe(this), *GetNameSafe(GetController()));
+
+	// 更新 HUD：通知 UI 更新生命值显示（1.0 = 100% 生命值）
+	OnDamaged.Broadcast(1.0f);
+}
+
+void AShooterCharacter::UpdateMeshesForViewer()
+{
+	Super::UpdateMeshesForViewer();
+
+	// 武器作为附加 Actor 存在于每台机器上（客户端没有 OwnedWeapons 列表）
+	TArray<AActor*> AttachedActors;
+	GetAttachedActors(AttachedActors);
+
+	for (AActor* AttachedActor : AttachedActors)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::BeginPlay] Character controller: %s"), *GetNameSafe(Ctrl));
-		if (APlayerController* PC = Cast<APlayerController>(Ctrl))
+		if (AShooterWeapon* Weapon = Cast<AShooterWeapon>(AttachedActor))
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::BeginPlay] Character is controlled by PlayerController"));
+			Weapon->UpdateMeshesForViewer();
 		}
 	}
-
-	// 更新 HUD：通知 UI 更新生命值显示（1.0 = 100% 生命值）
-	OnDamaged.Broadcast(1.0f);
 }
 
 void AShooterCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	// stop budgeting our meshes
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->UnregisterPawn(this);
+	}
 
-	// clear the invulnerability timer
-	GetWorld()->GetTimerManager().ClearTimer(InvulnerabilityTimer);
+	// leave the combatant registry
+	if (UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		Combatants->UnregisterCombatant(this);
+	}
+
+	// clear the respawn and invulnerability timers
+	UShooterTimerSubsystem::ClearWorldTimer(this, RespawnTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, InvulnerabilityTimer);
+}
+
+void AShooterCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	// 占有/取消占有时更新注册表中的控制器
+	UpdateCombatantRegistry();
 }
 
 void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -112,29 +160,99 @@ float AShooterCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dam
 		return 0.0f;
 	}
 
+	// 伤害在本帧结束时统一结算（同一帧内的多次命中合并为一次生命值更新）
+	if (UShooterDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UShooterDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(this, Damage, EventInstigator, DamageCauser);
+	}
+	else
+	{
+		ApplyAccumulatedDamage(Damage, EventInstigator);
+	}
+
+	return Damage;
+}
+
+bool AShooterCharacter::ApplyAccumulatedDamage(float Damage, AController* LastInstigator)
+{
+	// 排队期间可能已经死亡或进入无敌状态
+	if (GetApplicableDamage(Damage) <= 0.0f)
+	{
+		return false;
+	}
+
 	// 记录最后造成伤害的控制器（用于击杀统计）
-	if (EventInstigator)
+	if (LastInstigator)
 	{
-		LastDamageInstigator = EventInstigator;
+		LastDamageInstigator = LastInstigator;
 	}
 
 	// 减少生命值
 	CurrentHP -= Damage;
+	UpdateCombatState();
+
+	// 记录战斗位置，出生点选择会避开正在交火的区域
+	if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+	{
+		SpawnPoints->ReportCombat(GetActorLocation());
+	}
+
+	// 受伤的角色以更高的动画预算优先级更新
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->ReportCombat(this);
+	}
 
 	// 检查是否生命值耗尽，触发死亡
-	if (CurrentHP <= 0.0f)
+	const bool bKilled = CurrentHP <= 0.0f;
+	if (bKilled)
 	{
 		Die();
 	}
 
-	// 更新 HUD（服务器端立即更新，客户端通过 OnRep_CurrentHP 接收更新）
+	// 更新 HUD（服务器端立即更新，客户端通过 OnRep_CombatState 接收更新）
 	OnDamaged.Broadcast(FMath::Max(0.0f, CurrentHP / MaxHP));
 
-	return Damage;
+	return bKilled;
+}
+
+float AShooterCharacter::GetApplicableDamage(float Damage) const
+{
+	if (CurrentHP <= 0.0f || bIsInvulnerable)
+	{
+		return 0.0f;
+	}
+
+	// 超出剩余生命值的部分不计入
+	return FMath::Clamp(Damage, 0.0f, CurrentHP);
 }
 
 void AShooterCharacter::DoStartFiring()
 {
+	// 延迟追踪：为这次扣动扳机分配输入序号，随 RPC 发送到服务器
+	uint32 FireInput = 0;
+
+	if (UShooterLatencyTraceSubsystem::IsEnabled() && IsLocallyControlled())
+	{
+		FireInput = ++FireInputIndex;
+
+		if (UShooterLatencyTraceSubsystem* LatencyTrace = GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>())
+		{
+			const uint64 TraceId = UShooterLatencyTraceSubsystem::MakeTraceId(this, FireInput);
+			LatencyTrace->RecordStage(TraceId, EShooterLatencyStage::Input);
+
+			// 监听服务器的本地玩家在下面直接开火，服务器阶段也在这里记录
+			if (HasAuthority() && CurrentWeapon)
+			{
+				LatencyTrace->RecordStage(TraceId, EShooterLatencyStage::ServerReceive);
+				CurrentWeapon->SetLatencyTraceId(TraceId);
+			}
+		}
+	}
+
+	// 射击追踪：本地开火前记下第一发的序号，服务器据此对齐自己的射击计数
+	const uint16 ShotIndex = CurrentWeapon ? CurrentWeapon->GetNextShotIndex() : 0;
+
 	// 客户端预测：立即本地执行射击（提供即时反馈，避免延迟感）
 	if (CurrentWeapon)
 	{
@@ -142,7 +260,7 @@ void AShooterCharacter::DoStartFiring()
 	}
 	
 	// 服务器 RPC：同步射击到服务器（服务器会验证并执行，确保游戏逻辑一致性）
-	ServerStartFiring();
+	ServerStartFiring(FireInput, ShotIndex);
 }
 
 void AShooterCharacter::DoStopFiring()
@@ -233,8 +351,11 @@ FVector AShooterCharacter::GetWeaponTargetLocation()
 	// trace ahead from the camera viewpoint
 	FHitResult OutHit;
 
-	const FVector Start = GetFirstPersonCameraComponent()->GetComponentLocation();
-	const FVector End = Start + (GetFirstPersonCameraComponent()->GetForwardVector() * MaxAimDistance);
+	FVector Start;
+	FRotator ViewRotation;
+	GetFirstPersonViewPoint(Start, ViewRotation);
+
+	const FVector End = Start + (ViewRotation.Vector() * MaxAimDistance);
 
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(this);
@@ -285,8 +406,16 @@ void AShooterCharacter::OnWeaponActivated(AShooterWeapon* Weapon)
 	OnBulletCountUpdated.Broadcast(Weapon->GetMagazineSize(), Weapon->GetBulletCount());
 
 	// set the character mesh AnimInstances
-	GetFirstPersonMesh()->SetAnimInstanceClass(Weapon->GetFirstPersonAnimInstanceClass());
-	GetMesh()->SetAnimInstanceClass(Weapon->GetThirdPersonAnimInstanceClass());
+	// 类型可能还没加载（专用服务器不加载 Client Bundle），此时保留当前的动画蓝图，不清空
+	if (const TSubclassOf<UAnimInstance> FirstPersonAnimClass = Weapon->GetFirstPersonAnimInstanceClass())
+	{
+		GetFirstPersonMesh()->SetAnimInstanceClass(FirstPersonAnimClass);
+	}
+
+	if (const TSubclassOf<UAnimInstance> ThirdPersonAnimClass = Weapon->GetThirdPersonAnimInstanceClass())
+	{
+		GetMesh()->SetAnimInstanceClass(ThirdPersonAnimClass);
+	}
 }
 
 void AShooterCharacter::OnWeaponDeactivated(AShooterWeapon* Weapon)
@@ -317,102 +446,65 @@ AShooterWeapon* AShooterCharacter::FindWeaponOfType(TSubclassOf<AShooterWeapon>
 
 void AShooterCharacter::Die()
 {
-	UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] Character died - Team: %d"), TeamByte);
-
 	// 停用当前武器
 	if (IsValid(CurrentWeapon))
 	{
 		CurrentWeapon->DeactivateWeapon();
 	}
 
-	// 记录击杀/死亡统计并更新 UI
-	if (AShooterGameMode* GM = Cast<AShooterGameMode>(GetWorld()->GetAuthGameMode()))
+	// 发布击杀和死亡事件（只写入 id，击杀提示和死亡界面由事件的消费者显示）
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] GameMode found, processing kill/death"));
-		APlayerController* VictimPC = Cast<APlayerController>(GetController());
-		APlayerController* KillerPC = nullptr;
+		Events->PublishCombat(EShooterGameplayEventType::Kill, LastDamageInstigator, this);
+		Events->PublishCombat(EShooterGameplayEventType::Death, LastDamageInstigator, this, RespawnTime);
+	}
 
+	// 遥测：击杀和死亡记录（仍被占有，双方的 id 和团队都能查到）
+	if (UShooterTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UShooterTelemetrySubsystem>())
+	{
+		Telemetry->RecordKill(LastDamageInstigator, this);
+	}
+
+	// 记录击杀/死亡统计
+	if (AShooterGameMode* GM = Cast<AShooterGameMode>(GetWorld()->GetAuthGameMode()))
+	{
 		// 记录死亡统计（增加死亡数）
-		if (VictimPC)
+		if (APlayerController* VictimPC = Cast<APlayerController>(GetController()))
 		{
 			GM->RecordDeath(VictimPC);
 		}
 
 		// 记录击杀统计（增加击杀数）
-		if (LastDamageInstigator)
+		if (APlayerController* KillerPC = Cast<APlayerController>(LastDamageInstigator))
 		{
-			KillerPC = Cast<APlayerController>(LastDamageInstigator);
-			if (KillerPC)
-			{
-				GM->RecordKill(KillerPC);
-			}
-		}
-
-		// 显示击杀信息和死亡界面
-		if (GM && GM->ShooterUI)
-		{
-			FString KillerName = KillerPC ? KillerPC->GetPlayerState<APlayerState>()->GetPlayerName() : TEXT("Unknown");
-			FString VictimName = VictimPC ? VictimPC->GetPlayerState<APlayerState>()->GetPlayerName() : TEXT("Unknown");
-
-			// 向所有玩家显示击杀信息（击杀提示）
-			GM->ShooterUI->BP_ShowKillFeed(KillerName, VictimName);
-
-			// 仅向被击杀的玩家显示死亡界面
-			if (VictimPC && VictimPC->IsLocalController())
-			{
-				GM->ShooterUI->BP_ShowDeathScreen(KillerName, RespawnTime);
-			}
+			GM->RecordKill(KillerPC);
 		}
 
 		// 增加击杀者团队的得分
-		// 获取击杀者的团队ID（从造成伤害的控制器获取其控制的角色的团队）
+		// 获取击杀者的团队ID（按造成伤害的控制器在战斗者注册表中查找，不需要 Cast 击杀者的角色）
 		uint8 KillerTeamByte = 255;
-		FString KillerType = TEXT("Unknown");
-		
-		if (LastDamageInstigator && LastDamageInstigator->GetPawn())
-		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] LastDamageInstigator: %s, Pawn: %s"), 
-				*GetNameSafe(LastDamageInstigator), *GetNameSafe(LastDamageInstigator->GetPawn()));
-			
-			// 尝试从击杀者角色获取团队ID
-			if (AShooterCharacter* KillerCharacter = Cast<AShooterCharacter>(LastDamageInstigator->GetPawn()))
-			{
-				KillerTeamByte = KillerCharacter->GetTeamByte();
-				KillerType = TEXT("ShooterCharacter");
-				UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] Killer is ShooterCharacter, TeamByte: %d"), KillerTeamByte);
-			}
-			// 如果是AI NPC击杀的，也获取其团队ID
-			else if (AShooterNPC* KillerNPC = Cast<AShooterNPC>(LastDamageInstigator->GetPawn()))
-			{
-				KillerTeamByte = KillerNPC->GetTeamByte();
-				KillerType = TEXT("ShooterNPC");
-				UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] Killer is ShooterNPC, TeamByte: %d"), KillerTeamByte);
-			}
-		}
-		else
+
+		if (UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] LastDamageInstigator or Pawn is null"));
+			KillerTeamByte = Combatants->GetTeamForController(LastDamageInstigator);
 		}
 
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] ===== KILL SCORE LOGIC ====="));
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] Victim TeamByte: %d, Killer TeamByte: %d, Killer Type: %s"), 
-			TeamByte, KillerTeamByte, *KillerType);
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] KillerTeamByte != 255: %d"), (KillerTeamByte != 255));
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] KillerTeamByte != TeamByte: %d"), (KillerTeamByte != TeamByte));
-
 		// 只有当击杀者和被击杀者属于不同团队时才增加得分
-		if (KillerTeamByte != 255 && KillerTeamByte != TeamByte)
+		const bool bScored = KillerTeamByte != 255 && KillerTeamByte != TeamByte;
+
+		// 记录击杀结算（默认不格式化，见 ShooterGameplayTrace.h）
+		ShooterGameplayLog::LogKill(TEXT("ShooterCharacter::Die"), this, LastDamageInstigator, TeamByte, KillerTeamByte, bScored);
+
+		if (bScored)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] ✓ Incrementing score for team %d (killer) vs team %d (victim)"), 
-				KillerTeamByte, TeamByte);
 			GM->IncrementTeamScore(KillerTeamByte);
 		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] ✗ Not incrementing score - KillerTeam: %d, VictimTeam: %d"), 
-				KillerTeamByte, TeamByte);
-		}
-		UE_LOG(LogTemp, Warning, TEXT("[ShooterCharacter::Die] ============================="));
+	}
+
+	// 通知被击杀的玩家在本地播放击杀回放（客户端自己的环形缓冲区，不阻塞重生）
+	if (AShooterPlayerController* VictimPC = Cast<AShooterPlayerController>(GetController()))
+	{
+		VictimPC->ClientPlayKillcam(LastDamageInstigator ? LastDamageInstigator->GetPawn() : nullptr, RespawnTime);
 	}
 		
 	// 立即停止角色移动
@@ -428,22 +520,19 @@ void AShooterCharacter::Die()
 	BP_OnDeath();
 
 	// 设置重生定时器：等待 RespawnTime 秒后重生
-	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterCharacter::OnRespawn, RespawnTime, false);
+	UShooterTimerSubsystem::SetWorldTimer(RespawnTimer, this, &AShooterCharacter::OnRespawn, RespawnTime, false);
 }
 
 void AShooterCharacter::OnRespawn()
 {
-	// Hide death screen before respawning
-	if (AShooterGameMode* GM = Cast<AShooterGameMode>(GetWorld()->GetAuthGameMode()))
+	// try to reuse this pawn at a new spawn point
+	if (bRecycleOnRespawn)
 	{
-		if (GM && GM->ShooterUI)
+		if (AShooterPlayerController* PC = Cast<AShooterPlayerController>(GetController()))
 		{
-			if (APlayerController* PC = Cast<APlayerController>(GetController()))
+			if (PC->RecyclePawn(this))
 			{
-				if (PC->IsLocalController())
-				{
-					GM->ShooterUI->BP_HideDeathScreen();
-				}
+				return;
 			}
 		}
 	}
@@ -452,6 +541,94 @@ void AShooterCharacter::OnRespawn()
 	Destroy();
 }
 
+bool AShooterCharacter::RecycleForRespawn(const FTransform& SpawnTransform)
+{
+	// Only process on server
+	if (!HasAuthority())
+	{
+		return false;
+	}
+
+	// 传送到出生点（如果出生点被阻挡则放弃回收，改为销毁重生）
+	if (!TeleportTo(SpawnTransform.GetLocation(), SpawnTransform.Rotator()))
+	{
+		return false;
+	}
+
+	if (AController* Ctrl = GetController())
+	{
+		Ctrl->SetControlRotation(SpawnTransform.Rotator());
+	}
+
+	UShooterTimerSubsystem::ClearWorldTimer(this, RespawnTimer);
+
+	// 重置生命值和伤害来源
+	CurrentHP = MaxHP;
+	LastDamageInstigator = nullptr;
+	ThrottledServerRPCs = 0;
+
+	// 重新开始重生无敌时间
+	bIsInvulnerable = true;
+	UShooterTimerSubsystem::SetWorldTimer(InvulnerabilityTimer, this, &AShooterCharacter::OnInvulnerabilityExpired, InvulnerabilityDuration, false);
+
+	UpdateCombatState();
+
+	// 清空武器库存，与新生成的角色保持一致（武器随拥有者被销毁时的行为相同）
+	for (AShooterWeapon* Weapon : OwnedWeapons)
+	{
+		if (IsValid(Weapon))
+		{
+			Weapon->Destroy();
+		}
+	}
+
+	OwnedWeapons.Empty();
+	CurrentWeapon = nullptr;
+
+	// 恢复网格、碰撞和移动状态（服务器和所有客户端）
+	MulticastOnRecycled();
+
+	// 重新启用输入
+	if (APlayerController* PC = Cast<APlayerController>(GetController()))
+	{
+		EnableInput(PC);
+	}
+
+	// 更新 HUD
+	OnBulletCountUpdated.Broadcast(0, 0);
+	OnDamaged.Broadcast(1.0f);
+
+	return true;
+}
+
+void AShooterCharacter::MulticastOnRecycled_Implementation()
+{
+	ResetPawnState();
+
+	// 让蓝图撤销死亡表现（特效、布娃娃等）
+	BP_OnRecycled();
+}
+
+void AShooterCharacter::ResetPawnState()
+{
+	// 恢复第三人称网格（蓝图死亡表现可能开启了物理模拟）
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetCollisionProfileName(InitialMeshCollisionProfile);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	GetMesh()->SetRelativeTransform(InitialMeshRelativeTransform);
+
+	// 恢复胶囊体碰撞
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	// 恢复移动
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Walking);
+
+	// 确保角色可见
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+}
+
 void AShooterCharacter::OnInvulnerabilityExpired()
 {
 	// Only process on server
@@ -462,32 +639,133 @@ void AShooterCharacter::OnInvulnerabilityExpired()
 
 	// Clear invulnerability flag
 	bIsInvulnerable = false;
+	UpdateCombatState();
+}
+
+void AShooterCharacter::UpdateCombatState()
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	FShooterCombatState NewState;
+	NewState.SetHP(CurrentHP);
+	NewState.TeamByte = TeamByte;
+	NewState.SetFlag(ShooterCombatFlags::Invulnerable, bIsInvulnerable);
+	NewState.SetFlag(ShooterCombatFlags::Dead, CurrentHP <= 0.0f);
+
+	// 推送模型：只有打包后的状态确实变化时才标记为脏
+	if (NewState != CombatState)
+	{
+		CombatState = NewState;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CombatState, this);
+	}
+
+	UpdateCombatantRegistry();
 }
 
-void AShooterCharacter::OnRep_IsInvulnerable()
+void AShooterCharacter::UpdateCombatantRegistry()
 {
-	// Update visual feedback when invulnerability state changes
-	// This can be used in Blueprint to show invulnerability effects (e.g., flashing)
+	if (UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		Combatants->UpdateCombatant(this, TeamByte, !IsDead());
+	}
 }
 
-void AShooterCharacter::OnRep_CurrentHP()
+void AShooterCharacter::OnRep_CombatState()
 {
+	const float PreviousHP = CurrentHP;
+
+	// 解包到各个属性（蓝图和本地逻辑继续读取这些属性）
+	CurrentHP = CombatState.GetHP();
+	TeamByte = CombatState.TeamByte;
+	bIsInvulnerable = CombatState.HasFlag(ShooterCombatFlags::Invulnerable);
+	UpdateCombatantRegistry();
+
 	// 客户端接收生命值更新后，更新 HUD（生命值条、伤害效果等）
-	// 计算生命值百分比（0.0 - 1.0），通知 UI 更新
-	OnDamaged.Broadcast(FMath::Max(0.0f, CurrentHP / MaxHP));
+	if (CurrentHP != PreviousHP)
+	{
+		OnDamaged.Broadcast(FMath::Max(0.0f, CurrentHP / MaxHP));
+	}
+
+	// 受伤的角色以更高的动画预算优先级更新
+	if (CurrentHP < PreviousHP)
+	{
+		if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+		{
+			AnimBudget->ReportCombat(this);
+		}
+	}
 }
 
 void AShooterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AShooterCharacter, CurrentHP);
-	DOREPLIFETIME(AShooterCharacter, TeamByte);
-	DOREPLIFETIME(AShooterCharacter, bIsInvulnerable);
+	// 推送模型：只有显式标记为脏的属性才会参与比较
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, CombatState, Params);
 }
 
-void AShooterCharacter::ServerStartFiring_Implementation()
+bool AShooterCharacter::CheckServerRPCRate(EShooterServerRPC RPC)
 {
+	// 令牌桶保存在 PlayerController 上（按连接），没有控制器时不限流
+	AShooterPlayerController* PC = Cast<AShooterPlayerController>(GetController());
+	if (!PC)
+	{
+		return true;
+	}
+
+	const EShooterRPCRateResult Result = PC->ConsumeServerRPCToken(RPC);
+
+	// 超出速率：标记该 RPC，在 _Implementation 中直接跳过
+	if (Result == EShooterRPCRateResult::Dropped)
+	{
+		ThrottledServerRPCs |= (1 << (uint8)RPC);
+	}
+
+	// 持续滥用时返回 false，引擎会断开该客户端
+	return Result != EShooterRPCRateResult::Kick;
+}
+
+bool AShooterCharacter::ConsumeThrottledRPC(EShooterServerRPC RPC)
+{
+	const uint8 Mask = 1 << (uint8)RPC;
+	const bool bThrottled = (ThrottledServerRPCs & Mask) != 0;
+	ThrottledServerRPCs &= ~Mask;
+	return bThrottled;
+}
+
+void AShooterCharacter::ServerStartFiring_Implementation(uint32 FireInput, uint16 ShotIndex)
+{
+	// 被限流丢弃的调用不执行任何逻辑
+	if (ConsumeThrottledRPC(EShooterServerRPC::StartFiring))
+	{
+		return;
+	}
+
+	// 延迟追踪：下一发生成的投射物携带这次输入的关联 ID（本地玩家已在 DoStartFiring 中记录）
+	if (FireInput != 0 && CurrentWeapon && !IsLocallyControlled() && UShooterLatencyTraceSubsystem::IsEnabled())
+	{
+		const uint64 TraceId = UShooterLatencyTraceSubsystem::MakeTraceId(this, FireInput);
+
+		if (UShooterLatencyTraceSubsystem* LatencyTrace = GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>())
+		{
+			LatencyTrace->RecordStage(TraceId, EShooterLatencyStage::ServerReceive);
+		}
+
+		CurrentWeapon->SetLatencyTraceId(TraceId);
+	}
+
+	// 射击追踪：服务器拒绝过的射击（弹药、射速、限流）会让两边的计数错开，每次扣动扳机都重新对齐到客户端的序号
+	if (CurrentWeapon && !IsLocallyControlled())
+	{
+		CurrentWeapon->SetNextShotIndex(ShotIndex);
+	}
+
 	// 服务器端执行射击（服务器权威，确保所有客户端看到一致的射击行为）
 	if (CurrentWeapon)
 	{
@@ -495,14 +773,20 @@ void AShooterCharacter::ServerStartFiring_Implementation()
 	}
 }
 
-bool AShooterCharacter::ServerStartFiring_Validate()
+bool AShooterCharacter::ServerStartFiring_Validate(uint32 FireInput, uint16 ShotIndex)
 {
-	// RPC 验证函数：可以在这里添加反作弊检查（如射速限制、距离检查等）
-	return true;
+	// RPC 验证函数：按连接的令牌桶限流
+	return CheckServerRPCRate(EShooterServerRPC::StartFiring);
 }
 
 void AShooterCharacter::ServerStopFiring_Implementation()
 {
+	// 被限流丢弃的调用仅在武器未射击时跳过（停止射击必须生效，否则武器会一直开火）
+	if (ConsumeThrottledRPC(EShooterServerRPC::StopFiring) && !(CurrentWeapon && CurrentWeapon->IsFiring()))
+	{
+		return;
+	}
+
 	// 服务器端停止射击
 	if (CurrentWeapon)
 	{
@@ -512,12 +796,18 @@ void AShooterCharacter::ServerStopFiring_Implementation()
 
 bool AShooterCharacter::ServerStopFiring_Validate()
 {
-	// RPC 验证函数
-	return true;
+	// RPC 验证函数：按连接的令牌桶限流
+	return CheckServerRPCRate(EShooterServerRPC::StopFiring);
 }
 
 void AShooterCharacter::ServerReload_Implementation()
 {
+	// 被限流丢弃的调用不执行任何逻辑
+	if (ConsumeThrottledRPC(EShooterServerRPC::Reload))
+	{
+		return;
+	}
+
 	// 服务器端执行换弹（服务器验证是否可以换弹）
 	if (CurrentWeapon && CurrentWeapon->CanReload())
 	{
@@ -527,6 +817,6 @@ void AShooterCharacter::ServerReload_Implementation()
 
 bool AShooterCharacter::ServerReload_Validate()
 {
-	// RPC 验证函数：可以添加换弹频率限制等反作弊检查
-	return true;
+	// RPC 验证函数：按连接的令牌桶限流
+	return CheckServerRPCRate(EShooterServerRPC::Reload);
 }
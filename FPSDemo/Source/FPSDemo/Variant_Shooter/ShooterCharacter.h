@@ -6,6 +6,9 @@
 #include "FPSDemoCharacter.h"
 #include "ShooterWeaponHolder.h"
 #include "ShooterTypes.h"
+#include "ShooterPlayerController.h"
+#include "ShooterCombatState.h"
+#include "ShooterTimerSubsystem.h"
 #include "ShooterCharacter.generated.h"
 
 class AShooterWeapon;
@@ -64,12 +67,12 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Health")
 	float MaxHP = 500.0f;
 
-	/** 当前剩余生命值（网络同步属性，服务器权威，客户端通过 OnRep_CurrentHP 接收更新） */
-	UPROPERTY(ReplicatedUsing=OnRep_CurrentHP, BlueprintReadOnly, Category="Health")
+	/** 当前剩余生命值（服务器权威，通过 CombatState 同步到客户端） */
+	UPROPERTY(BlueprintReadOnly, Category="Health")
 	float CurrentHP = 0.0f;
 
-	/** 角色所属的团队 ID（用于团队对战和得分统计） */
-	UPROPERTY(EditAnywhere, Replicated, Category="Team")
+	/** 角色所属的团队 ID（用于团队对战和得分统计，通过 CombatState 同步到客户端） */
+	UPROPERTY(EditAnywhere, Category="Team")
 	uint8 TeamByte = 0;
 
 public:
@@ -78,6 +81,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Team")
 	uint8 GetTeamByte() const { return TeamByte; }
 
+	/** 返回角色是否已经死亡 */
+	bool IsDead() const { return CurrentHP <= 0.0f; }
+
 protected:
 
 	/** List of weapons picked up by the character */
@@ -89,22 +95,42 @@ protected:
 	UPROPERTY(EditAnywhere, Category ="Destruction", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float RespawnTime = 5.0f;
 
-	FTimerHandle RespawnTimer;
+	/** 重生时是否原地回收角色（重置状态并传送到出生点），关闭或回收失败时销毁并重新生成 */
+	UPROPERTY(EditAnywhere, Category="Destruction")
+	bool bRecycleOnRespawn = true;
+
+	/** BeginPlay 时记录的第三人称网格相对变换（回收时恢复） */
+	FTransform InitialMeshRelativeTransform;
+
+	/** BeginPlay 时记录的第三人称网格碰撞配置（回收时恢复） */
+	FName InitialMeshCollisionProfile;
+
+	FShooterTimerHandle RespawnTimer;
 
 	/** 重生后的无敌时间（秒） */
 	UPROPERTY(EditAnywhere, Category="Health", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float InvulnerabilityDuration = 3.0f;
 
-	/** 当前是否处于无敌状态（网络同步） */
-	UPROPERTY(ReplicatedUsing=OnRep_IsInvulnerable, BlueprintReadOnly, Category="Health")
+	/** 当前是否处于无敌状态（通过 CombatState 同步到客户端） */
+	UPROPERTY(BlueprintReadOnly, Category="Health")
 	bool bIsInvulnerable = false;
 
+	/** 打包的战斗状态（生命值、团队、无敌/死亡标志），作为单个属性复制 */
+	UPROPERTY(ReplicatedUsing=OnRep_CombatState)
+	FShooterCombatState CombatState;
+
 	/** 无敌状态定时器句柄 */
-	FTimerHandle InvulnerabilityTimer;
+	FShooterTimerHandle InvulnerabilityTimer;
 
 	/** 最后对角色造成伤害的控制器（用于击杀统计） */
 	TObjectPtr<AController> LastDamageInstigator;
 
+	/** 在 _Validate 中被令牌桶丢弃、需要在 _Implementation 中跳过的 RPC（按 EShooterServerRPC 位掩码） */
+	uint8 ThrottledServerRPCs = 0;
+
+	/** 本地开火输入序号（延迟追踪的关联 ID，0 = 未追踪） */
+	uint32 FireInputIndex = 0;
+
 public:
 
 	/** Bullet count updated delegate */
@@ -123,9 +149,15 @@ protected:
 	/** Gameplay initialization */
 	virtual void BeginPlay() override;
 
+	/** 同时更新已附加武器的网格 */
+	virtual void UpdateMeshesForViewer() override;
+
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** 控制器变化时更新战斗者注册表 */
+	virtual void NotifyControllerChanged() override;
+
 	/** Set up input action bindings */
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 
@@ -134,6 +166,15 @@ public:
 	/** 处理受到的伤害（服务器端权威计算） */
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	/** 服务器端：结算本帧合并后的伤害（由伤害累积子系统调用），返回是否导致死亡 */
+	bool ApplyAccumulatedDamage(float Damage, AController* LastInstigator);
+
+	/** 返回 ApplyAccumulatedDamage 实际会扣除的生命值（已死亡或无敌时为 0） */
+	float GetApplicableDamage(float Damage) const;
+
+	/** 服务器端：原地重置角色并传送到指定位置（生命值、无敌、输入、武器和网格状态），返回是否成功 */
+	bool RecycleForRespawn(const FTransform& SpawnTransform);
+
 public:
 
 	/** 开始射击（客户端调用，本地立即反馈 + 服务器 RPC） */
@@ -152,9 +193,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Input")
 	void DoReload();
 
-	/** 服务器 RPC：开始射击（客户端-服务器网络同步） */
+	/**
+	 *  服务器 RPC：开始射击（客户端-服务器网络同步）
+	 *  FireInput 为延迟追踪的输入序号（未追踪时为 0），ShotIndex 为客户端这次扣动扳机的第一发射击序号（用于匹配射击追踪）
+	 */
 	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerStartFiring();
+	void ServerStartFiring(uint32 FireInput, uint16 ShotIndex);
 
 	/** 服务器 RPC：停止射击（客户端-服务器网络同步） */
 	UFUNCTION(Server, Reliable, WithValidation)
@@ -197,6 +241,12 @@ public:
 
 	//~End IShooterWeaponHolder interface
 
+	/** 服务器 RPC 限流检查：消耗拥有者连接的令牌，返回 false 表示应断开客户端（武器的服务器 RPC 也通过这里限流） */
+	bool CheckServerRPCRate(EShooterServerRPC RPC);
+
+	/** 返回并清除指定 RPC 的丢弃标记 */
+	bool ConsumeThrottledRPC(EShooterServerRPC RPC);
+
 protected:
 
 	/** Returns true if the character already owns a weapon of the given class */
@@ -209,16 +259,29 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta = (DisplayName = "On Death"))
 	void BP_OnDeath();
 
-	/** 重生处理：销毁当前角色，强制 PlayerController 重新生成角色 */
+	/** 重生处理：优先原地回收角色，失败时销毁当前角色，强制 PlayerController 重新生成角色 */
 	void OnRespawn();
 
-	/** 生命值复制回调函数：当服务器同步 CurrentHP 到客户端时调用（更新 UI、特效等） */
-	UFUNCTION()
-	void OnRep_CurrentHP();
+	/** 多播：在所有机器上恢复网格和碰撞状态（原地回收后调用） */
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastOnRecycled();
+
+	/** 恢复网格、碰撞和移动的本地状态 */
+	void ResetPawnState();
+
+	/** 蓝图可实现的回收事件（用于撤销 On Death 中的表现，或重新发放初始武器） */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta = (DisplayName = "On Recycled"))
+	void BP_OnRecycled();
+
+	/** 服务器端：把生命值、团队和无敌状态打包到 CombatState，有变化时标记为脏 */
+	void UpdateCombatState();
+
+	/** 把团队、存活状态和控制器写入战斗者注册表 */
+	void UpdateCombatantRegistry();
 
-	/** 无敌状态复制回调函数：当服务器同步 bIsInvulnerable 到客户端时调用 */
+	/** 战斗状态复制回调函数：解包到 CurrentHP 等属性，并只在生命值变化时更新 HUD */
 	UFUNCTION()
-	void OnRep_IsInvulnerable();
+	void OnRep_CombatState();
 
 	/** 无敌时间结束回调 */
 	void OnInvulnerabilityExpired();
@@ -0,0 +1,281 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterCombatNotifySubsystem.h"
+#include "ShooterPlayerController.h"
+#include "ShooterCombatantSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat Notify Send"), STAT_ShooterCombatNotifySend, STATGROUP_ShooterNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Notify Batches"), STAT_ShooterCombatNotifyBatches, STATGROUP_ShooterNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Notifications Sent"), STAT_ShooterCombatNotificationsSent, STATGROUP_ShooterNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Notifications Culled"), STAT_ShooterCombatNotificationsCulled, STATGROUP_ShooterNet);
+
+namespace ShooterCombatNotify
+{
+	/** Upper bound on notifications accepted in a single batch when deserializing */
+	static constexpr uint32 MaxNotificationsPerBatch = 64;
+
+	static int32 MaxPerBatch = 16;
+	static FAutoConsoleVariableRef CVarMaxPerBatch(
+		TEXT("Shooter.CombatNotify.MaxPerBatch"),
+		MaxPerBatch,
+		TEXT("Maximum number of combat notifications sent to a connection per frame. Notifications about the receiver are kept first."));
+
+	static float RelevantDistance = 15000.0f;
+	static FAutoConsoleVariableRef CVarRelevantDistance(
+		TEXT("Shooter.CombatNotify.RelevantDistance"),
+		RelevantDistance,
+		TEXT("Kills of other teams are only sent to connections viewing from within this distance of the killer or the victim. Defaults to the pawn net cull distance. 0 sends every player kill to every connection."));
+}
+
+bool FShooterCombatNotificationBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	uint32 NumNotifications = Notifications.Num();
+	Ar.SerializeIntPacked(NumNotifications);
+
+	if (Ar.IsLoading())
+	{
+		if (NumNotifications > ShooterCombatNotify::MaxNotificationsPerBatch)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+
+		Notifications.SetNum(NumNotifications);
+	}
+
+	for (FShooterCombatNotification& Notification : Notifications)
+	{
+		uint8 Type = (uint8)Notification.Type;
+		Ar.SerializeBits(&Type, 3);
+
+		if (Ar.IsLoading() && Type >= (uint8)EShooterGameplayEventType::Num)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+
+		// shift the ids so INDEX_NONE packs into a single byte
+		uint32 InstigatorId = (uint32)(Notification.InstigatorId + 1);
+		uint32 TargetId = (uint32)(Notification.TargetId + 1);
+		Ar.SerializeIntPacked(InstigatorId);
+		Ar.SerializeIntPacked(TargetId);
+
+		Ar << Notification.InstigatorTeam;
+		Ar << Notification.TargetTeam;
+
+		// only the death screen needs the respawn delay, in tenths of a second
+		uint16 QuantizedValue = (uint16)FMath::Clamp(FMath::RoundToInt(Notification.Value * 10.0f), 0, (int32)MAX_uint16);
+		if (Type == (uint8)EShooterGameplayEventType::Death)
+		{
+			Ar << QuantizedValue;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Notification.Type = (EShooterGameplayEventType)Type;
+			Notification.InstigatorId = (int32)InstigatorId - 1;
+			Notification.TargetId = (int32)TargetId - 1;
+			Notification.Value = Type == (uint8)EShooterGameplayEventType::Death ? QuantizedValue * 0.1f : 0.0f;
+		}
+	}
+
+	return true;
+}
+
+bool UShooterCombatNotifySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterCombatNotifySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// clients receive the batches, they don't send them
+	if (InWorld.GetNetMode() == NM_Client || InWorld.GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	if (UShooterGameplayEventSubsystem* Events = InWorld.GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		Events->OnEvent(EShooterGameplayEventType::Kill).AddUObject(this, &UShooterCombatNotifySubsystem::OnCombatEvent);
+		Events->OnEvent(EShooterGameplayEventType::Death).AddUObject(this, &UShooterCombatNotifySubsystem::OnCombatEvent);
+		Events->OnEvent(EShooterGameplayEventType::Respawn).AddUObject(this, &UShooterCombatNotifySubsystem::OnCombatEvent);
+	}
+}
+
+void UShooterCombatNotifySubsystem::OnCombatEvent(const FShooterGameplayEvent& Event)
+{
+	// clients only show kills of players and their own deaths and respawns, so NPC victims are never sent
+	if (Event.TargetId == INDEX_NONE)
+	{
+		return;
+	}
+
+	FShooterCombatNotification& Notification = PendingNotifications.AddDefaulted_GetRef();
+	Notification.Type = Event.Type;
+	Notification.InstigatorId = Event.InstigatorId;
+	Notification.TargetId = Event.TargetId;
+	Notification.InstigatorTeam = Event.InstigatorTeam;
+	Notification.TargetTeam = Event.TargetTeam;
+	Notification.Value = Event.Value;
+	Notification.TargetLocation = Event.TargetLocation;
+	Notification.InstigatorLocation = Event.InstigatorLocation;
+}
+
+void UShooterCombatNotifySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingNotifications.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterCombatNotifySend);
+
+	// local players are handled by the server's own event subscribers
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		AShooterPlayerController* ShooterPC = Cast<AShooterPlayerController>(It->Get());
+		if (ShooterPC && !ShooterPC->IsLocalController())
+		{
+			SendToConnection(ShooterPC);
+		}
+	}
+
+	// keep the allocation for the next frame
+	PendingNotifications.Reset();
+}
+
+TStatId UShooterCombatNotifySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterCombatNotifySubsystem, STATGROUP_Tickables);
+}
+
+int32 UShooterCombatNotifySubsystem::GetRelevance(const FShooterCombatNotification& Notification, int32 ReceiverId, uint8 ReceiverTeam, const FVector& ReceiverLocation)
+{
+	const bool bAboutReceiver = ReceiverId != INDEX_NONE && (Notification.InstigatorId == ReceiverId || Notification.TargetId == ReceiverId);
+	if (bAboutReceiver)
+	{
+		return 2;
+	}
+
+	// death screens and respawns only matter to the player they happened to
+	if (Notification.Type != EShooterGameplayEventType::Kill)
+	{
+		return 0;
+	}
+
+	// kills involving a teammate are always worth showing
+	if (ReceiverTeam != 255 && (Notification.InstigatorTeam == ReceiverTeam || Notification.TargetTeam == ReceiverTeam))
+	{
+		return 1;
+	}
+
+	// other kills only when the receiver is close enough to either pawn to have the fight replicated
+	const float RelevantDistance = ShooterCombatNotify::RelevantDistance;
+	if (RelevantDistance <= 0.0f)
+	{
+		return 1;
+	}
+
+	const float RelevantDistanceSquared = FMath::Square(RelevantDistance);
+	const bool bNearby = FVector::DistSquared(Notification.TargetLocation, ReceiverLocation) <= RelevantDistanceSquared
+		|| FVector::DistSquared(Notification.InstigatorLocation, ReceiverLocation) <= RelevantDistanceSquared;
+
+	return bNearby ? 1 : 0;
+}
+
+void UShooterCombatNotifySubsystem::SendToConnection(AShooterPlayerController* PlayerController)
+{
+	const int32 ReceiverId = UShooterGameplayEventSubsystem::GetPlayerId(PlayerController);
+
+	// receivers that control no combatant (between lives) have no team, so they only get nearby kills
+	const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>();
+	const uint8 ReceiverTeam = Combatants ? Combatants->GetTeamForController(PlayerController) : 255;
+
+	// the view point follows the camera while spectating or on the death screen
+	FVector ReceiverLocation;
+	FRotator ReceiverRotation;
+	PlayerController->GetPlayerViewPoint(ReceiverLocation, ReceiverRotation);
+
+	const int32 MaxPerBatch = FMath::Clamp(ShooterCombatNotify::MaxPerBatch, 1, (int32)ShooterCombatNotify::MaxNotificationsPerBatch);
+
+	TArray<FShooterCombatNotification>& Notifications = OutgoingBatch.Notifications;
+	Notifications.Reset();
+
+	TArray<FShooterCombatNotification>& PersonalNotifications = OutgoingPersonalBatch.Notifications;
+	PersonalNotifications.Reset();
+
+	// the receiver's own deaths and respawns are never culled or lost, they drive the death screen
+	int32 NumRelevant = 0;
+	for (const FShooterCombatNotification& Notification : PendingNotifications)
+	{
+		const int32 Relevance = GetRelevance(Notification, ReceiverId, ReceiverTeam, ReceiverLocation);
+		if (Notification.Type != EShooterGameplayEventType::Kill)
+		{
+			if (Relevance > 0 && PersonalNotifications.Num() < (int32)ShooterCombatNotify::MaxNotificationsPerBatch)
+			{
+				PersonalNotifications.Add(Notification);
+			}
+		}
+		else
+		{
+			NumRelevant += Relevance > 0 ? 1 : 0;
+		}
+	}
+
+	// everything fits: keep the publish order. Otherwise the receiver's own notifications go first
+	const int32 FirstPassRelevance = NumRelevant > MaxPerBatch ? 2 : 1;
+	for (int32 PassRelevance = FirstPassRelevance; PassRelevance >= 1; --PassRelevance)
+	{
+		for (const FShooterCombatNotification& Notification : PendingNotifications)
+		{
+			if (Notifications.Num() >= MaxPerBatch)
+			{
+				break;
+			}
+
+			if (Notification.Type != EShooterGameplayEventType::Kill)
+			{
+				continue;
+			}
+
+			const int32 Relevance = GetRelevance(Notification, ReceiverId, ReceiverTeam, ReceiverLocation);
+			const bool bInPass = PassRelevance == FirstPassRelevance ? Relevance >= PassRelevance : Relevance == PassRelevance;
+			if (bInPass)
+			{
+				Notifications.Add(Notification);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterCombatNotificationsCulled, PendingNotifications.Num() - Notifications.Num() - PersonalNotifications.Num());
+
+	if (PersonalNotifications.Num() > 0)
+	{
+		PlayerController->ClientReceivePersonalCombatNotifications(OutgoingPersonalBatch);
+
+		INC_DWORD_STAT(STAT_ShooterCombatNotifyBatches);
+		INC_DWORD_STAT_BY(STAT_ShooterCombatNotificationsSent, PersonalNotifications.Num());
+	}
+
+	if (Notifications.Num() > 0)
+	{
+		PlayerController->ClientReceiveCombatNotifications(OutgoingBatch);
+
+		INC_DWORD_STAT(STAT_ShooterCombatNotifyBatches);
+		INC_DWORD_STAT_BY(STAT_ShooterCombatNotificationsSent, Notifications.Num());
+	}
+}
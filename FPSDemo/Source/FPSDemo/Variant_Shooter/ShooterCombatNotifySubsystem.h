@@ -0,0 +1,130 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterCombatNotifySubsystem.generated.h"
+
+class AShooterPlayerController;
+
+/**
+ *  一条战斗通知（击杀提示、死亡界面、重生）
+ *  玩家以 PlayerId 标识，客户端从复制的玩家列表解析显示名字
+ */
+USTRUCT(BlueprintType)
+struct FShooterCombatNotification
+{
+	GENERATED_BODY()
+
+	/** 通知类型（击杀、死亡或重生） */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	EShooterGameplayEventType Type = EShooterGameplayEventType::Kill;
+
+	/** 发起者（击杀者）的 PlayerId，NPC 为 INDEX_NONE */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	int32 InstigatorId = INDEX_NONE;
+
+	/** 目标（被击杀者、重生者）的 PlayerId，NPC 为 INDEX_NONE */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	int32 TargetId = INDEX_NONE;
+
+	/** 发起者的团队 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	uint8 InstigatorTeam = 255;
+
+	/** 目标的团队 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	uint8 TargetTeam = 255;
+
+	/** 死亡通知的重生等待时间（秒） */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	float Value = 0.0f;
+
+	/** 目标的位置（只在服务器上用于相关性判断，不发送） */
+	FVector TargetLocation = FVector::ZeroVector;
+
+	/** 发起者的位置（只在服务器上用于相关性判断，不发送） */
+	FVector InstigatorLocation = FVector::ZeroVector;
+};
+
+/**
+ *  发往一个客户端连接的战斗通知批次
+ *  自定义网络序列化：类型 3 位，PlayerId 使用变长整数，重生时间量化为 0.1 秒，只有死亡通知写入
+ */
+USTRUCT(BlueprintType)
+struct FShooterCombatNotificationBatch
+{
+	GENERATED_BODY()
+
+	/** 本帧与该连接相关的通知 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	TArray<FShooterCombatNotification> Notifications;
+
+	/** 序列化批次 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterCombatNotificationBatch> : public TStructOpsTypeTraitsBase2<FShooterCombatNotificationBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ *  战斗通知网络通道子系统（服务器）
+ *  功能：
+ *  - 订阅游戏事件总线的击杀、死亡和重生事件，收集一帧内的所有通知
+ *  - 击杀提示：每帧为每个远程玩家连接最多发送一个不可靠的批次，而不是每次击杀发送一次多播 RPC
+ *  - 死亡和重生只发给本人，走可靠批次（死亡界面的显示和隐藏不能因丢包而卡住）
+ *  - 只发送被击杀者是玩家的击杀，与客户端击杀提示的过滤一致（NPC 被击杀不占用带宽）
+ *  - 击杀只发给相关的连接：接收者本人参与的击杀、队友参与的击杀，以及击杀者或被击杀者在接收者视点 Shooter.CombatNotify.RelevantDistance 范围内的击杀
+ *  - 每个击杀批次最多 Shooter.CombatNotify.MaxPerBatch 条，优先保留与接收者本人相关的击杀
+ *  - 客户端收到后把通知重新发布到本地的事件总线，本地消费者和服务器上的消费者使用相同的代码
+ */
+UCLASS()
+class FPSDEMO_API UShooterCombatNotifySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Subscribes to the gameplay events on the server */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Sends the notifications collected this frame */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 收集一个需要通知客户端的事件 */
+	void OnCombatEvent(const FShooterGameplayEvent& Event);
+
+	/**
+	 *  返回通知与接收者的相关性（0 = 不相关，1 = 相关，2 = 与接收者本人相关）
+	 *  @param ReceiverId		接收者的 PlayerId
+	 *  @param ReceiverTeam		接收者的团队（255 = 未知，不按团队判断）
+	 *  @param ReceiverLocation	接收者的视点位置
+	 */
+	static int32 GetRelevance(const FShooterCombatNotification& Notification, int32 ReceiverId, uint8 ReceiverTeam, const FVector& ReceiverLocation);
+
+	/** 把本帧的通知发送给一个连接 */
+	void SendToConnection(AShooterPlayerController* PlayerController);
+
+	/** 本帧收集的通知，跨帧复用内存 */
+	TArray<FShooterCombatNotification> PendingNotifications;
+
+	/** 正在构建的击杀批次（不可靠），跨帧复用内存 */
+	FShooterCombatNotificationBatch OutgoingBatch;
+
+	/** 正在构建的死亡和重生批次（可靠），跨帧复用内存 */
+	FShooterCombatNotificationBatch OutgoingPersonalBatch;
+};
@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterCombatState.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/NetSerialization.h"
+#include "FPSDemo.h"
+
+namespace ShooterCombatState
+{
+	/** Largest team ID that fits the compact team encoding */
+	static constexpr uint8 MaxSmallTeam = 3;
+
+	static FAutoConsoleCommand LogSizesCommand(
+		TEXT("Shooter.Net.CombatStateBits"),
+		TEXT("Logs the NetSerialize payload size of typical combat states. This is the payload only, not measured traffic."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			struct FSample
+			{
+				const TCHAR* Name;
+				float HP;
+				uint8 TeamByte;
+				uint8 Flags;
+			};
+
+			const FSample Samples[] =
+			{
+				{ TEXT("spawned, invulnerable"), 500.0f, 0, ShooterCombatFlags::Invulnerable },
+				{ TEXT("alive, damaged"), 237.5f, 1, 0 },
+				{ TEXT("alive, low health"), 12.0f, 2, 0 },
+				{ TEXT("dead"), 0.0f, 1, ShooterCombatFlags::Dead },
+				{ TEXT("alive, large team id"), 100.0f, 200, 0 }
+			};
+
+			for (const FSample& Sample : Samples)
+			{
+				FShooterCombatState State;
+				State.SetHP(Sample.HP);
+				State.TeamByte = Sample.TeamByte;
+				State.Flags = Sample.Flags;
+
+				FNetBitWriter Writer(nullptr, 256);
+				bool bSuccess = true;
+				State.NetSerialize(Writer, nullptr, bSuccess);
+
+				UE_LOG(LogFPSDemo, Display, TEXT("%-24s packed %3lld bits"), Sample.Name, Writer.GetNumBits());
+			}
+		}));
+}
+
+bool FShooterCombatState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	// partial-byte reads only write the bits they read
+	if (Ar.IsLoading())
+	{
+		Flags = 0;
+		TeamByte = 0;
+	}
+
+	Ar.SerializeBits(&Flags, ShooterCombatFlags::NumBits);
+
+	// dead characters always have zero health, so it isn't sent
+	if (HasFlag(ShooterCombatFlags::Dead))
+	{
+		if (Ar.IsLoading())
+		{
+			QuantizedHP = 0;
+		}
+	}
+	else
+	{
+		uint32 PackedHP = QuantizedHP;
+		Ar.SerializeIntPacked(PackedHP);
+		QuantizedHP = (uint16)FMath::Min<uint32>(PackedHP, MAX_uint16);
+	}
+
+	// most matches only use a handful of teams
+	uint8 bSmallTeam = TeamByte <= ShooterCombatState::MaxSmallTeam ? 1 : 0;
+	Ar.SerializeBits(&bSmallTeam, 1);
+	Ar.SerializeBits(&TeamByte, bSmallTeam ? 2 : 8);
+
+	return true;
+}
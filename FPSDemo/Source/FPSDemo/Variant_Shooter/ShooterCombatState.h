@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterCombatState.generated.h"
+
+/** 战斗状态标志位 */
+namespace ShooterCombatFlags
+{
+	/** 处于重生无敌状态 */
+	constexpr uint8 Invulnerable = 1 << 0;
+
+	/** 已经死亡 */
+	constexpr uint8 Dead = 1 << 1;
+
+	/** 网络序列化使用的位数 */
+	constexpr uint32 NumBits = 2;
+}
+
+/**
+ *  角色和 NPC 的打包战斗状态（生命值、团队、状态标志）
+ *  作为单个属性复制，客户端只触发一次 RepNotify
+ *  网络格式：
+ *  - 2 位状态标志
+ *  - 未死亡时：生命值按 0.1 点量化后的变长整数（死亡时生命值隐含为 0，不发送）
+ *  - 1 位"小团队"标志 + 2 位团队 ID（团队 0-3），否则 8 位团队 ID
+ *  只有状态实际变化时才会被发送（通过 operator== 比较）。没有针对上次确认状态的增量序列化，每次发送完整的打包状态
+ *  往返序列化测试见 FPSDemo.Shooter.CombatStateRoundTrip
+ */
+USTRUCT()
+struct FPSDEMO_API FShooterCombatState
+{
+	GENERATED_BODY()
+
+	/** 生命值量化精度（每点生命值的单位数） */
+	static constexpr float HPScale = 10.0f;
+
+	/** 量化后的生命值 */
+	uint16 QuantizedHP = 0;
+
+	/** 团队 ID */
+	uint8 TeamByte = 0;
+
+	/** ShooterCombatFlags 位掩码 */
+	uint8 Flags = 0;
+
+	/** 设置生命值（量化并截断到可表示范围） */
+	void SetHP(float HP)
+	{
+		QuantizedHP = (uint16)FMath::Clamp(FMath::RoundToInt(HP * HPScale), 0, (int32)MAX_uint16);
+	}
+
+	/** 返回反量化后的生命值 */
+	float GetHP() const { return QuantizedHP / HPScale; }
+
+	/** 返回是否设置了指定标志 */
+	bool HasFlag(uint8 Flag) const { return (Flags & Flag) != 0; }
+
+	/** 设置或清除指定标志 */
+	void SetFlag(uint8 Flag, bool bValue) { Flags = bValue ? (Flags | Flag) : (Flags & ~Flag); }
+
+	/** 网络序列化 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FShooterCombatState& Other) const
+	{
+		return QuantizedHP == Other.QuantizedHP && TeamByte == Other.TeamByte && Flags == Other.Flags;
+	}
+
+	bool operator!=(const FShooterCombatState& Other) const { return !(*this == Other); }
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterCombatState> : public TStructOpsTypeTraitsBase2<FShooterCombatState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -0,0 +1,146 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterCombatantSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Combatants"), STAT_ShooterCombatants, STATGROUP_Shooter);
+
+namespace ShooterCombatants
+{
+	static FAutoConsoleCommandWithWorld CmdReport(
+		TEXT("Shooter.Combatants.Report"),
+		TEXT("Logs every registered combatant with its controller, team and alive state."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterCombatantSubsystem* Combatants = World ? World->GetSubsystem<UShooterCombatantSubsystem>() : nullptr)
+			{
+				Combatants->LogReport();
+			}
+		}));
+}
+
+bool UShooterCombatantSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterCombatantSubsystem::UpdateCombatant(APawn* Pawn, uint8 TeamByte, bool bAlive)
+{
+	if (!Pawn)
+	{
+		return;
+	}
+
+	int32 Index = FindByPawn(Pawn);
+	if (Index == INDEX_NONE)
+	{
+		Index = Pawns.Add(Pawn);
+		Controllers.AddDefaulted();
+		Teams.Add(TeamByte);
+		AliveFlags.Add(bAlive);
+		IndexByPawn.Add(Pawn, Index);
+
+		SET_DWORD_STAT(STAT_ShooterCombatants, Pawns.Num());
+	}
+
+	Teams[Index] = TeamByte;
+	AliveFlags[Index] = bAlive;
+
+	SetController(Index, Pawn->GetController());
+}
+
+void UShooterCombatantSubsystem::UnregisterCombatant(APawn* Pawn)
+{
+	const int32 Index = FindByPawn(Pawn);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	SetController(Index, nullptr);
+	IndexByPawn.Remove(Pawn);
+
+	// swap the last combatant into the hole and fix up its lookups
+	const int32 LastIndex = Pawns.Num() - 1;
+	if (Index != LastIndex)
+	{
+		if (APawn* LastPawn = Pawns[LastIndex].Get())
+		{
+			IndexByPawn.Add(LastPawn, Index);
+		}
+
+		if (AController* LastController = Controllers[LastIndex].Get())
+		{
+			if (FindByController(LastController) == LastIndex)
+			{
+				IndexByController.Add(LastController, Index);
+			}
+		}
+
+		AliveFlags[Index] = AliveFlags[LastIndex];
+	}
+
+	Pawns.RemoveAtSwap(Index);
+	Controllers.RemoveAtSwap(Index);
+	Teams.RemoveAtSwap(Index);
+	AliveFlags.RemoveAt(LastIndex);
+
+	SET_DWORD_STAT(STAT_ShooterCombatants, Pawns.Num());
+}
+
+void UShooterCombatantSubsystem::SetController(int32 Index, AController* Controller)
+{
+	AController* OldController = Controllers[Index].Get();
+	if (OldController == Controller)
+	{
+		return;
+	}
+
+	// the controller may already have possessed a new pawn before this one let go
+	if (OldController && FindByController(OldController) == Index)
+	{
+		IndexByController.Remove(OldController);
+	}
+
+	Controllers[Index] = Controller;
+
+	if (Controller)
+	{
+		IndexByController.Add(Controller, Index);
+	}
+}
+
+int32 UShooterCombatantSubsystem::FindByPawn(const APawn* Pawn) const
+{
+	const int32* Index = Pawn ? IndexByPawn.Find(Pawn) : nullptr;
+	return Index ? *Index : INDEX_NONE;
+}
+
+int32 UShooterCombatantSubsystem::FindByController(const AController* Controller) const
+{
+	const int32* Index = Controller ? IndexByController.Find(Controller) : nullptr;
+	return Index ? *Index : INDEX_NONE;
+}
+
+uint8 UShooterCombatantSubsystem::GetTeamForController(const AController* Controller, uint8 DefaultTeam) const
+{
+	const int32 Index = FindByController(Controller);
+	return Index != INDEX_NONE ? Teams[Index] : DefaultTeam;
+}
+
+void UShooterCombatantSubsystem::LogReport() const
+{
+	UE_LOG(LogFPSDemo, Display, TEXT("%d registered combatants:"), Pawns.Num());
+
+	for (int32 Index = 0; Index < Pawns.Num(); ++Index)
+	{
+		UE_LOG(LogFPSDemo, Display, TEXT("  [%d] %s controller=%s team=%d %s"),
+			Index, *GetNameSafe(Pawns[Index].Get()), *GetNameSafe(Controllers[Index].Get()), Teams[Index], AliveFlags[Index] ? TEXT("alive") : TEXT("dead"));
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "ShooterCombatantSubsystem.generated.h"
+
+class AController;
+class APawn;
+
+/**
+ *  战斗者注册表子系统
+ *  功能：
+ *  - 以结构数组（SoA）保存所有玩家角色和 NPC 的控制器、Pawn、团队和存活状态，遍历时只读取需要的列
+ *  - 由角色在战斗状态变化（受伤、死亡、重生、回收）和控制器变化（占有、取消占有）时更新，EndPlay 时注销
+ *  - 按 Pawn 或控制器 O(1) 查找，替代 TActorIterator 扫描和 AShooterCharacter/AShooterNPC 的连续 Cast
+ *  - 服务器和客户端都会维护（客户端的数据来自复制的战斗状态）
+ *  - Shooter.Combatants.Report 输出当前注册的战斗者
+ */
+UCLASS()
+class FPSDEMO_API UShooterCombatantSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 注册或更新一个战斗者（控制器从 Pawn 当前的控制器读取） */
+	void UpdateCombatant(APawn* Pawn, uint8 TeamByte, bool bAlive);
+
+	/** 注销一个战斗者 */
+	void UnregisterCombatant(APawn* Pawn);
+
+	/** 返回 Pawn 的下标，未注册时返回 INDEX_NONE */
+	int32 FindByPawn(const APawn* Pawn) const;
+
+	/** 返回控制器当前控制的战斗者的下标，没有时返回 INDEX_NONE */
+	int32 FindByController(const AController* Controller) const;
+
+	/** 返回控制器所属的团队，没有控制战斗者时返回 DefaultTeam */
+	uint8 GetTeamForController(const AController* Controller, uint8 DefaultTeam = 255) const;
+
+	/** 返回战斗者数量 */
+	int32 Num() const { return Pawns.Num(); }
+
+	/** 返回战斗者的 Pawn（可能已失效） */
+	APawn* GetPawn(int32 Index) const { return Pawns[Index].Get(); }
+
+	/** 返回战斗者的控制器（可能为空） */
+	AController* GetController(int32 Index) const { return Controllers[Index].Get(); }
+
+	/** 返回战斗者的团队 */
+	uint8 GetTeam(int32 Index) const { return Teams[Index]; }
+
+	/** 返回战斗者是否存活 */
+	bool IsAlive(int32 Index) const { return AliveFlags[Index]; }
+
+	/** 输出当前注册的战斗者 */
+	void LogReport() const;
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** 把控制器映射到下标（替换旧的映射） */
+	void SetController(int32 Index, AController* Controller);
+
+	/** 各战斗者的 Pawn */
+	TArray<TWeakObjectPtr<APawn>> Pawns;
+
+	/** 各战斗者当前的控制器 */
+	TArray<TWeakObjectPtr<AController>> Controllers;
+
+	/** 各战斗者的团队 */
+	TArray<uint8> Teams;
+
+	/** 各战斗者是否存活 */
+	TBitArray<> AliveFlags;
+
+	/** Pawn 到下标 */
+	TMap<TObjectKey<APawn>, int32> IndexByPawn;
+
+	/** 控制器到下标 */
+	TMap<TObjectKey<AController>, int32> IndexByController;
+};
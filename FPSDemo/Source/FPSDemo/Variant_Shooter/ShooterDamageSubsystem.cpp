@@ -0,0 +1,279 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterDamageSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/PackageMapClient.h"
+#include "GameFramework/Pawn.h"
+#include "ShooterCharacter.h"
+#include "ShooterPlayerController.h"
+#include "AI/ShooterNPC.h"
+#include "ShooterProjectile.h"
+#include "ShooterLatencyTrace.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterTelemetry.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_ShooterDamageResolve, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Damage Events"), STAT_ShooterQueuedDamage, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Resolved Damage Victims"), STAT_ShooterResolvedVictims, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hit Confirm Batches"), STAT_ShooterHitConfirmBatches, STATGROUP_ShooterNet);
+
+namespace ShooterDamage
+{
+	/** Upper bound on hits accepted in a single batch when deserializing */
+	static constexpr uint32 MaxHitsPerBatch = 256;
+
+	/** A victim's damage merged over one frame */
+	struct FResolvedDamage
+	{
+		APawn* Victim = nullptr;
+		AController* LastInstigator = nullptr;
+		float Damage = 0.0f;
+		float AppliedDamage = 0.0f;
+		bool bKilled = false;
+	};
+}
+
+bool FShooterHitConfirmBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	uint32 NumHits = Hits.Num();
+	Ar.SerializeIntPacked(NumHits);
+
+	if (Ar.IsLoading())
+	{
+		if (NumHits > ShooterDamage::MaxHitsPerBatch)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+
+		Hits.SetNum(NumHits);
+	}
+
+	for (FShooterHitConfirm& Hit : Hits)
+	{
+		UObject* Victim = Hit.Victim;
+		bOutSuccess &= Map->SerializeObject(Ar, APawn::StaticClass(), Victim);
+
+		// whole hit points are enough for hit markers
+		uint16 QuantizedDamage = (uint16)FMath::Clamp(FMath::RoundToInt(Hit.Damage), 0, (int32)MAX_uint16);
+		Ar << QuantizedDamage;
+
+		uint8 bKilled = Hit.bKilled ? 1 : 0;
+		Ar.SerializeBits(&bKilled, 1);
+
+		// a single bit unless latency tracing is on
+		uint8 bTraced = Hit.LatencyTraceId != 0 ? 1 : 0;
+		Ar.SerializeBits(&bTraced, 1);
+
+		uint64 LatencyTraceId = bTraced ? Hit.LatencyTraceId : 0;
+		if (bTraced)
+		{
+			Ar << LatencyTraceId;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Hit.Victim = Cast<APawn>(Victim);
+			Hit.Damage = QuantizedDamage;
+			Hit.bKilled = bKilled != 0;
+			Hit.LatencyTraceId = LatencyTraceId;
+		}
+	}
+
+	return true;
+}
+
+bool UShooterDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterDamageSubsystem::QueueDamage(APawn* Victim, float Damage, AController* Instigator, AActor* DamageCauser)
+{
+	FShooterPendingDamage& Pending = PendingDamage.AddDefaulted_GetRef();
+	Pending.Victim = Victim;
+	Pending.Instigator = Instigator;
+	Pending.Damage = Damage;
+
+	// traced shots carry their correlation id on to the hit confirmation
+	if (const AShooterProjectile* Projectile = Cast<AShooterProjectile>(DamageCauser))
+	{
+		Pending.LatencyTraceId = Projectile->GetLatencyTraceId();
+	}
+
+	INC_DWORD_STAT(STAT_ShooterQueuedDamage);
+}
+
+void UShooterDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingDamage.Num() > 0)
+	{
+		ResolvePendingDamage();
+	}
+}
+
+TStatId UShooterDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterDamageSubsystem::ResolvePendingDamage()
+{
+	using namespace ShooterDamage;
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterDamageResolve);
+
+	// merge the queued damage per victim
+	TArray<FResolvedDamage, TInlineAllocator<32>> Resolved;
+
+	for (const FShooterPendingDamage& Pending : PendingDamage)
+	{
+		APawn* Victim = Pending.Victim.Get();
+		if (!Victim)
+		{
+			continue;
+		}
+
+		int32& Index = VictimIndices.FindOrAdd(Victim, INDEX_NONE);
+		if (Index == INDEX_NONE)
+		{
+			Index = Resolved.Num();
+			Resolved.AddDefaulted_GetRef().Victim = Victim;
+		}
+
+		FResolvedDamage& Entry = Resolved[Index];
+		Entry.Damage += Pending.Damage;
+
+		if (AController* Instigator = Pending.Instigator.Get())
+		{
+			Entry.LastInstigator = Instigator;
+		}
+	}
+
+	UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>();
+	UShooterTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UShooterTelemetrySubsystem>();
+
+	// apply each victim's damage once
+	for (FResolvedDamage& Entry : Resolved)
+	{
+		// one damage event per victim per frame with the HP actually taken, published before a kill's events.
+		// Victims that died or turned invulnerable while the damage was queued reject it, so nothing is published
+		const float AppliedDamage = GetApplicableDamage(Entry.Victim, Entry.Damage);
+		Entry.AppliedDamage = AppliedDamage;
+
+		if (Events && AppliedDamage > 0.0f)
+		{
+			Events->PublishCombat(EShooterGameplayEventType::Damage, Entry.LastInstigator, Entry.Victim, AppliedDamage);
+		}
+
+		if (Telemetry && AppliedDamage > 0.0f)
+		{
+			Telemetry->RecordCombat(EShooterTelemetryType::Damage, Entry.LastInstigator, Entry.Victim, AppliedDamage, Entry.Victim->GetActorLocation());
+		}
+
+		Entry.bKilled = ApplyAccumulatedDamage(Entry.Victim, Entry.Damage, Entry.LastInstigator);
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterResolvedVictims, Resolved.Num());
+
+	// group the hit confirms per shooter
+	for (const FShooterPendingDamage& Pending : PendingDamage)
+	{
+		APlayerController* Shooter = Cast<APlayerController>(Pending.Instigator.Get());
+		const int32* Index = VictimIndices.Find(Pending.Victim.Get());
+
+		if (!Shooter || !Index)
+		{
+			continue;
+		}
+
+		// rejected damage (victim already dead or invulnerable) is not confirmed, same as the damage event
+		const FResolvedDamage& Entry = Resolved[*Index];
+		if (Entry.AppliedDamage <= 0.0f || Entry.Damage <= 0.0f)
+		{
+			continue;
+		}
+
+		TArray<FShooterHitConfirm>& Hits = OutgoingBatches.FindOrAdd(Shooter).Hits;
+
+		FShooterHitConfirm* Hit = Hits.FindByPredicate([&Entry](const FShooterHitConfirm& Existing) { return Existing.Victim == Entry.Victim; });
+		if (!Hit)
+		{
+			Hit = &Hits.AddDefaulted_GetRef();
+			Hit->Victim = Entry.Victim;
+
+			// only the killing blow's owner gets credit for the kill
+			Hit->bKilled = Entry.bKilled && Entry.LastInstigator == Shooter;
+		}
+
+		// each shooter's share of the HP actually taken, so overkill matches the event bus and telemetry
+		Hit->Damage += Pending.Damage * (Entry.AppliedDamage / Entry.Damage);
+
+		if (Pending.LatencyTraceId != 0)
+		{
+			Hit->LatencyTraceId = Pending.LatencyTraceId;
+		}
+	}
+
+	UShooterLatencyTraceSubsystem* LatencyTrace = UShooterLatencyTraceSubsystem::IsEnabled() ? GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>() : nullptr;
+
+	// one RPC per shooter connection
+	for (TPair<APlayerController*, FShooterHitConfirmBatch>& Pair : OutgoingBatches)
+	{
+		if (AShooterPlayerController* ShooterPC = Cast<AShooterPlayerController>(Pair.Key))
+		{
+			ShooterPC->ClientConfirmHits(Pair.Value);
+			INC_DWORD_STAT(STAT_ShooterHitConfirmBatches);
+
+			if (LatencyTrace)
+			{
+				for (const FShooterHitConfirm& Hit : Pair.Value.Hits)
+				{
+					LatencyTrace->RecordStage(Hit.LatencyTraceId, EShooterLatencyStage::ConfirmSent);
+				}
+			}
+		}
+	}
+
+	// keep the allocations for the next frame
+	PendingDamage.Reset();
+	VictimIndices.Reset();
+	OutgoingBatches.Reset();
+}
+
+bool UShooterDamageSubsystem::ApplyAccumulatedDamage(APawn* Victim, float Damage, AController* LastInstigator)
+{
+	if (AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(Victim))
+	{
+		return ShooterCharacter->ApplyAccumulatedDamage(Damage, LastInstigator);
+	}
+
+	if (AShooterNPC* ShooterNPC = Cast<AShooterNPC>(Victim))
+	{
+		return ShooterNPC->ApplyAccumulatedDamage(Damage, LastInstigator);
+	}
+
+	return false;
+}
+
+float UShooterDamageSubsystem::GetApplicableDamage(const APawn* Victim, float Damage)
+{
+	if (const AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(Victim))
+	{
+		return ShooterCharacter->GetApplicableDamage(Damage);
+	}
+
+	if (const AShooterNPC* ShooterNPC = Cast<AShooterNPC>(Victim))
+	{
+		return ShooterNPC->GetApplicableDamage(Damage);
+	}
+
+	return 0.0f;
+}
@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterDamageSubsystem.generated.h"
+
+class AController;
+class APlayerController;
+
+/**
+ *  一次命中确认（同一帧内对同一目标的多次命中合并为一条）
+ */
+USTRUCT(BlueprintType)
+struct FShooterHitConfirm
+{
+	GENERATED_BODY()
+
+	/** 被命中的角色 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	TObjectPtr<APawn> Victim;
+
+	/** 本帧对该目标实际扣除的生命值中属于该射击者的部分（被拒绝的伤害不确认） */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	float Damage = 0.0f;
+
+	/** 本帧的伤害是否击杀了目标 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	bool bKilled = false;
+
+	/** 延迟追踪关联 ID（0 = 未追踪） */
+	uint64 LatencyTraceId = 0;
+};
+
+/**
+ *  发往一个射击者连接的命中确认批次
+ *  自定义网络序列化：数量使用变长整数，伤害量化为 16 位整数，击杀标志为 1 位，延迟追踪 ID 只在存在时写入
+ */
+USTRUCT(BlueprintType)
+struct FShooterHitConfirmBatch
+{
+	GENERATED_BODY()
+
+	/** 本帧的命中确认 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	TArray<FShooterHitConfirm> Hits;
+
+	/** 序列化批次 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterHitConfirmBatch> : public TStructOpsTypeTraitsBase2<FShooterHitConfirmBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/** 排队等待结算的一次伤害 */
+struct FShooterPendingDamage
+{
+	/** 受害者 */
+	TWeakObjectPtr<APawn> Victim;
+
+	/** 造成伤害的控制器 */
+	TWeakObjectPtr<AController> Instigator;
+
+	/** 伤害数值 */
+	float Damage = 0.0f;
+
+	/** 造成伤害的投射物携带的延迟追踪关联 ID */
+	uint64 LatencyTraceId = 0;
+};
+
+/**
+ *  伤害累积子系统
+ *  功能：
+ *  - 服务器在 TakeDamage 中只把伤害排队，不立即修改生命值
+ *  - 每帧（所有 Actor Tick 之后、网络复制之前）按受害者合并伤害，一次性结算生命值、HUD 更新和死亡
+ *  - 结算后为每个射击者连接发送一个命中确认批次 RPC，而不是每次命中发送一次
+ */
+UCLASS()
+class FPSDEMO_API UShooterDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 服务器端：为受害者排队一次伤害，本帧结束时统一结算 */
+	void QueueDamage(APawn* Victim, float Damage, AController* Instigator, AActor* DamageCauser);
+
+	/** 立即结算所有排队的伤害 */
+	void ResolvePendingDamage();
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Resolves the damage queued this frame */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 对受害者结算合并后的伤害，返回是否导致死亡 */
+	static bool ApplyAccumulatedDamage(APawn* Victim, float Damage, AController* LastInstigator);
+
+	/** 返回受害者实际会受到的伤害（已死亡、无敌或不是射击游戏的 Pawn 时为 0） */
+	static float GetApplicableDamage(const APawn* Victim, float Damage);
+
+	/** 本帧排队的伤害（按到达顺序） */
+	TArray<FShooterPendingDamage> PendingDamage;
+
+	/** 结算时使用的受害者索引（受害者 -> 合并结果下标），跨帧复用内存 */
+	TMap<APawn*, int32> VictimIndices;
+
+	/** 结算时使用的射击者批次，跨帧复用内存 */
+	TMap<APlayerController*, FShooterHitConfirmBatch> OutgoingBatches;
+};
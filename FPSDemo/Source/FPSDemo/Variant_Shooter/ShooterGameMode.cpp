@@ -2,44 +2,304 @@
 
 
 #include "Variant_Shooter/ShooterGameMode.h"
+#include "ShooterGameState.h"
+#include "ShooterCombatantSubsystem.h"
 #include "ShooterUI.h"
 #include "ShooterCharacter.h"
 #include "Variant_Shooter/AI/ShooterAIController.h"
+#include "ShooterAIPopulationSubsystem.h"
+#include "ShooterRoundSubsystem.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterGameplayTrace.h"
+#include "ShooterTelemetry.h"
+#include "GameFramework/PlayerState.h"
+#include "ShooterPlayerController.h"
 #include "Variant_Shooter/AI/ShooterNPC.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
-#include "Net/UnrealNetwork.h"
 #include "TimerManager.h"
 #include "Engine/Engine.h"
 #include "GameFramework/PlayerController.h"
 #include "AIController.h"
 #include "Components/StateTreeAIComponent.h"
-#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/Ticker.h"
+#include "UObject/UObjectGlobals.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
 
-void AShooterGameMode::BeginPlay()
+DECLARE_CYCLE_STAT(TEXT("Round Reset"), STAT_ShooterRoundReset, STATGROUP_Shooter);
+
+namespace ShooterRound
 {
-	Super::BeginPlay();
+	static bool bUseServerTravel = false;
+	static FAutoConsoleVariableRef CVarUseServerTravel(
+		TEXT("Shooter.Round.UseServerTravel"),
+		bUseServerTravel,
+		TEXT("If true, restarting the game reloads the map with ServerTravel instead of resetting the round in place."));
 
-	// Initialize replicated scores
-	TeamScores.Empty();
+	static AShooterGameMode* GetGameMode(UWorld* World)
+	{
+		return World ? World->GetAuthGameMode<AShooterGameMode>() : nullptr;
+	}
 
-	// Initialize player stats
-	PlayerStatsArray.Empty();
+	/** Returns the URL that reloads the current map */
+	static FString GetReloadURL(const UWorld* World)
+	{
+		// Remove the "UEDPIE_" prefix if present (for PIE)
+		FString MapName = World->GetMapName();
+		MapName.RemoveFromStart(TEXT("UEDPIE_"));
+		return MapName;
+	}
 
-	// Initialize game time
-	if (HasAuthority())
+	/** A running benchmark. Kept outside the world, so the ServerTravel baseline survives the map change */
+	struct FBenchmark
+	{
+		TWeakObjectPtr<UWorld> World;
+		bool bRunning = false;
+		bool bTravel = false;
+		int32 RunsLeft = 0;
+		int32 Runs = 0;
+		double StartTime = 0.0;
+		double TotalMs = 0.0;
+		double WorstMs = 0.0;
+		double TotalFrameMs = 0.0;
+		double WorstFrameMs = 0.0;
+		FTSTicker::FDelegateHandle TickerHandle;
+		FDelegateHandle PostLoadMapHandle;
+	};
+
+	static FBenchmark Benchmark;
+
+	static void FinishBenchmark()
+	{
+		const int32 Runs = FMath::Max(1, Benchmark.Runs);
+
+		if (Benchmark.bTravel)
+		{
+			UE_LOG(LogFPSDemo, Display, TEXT("Round travel benchmark: %d ServerTravels to the same map, average %.2f ms, worst %.2f ms (call to map loaded)"),
+				Benchmark.Runs, Benchmark.TotalMs / Runs, Benchmark.WorstMs);
+		}
+		else
+		{
+			UE_LOG(LogFPSDemo, Display, TEXT("Round reset benchmark: %d resets, one per frame. Reset average %.2f ms, worst %.2f ms. Frame with the reset average %.2f ms, worst %.2f ms"),
+				Benchmark.Runs, Benchmark.TotalMs / Runs, Benchmark.WorstMs, Benchmark.TotalFrameMs / Runs, Benchmark.WorstFrameMs);
+		}
+
+		FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(Benchmark.PostLoadMapHandle);
+		Benchmark = FBenchmark();
+	}
+
+	/** Runs one reset per frame, and times the whole frame of the previous one */
+	static bool TickResetBenchmark(float DeltaTime)
+	{
+		const double Now = FPlatformTime::Seconds();
+
+		// the core ticker runs once per engine loop, so this is the reset plus the rest of its frame
+		if (Benchmark.Runs > 0)
+		{
+			const double FrameMs = (Now - Benchmark.StartTime) * 1000.0;
+			Benchmark.TotalFrameMs += FrameMs;
+			Benchmark.WorstFrameMs = FMath::Max(Benchmark.WorstFrameMs, FrameMs);
+		}
+
+		AShooterGameMode* GameMode = GetGameMode(Benchmark.World.Get());
+		if (!GameMode || Benchmark.RunsLeft == 0)
+		{
+			FinishBenchmark();
+			return false;
+		}
+
+		--Benchmark.RunsLeft;
+		++Benchmark.Runs;
+
+		Benchmark.StartTime = Now;
+		GameMode->ResetRound();
+		const double ElapsedMs = (FPlatformTime::Seconds() - Now) * 1000.0;
+
+		Benchmark.TotalMs += ElapsedMs;
+		Benchmark.WorstMs = FMath::Max(Benchmark.WorstMs, ElapsedMs);
+		return true;
+	}
+
+	/** Starts the next ServerTravel of the same map */
+	static bool TickTravelBenchmark(float DeltaTime)
 	{
-		GameStartTime = GetWorld()->GetTimeSeconds();
-		RemainingTime = GameTimeLimit;
+		UWorld* World = Benchmark.World.Get();
+		if (!World || Benchmark.RunsLeft == 0)
+		{
+			FinishBenchmark();
+			return false;
+		}
+
+		--Benchmark.RunsLeft;
+		++Benchmark.Runs;
+
+		Benchmark.StartTime = FPlatformTime::Seconds();
+		World->ServerTravel(GetReloadURL(World), false);
+		return false;
+	}
+
+	/** Times a travel once the reloaded map is in, then starts the next one on the next frame */
+	static void OnTravelBenchmarkMapLoaded(UWorld* LoadedWorld)
+	{
+		const double ElapsedMs = (FPlatformTime::Seconds() - Benchmark.StartTime) * 1000.0;
+		Benchmark.TotalMs += ElapsedMs;
+		Benchmark.WorstMs = FMath::Max(Benchmark.WorstMs, ElapsedMs);
+
+		Benchmark.World = LoadedWorld;
+		Benchmark.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickTravelBenchmark));
+	}
 
-		// Start timer to update remaining time (update every second)
-		if (GameTimeLimit > 0.0f)
+	static void StartBenchmark(UWorld* World, const TArray<FString>& Args, bool bTravel, int32 DefaultCount)
+	{
+		if (Benchmark.bRunning)
 		{
-			GetWorld()->GetTimerManager().SetTimer(TimeUpdateTimer, this, &AShooterGameMode::UpdateRemainingTime, 1.0f, true);
+			UE_LOG(LogFPSDemo, Warning, TEXT("A round benchmark is already running."));
+			return;
 		}
+
+		if (!GetGameMode(World))
+		{
+			return;
+		}
+
+		Benchmark = FBenchmark();
+		Benchmark.World = World;
+		Benchmark.bRunning = true;
+		Benchmark.bTravel = bTravel;
+		Benchmark.RunsLeft = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : DefaultCount);
+
+		if (bTravel)
+		{
+			Benchmark.PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddStatic(&OnTravelBenchmarkMapLoaded);
+			Benchmark.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickTravelBenchmark));
+		}
+		else
+		{
+			Benchmark.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickResetBenchmark));
+		}
+	}
+
+	static FAutoConsoleCommandWithWorld CmdReset(
+		TEXT("Shooter.Round.Reset"),
+		TEXT("Resets the round in place without reloading the map."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (AShooterGameMode* GameMode = GetGameMode(World))
+			{
+				GameMode->ResetRound();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs CmdBenchmark(
+		TEXT("Shooter.Round.Benchmark"),
+		TEXT("Resets the round in place once per frame a number of times and logs the reset time and the time of the frame it ran in. Shooter.Round.Benchmark [Count=10]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			StartBenchmark(World, Args, false, 10);
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs CmdBenchmarkTravel(
+		TEXT("Shooter.Round.BenchmarkTravel"),
+		TEXT("Baseline for Shooter.Round.Benchmark: ServerTravels to the same map a number of times and logs the time until the map is loaded. Shooter.Round.BenchmarkTravel [Count=3]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			StartBenchmark(World, Args, true, 3);
+		}));
+}
+
+AShooterGameMode::AShooterGameMode()
+{
+	// scores and stats live on the GameState so they replicate to clients
+	GameStateClass = AShooterGameState::StaticClass();
+}
+
+void AShooterGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Initialize game time
+	if (HasAuthority())
+	{
+		StartMatchTimer();
+	}
+
+	// the kill feed and death screen are driven by gameplay events instead of the combat code
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		Events->OnEvent(EShooterGameplayEventType::Kill).AddUObject(this, &AShooterGameMode::HandleKillEvent);
+		Events->OnEvent(EShooterGameplayEventType::Death).AddUObject(this, &AShooterGameMode::HandleDeathEvent);
+		Events->OnEvent(EShooterGameplayEventType::Respawn).AddUObject(this, &AShooterGameMode::HandleRespawnEvent);
+	}
+}
+
+void AShooterGameMode::HandleKillEvent(const FShooterGameplayEvent& Event)
+{
+	// the kill feed only lists players, like before
+	if (!ShooterUI || Event.TargetId == INDEX_NONE)
+	{
+		return;
+	}
+
+	// names are only formatted here, never on the combat path
+	if (const AShooterGameState* ShooterGameState = GetShooterGameState())
+	{
+		ShooterUI->BP_ShowKillFeed(ShooterGameState->GetPlayerNameById(Event.InstigatorId), ShooterGameState->GetPlayerNameById(Event.TargetId));
+	}
+}
+
+void AShooterGameMode::HandleDeathEvent(const FShooterGameplayEvent& Event)
+{
+	// 仅向被击杀的本地玩家显示死亡界面
+	if (!ShooterUI || !IsLocalPlayerId(Event.TargetId))
+	{
+		return;
+	}
+
+	if (const AShooterGameState* ShooterGameState = GetShooterGameState())
+	{
+		ShooterUI->BP_ShowDeathScreen(ShooterGameState->GetPlayerNameById(Event.InstigatorId), Event.Value);
+	}
+}
+
+void AShooterGameMode::HandleRespawnEvent(const FShooterGameplayEvent& Event)
+{
+	if (ShooterUI && IsLocalPlayerId(Event.TargetId))
+	{
+		ShooterUI->BP_HideDeathScreen();
+	}
+}
+
+bool AShooterGameMode::IsLocalPlayerId(int32 PlayerId) const
+{
+	const AShooterGameState* ShooterGameState = GetShooterGameState();
+	const APlayerState* PlayerState = ShooterGameState ? ShooterGameState->FindPlayerStateById(PlayerId) : nullptr;
+	const APlayerController* PC = PlayerState ? PlayerState->GetPlayerController() : nullptr;
+	return PC && PC->IsLocalController();
+}
+
+void AShooterGameMode::PublishMatchEnd(uint8 WinningTeamID)
+{
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		Events->Publish(EShooterGameplayEventType::MatchEnd, INDEX_NONE, WinningTeamID, INDEX_NONE, 255);
 	}
+}
 
+void AShooterGameMode::StartMatchTimer()
+{
+	// the start and end timestamps replicate once, clients count down locally
+	if (AShooterGameState* ShooterGameState = GetShooterGameState())
+	{
+		ShooterGameState->StartMatchClock(GameTimeLimit);
+	}
 
+	// a single timer for the end of the match instead of a looping one every second
+	if (GameTimeLimit > 0.0f)
+	{
+		GetWorld()->GetTimerManager().SetTimer(MatchEndTimer, this, &AShooterGameMode::OnMatchTimeExpired, GameTimeLimit, false);
+	}
 }
 
 void AShooterGameMode::IncrementTeamScore(uint8 TeamByte)
@@ -51,59 +311,45 @@ void AShooterGameMode::IncrementTeamScore(uint8 TeamByte)
 	}
 
 	// Don't increment if game has ended
-	if (bGameEnded)
+	if (IsGameEnded())
 	{
 		return;
 	}
 
-	// Find or create team score entry
-	int32 Score = 0;
-	int32 TeamIndex = INDEX_NONE;
-	
-	for (int32 i = 0; i < TeamScores.Num(); ++i)
+	AShooterGameState* ShooterGameState = GetShooterGameState();
+	if (!ShooterGameState)
 	{
-		if (TeamScores[i].TeamID == TeamByte)
-		{
-			TeamIndex = i;
-			Score = TeamScores[i].Score;
-			break;
-		}
+		return;
 	}
 
-	// increment the score for the given team
-	++Score;
+	// increment the score for the given team (only the changed team item replicates)
+	const int32 Score = ShooterGameState->AddTeamScore(TeamByte);
 
-	UE_LOG(LogTemp, Warning, TEXT("[IncrementTeamScore] Team %d score incremented to %d"), TeamByte, Score);
-
-	if (TeamIndex != INDEX_NONE)
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
 	{
-		// Update existing entry
-		TeamScores[TeamIndex].Score = Score;
+		Events->Publish(EShooterGameplayEventType::Score, INDEX_NONE, TeamByte, INDEX_NONE, 255, Score);
 	}
-	else
+
+	if (UShooterTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UShooterTelemetrySubsystem>())
 	{
-		// Create new entry
-		TeamScores.Add(FTeamScoreData(TeamByte, Score));
+		Telemetry->Record(EShooterTelemetryType::Score, INDEX_NONE, TeamByte, INDEX_NONE, 255, Score, FVector::ZeroVector);
 	}
 
+	SHOOTER_TRACE_FACT(Score, TeamByte, Score, 0);
+	UE_LOG(LogShooterGameplay, Verbose, TEXT("[IncrementTeamScore] Team %d score incremented to %d"), TeamByte, Score);
+
 	// update the UI for all players (scores will be replicated)
-	// UI updates will happen via OnRep_TeamScores on clients
+	// UI updates will happen via AShooterGameState::OnTeamScoreChanged on clients
 	// 注意：比分更新由 UI_Shooter widget 负责，这里不需要创建 WBP_ShooterUI
 	// WBP_ShooterUI 只用于结算面板，应该在游戏结束时才创建和显示
 	// 如果 ShooterUI 存在（可能是之前创建的），可以尝试更新，但通常不应该在这里创建
 	if (ShooterUI)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[IncrementTeamScore] Updating score in UI (bGameEnded: %d)"), bGameEnded);
 		// 注意：如果 ShooterUI 存在，可能是用于其他目的，但通常比分更新应该由 UI_Shooter 处理
 		ShooterUI->BP_UpdateScore(TeamByte, Score);
 	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("[IncrementTeamScore] ShooterUI is null - score update should be handled by UI_Shooter widget"));
-	}
 
 	// Check victory condition
-	UE_LOG(LogTemp, Warning, TEXT("[IncrementTeamScore] Calling CheckVictoryCondition"));
 	CheckVictoryCondition();
 }
 
@@ -116,36 +362,42 @@ void AShooterGameMode::CheckVictoryCondition()
 	}
 
 	// Don't check if game has already ended
-	if (bGameEnded)
+	if (IsGameEnded())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[CheckVictoryCondition] Game already ended, skipping check"));
 		return;
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("[CheckVictoryCondition] Checking victory condition - TargetScore: %d"), TargetScore);
-
 	// Check time limit first
 	CheckTimeLimit();
-	if (bGameEnded)
+	if (IsGameEnded())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[CheckVictoryCondition] Game ended due to time limit"));
+		UE_LOG(LogShooterGameplay, Verbose, TEXT("[CheckVictoryCondition] Game ended due to time limit"));
 		return;
 	}
 
-	// Check each team's score
-	for (const FTeamScoreData& ScoreData : TeamScores)
+	AShooterGameState* ShooterGameState = GetShooterGameState();
+	if (!ShooterGameState)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[CheckVictoryCondition] Team %d score: %d / %d"), 
-			ScoreData.TeamID, ScoreData.Score, TargetScore);
+		return;
+	}
 
+	// Check each team's score
+	for (const FShooterTeamScoreItem& ScoreData : ShooterGameState->GetTeamScores())
+	{
 		if (ScoreData.Score >= TargetScore)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[CheckVictoryCondition] VICTORY! Team %d reached target score %d"), 
+			SHOOTER_TRACE_FACT(Victory, ScoreData.TeamID, TargetScore, 0);
+			UE_LOG(LogShooterGameplay, Log, TEXT("[CheckVictoryCondition] Team %d reached target score %d"), 
 				ScoreData.TeamID, TargetScore);
 
 			// A team has won!
-			bGameEnded = true;
-			WinningTeam = ScoreData.TeamID;
+			ShooterGameState->EndGame(ScoreData.TeamID);
+
+			// 停止比赛时钟（剩余时间冻结在胜利时刻）
+			ShooterGameState->StopMatchClock();
+			GetWorld()->GetTimerManager().ClearTimer(MatchEndTimer);
+
+			PublishMatchEnd(ScoreData.TeamID);
 
 			// 禁用所有玩家的输入
 			DisableAllPlayerInput();
@@ -154,7 +406,6 @@ void AShooterGameMode::CheckVictoryCondition()
 			ShowGameEndScreenForAllPlayers(ScoreData.TeamID);
 
 			// Notify Blueprint
-			UE_LOG(LogTemp, Warning, TEXT("[CheckVictoryCondition] Calling BP_OnTeamVictory"));
 			BP_OnTeamVictory(ScoreData.TeamID);
 
 			// 不再自动重启游戏，改为玩家手动控制（移除自动重启定时器）
@@ -164,29 +415,33 @@ void AShooterGameMode::CheckVictoryCondition()
 	}
 }
 
-void AShooterGameMode::UpdateRemainingTime()
+void AShooterGameMode::OnMatchTimeExpired()
 {
 	// Only update on server
-	if (!HasAuthority() || bGameEnded)
+	if (!HasAuthority() || IsGameEnded())
 	{
 		return;
 	}
 
-	// Calculate remaining time
-	const float ElapsedTime = GetWorld()->GetTimeSeconds() - GameStartTime;
-	RemainingTime = FMath::Max(0.0f, GameTimeLimit - ElapsedTime);
-
-	// Check if time has run out
-	if (RemainingTime <= 0.0f)
+	// freeze the clock at zero so it doesn't depend on timer rounding
+	if (AShooterGameState* ShooterGameState = GetShooterGameState())
 	{
-		CheckTimeLimit();
+		ShooterGameState->StopMatchClock(true);
 	}
+
+	CheckTimeLimit();
+}
+
+float AShooterGameMode::GetRemainingTime() const
+{
+	const AShooterGameState* ShooterGameState = GetShooterGameState();
+	return ShooterGameState ? ShooterGameState->GetRemainingTime() : 0.0f;
 }
 
 void AShooterGameMode::CheckTimeLimit()
 {
 	// Only check on server
-	if (!HasAuthority() || bGameEnded)
+	if (!HasAuthority() || IsGameEnded())
 	{
 		return;
 	}
@@ -198,29 +453,31 @@ void AShooterGameMode::CheckTimeLimit()
 	}
 
 	// Check if time has run out
-	if (RemainingTime <= 0.0f)
+	if (GetRemainingTime() <= 0.0f)
 	{
-		// Time's up! Determine winner by score
-		bGameEnded = true;
+		AShooterGameState* ShooterGameState = GetShooterGameState();
+		if (!ShooterGameState)
+		{
+			return;
+		}
 
-		// Find team with highest score
+		// Time's up! Find team with highest score
 		int32 HighestScore = -1;
-		uint8 WinningTeamID = 255;
+		uint8 WinningTeam = 255;
 
-		for (const FTeamScoreData& ScoreData : TeamScores)
+		for (const FShooterTeamScoreItem& ScoreData : ShooterGameState->GetTeamScores())
 		{
 			if (ScoreData.Score > HighestScore)
 			{
 				HighestScore = ScoreData.Score;
-				WinningTeamID = ScoreData.TeamID;
+				WinningTeam = ScoreData.TeamID;
 			}
 		}
 
-		// If there's a tie, no winner (or could use other tie-breaker logic)
-		if (HighestScore >= 0)
-		{
-			WinningTeam = WinningTeamID;
-		}
+		// 比赛结束状态和获胜团队保存在 GameState 中复制到客户端（没有得分时没有获胜团队）
+		ShooterGameState->EndGame(WinningTeam);
+
+		PublishMatchEnd(WinningTeam);
 
 		// 禁用所有玩家的输入
 		DisableAllPlayerInput();
@@ -233,8 +490,8 @@ void AShooterGameMode::CheckTimeLimit()
 
 		// 不再自动重启游戏，改为玩家手动控制（移除自动重启定时器）
 
-		// Clear time update timer
-		GetWorld()->GetTimerManager().ClearTimer(TimeUpdateTimer);
+		// Clear match end timer
+		GetWorld()->GetTimerManager().ClearTimer(MatchEndTimer);
 	}
 }
 
@@ -273,12 +530,15 @@ void AShooterGameMode::ShowGameEndScreenForAllPlayers(uint8 WinningTeamID)
 	// 为所有玩家显示游戏结束界面
 	if (!HasAuthority())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Called on client, ignoring"));
 		return;
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Called - WinningTeamID: %d, bGameEnded: %d"), 
-		WinningTeamID, bGameEnded);
+	// 结算界面的统计数据（所有玩家相同）
+	AShooterGameState* ShooterGameState = GetShooterGameState();
+	const TArray<FPlayerStats> AllPlayerStats = ShooterGameState ? ShooterGameState->GetAllPlayerStats() : TArray<FPlayerStats>();
+
+	// 玩家的团队从战斗者注册表查找
+	const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>();
 
 	// 先为所有玩家创建 UI（如果还没有创建）
 	int32 PlayerCount = 0;
@@ -293,74 +553,25 @@ void AShooterGameMode::ShowGameEndScreenForAllPlayers(uint8 WinningTeamID)
 			}
 
 			PlayerCount++;
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Processing player %d: %s"), 
-				PlayerCount, *GetNameSafe(PC));
 
 			// 检查玩家所属的团队
 			// 注意：游戏结束时玩家可能已经死亡，GetPawn() 可能返回 nullptr
-			// 需要尝试多种方式获取团队 ID
-			uint8 PlayerTeam = 255;
-			
-			// 方法1：从当前控制的 Pawn 获取团队 ID
-			if (APawn* ControlledPawn = PC->GetPawn())
-			{
-				UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Player has Pawn: %s"), *GetNameSafe(ControlledPawn));
-				// 尝试从角色获取团队 ID（需要转换为 ShooterCharacter）
-				if (AShooterCharacter* ShooterChar = Cast<AShooterCharacter>(ControlledPawn))
-				{
-					PlayerTeam = ShooterChar->GetTeamByte();
-					UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Got team from Pawn: %d (Character: %s)"), 
-						PlayerTeam, *GetNameSafe(ShooterChar));
-				}
-				else
-				{
-					UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Pawn is not a ShooterCharacter"));
-				}
-			}
-			else
-			{
-				UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Player has no Pawn"));
-			}
-			
-			// 方法2：如果无法从 Pawn 获取，尝试从所有已存在的角色中查找该玩家的角色
-			// 这适用于玩家已死亡但角色还在世界中的情况
-			if (PlayerTeam == 255)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Could not get team from current Pawn, searching for player's character in world"));
-				
-				// 遍历世界中的所有 ShooterCharacter，查找属于这个玩家的角色
-				// 使用不同的变量名 CharIt 避免与外部循环的 It 冲突
-				for (TActorIterator<AShooterCharacter> CharIt(GetWorld()); CharIt; ++CharIt)
-				{
-					if (AShooterCharacter* ShooterChar = *CharIt)
-					{
-						// 检查这个角色是否属于当前玩家控制器
-						if (ShooterChar->GetController() == PC)
-						{
-							PlayerTeam = ShooterChar->GetTeamByte();
-							UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Found player's character in world, Team: %d"), PlayerTeam);
-							break;
-						}
-					}
-				}
-			}
-			
+			// 战斗者注册表按控制器记录团队（包括已死亡但仍被控制的角色），O(1) 查找
+			const uint8 PlayerTeam = Combatants ? Combatants->GetTeamForController(PC) : 255;
+
 			// 如果仍然无法获取团队 ID，记录警告
 			if (PlayerTeam == 255)
 			{
-				UE_LOG(LogTemp, Error, TEXT("[ShowGameEndScreenForAllPlayers] WARNING: Could not determine player team! PlayerTeam remains 255, bIsVictory will be false"));
+				UE_LOG(LogShooterGameplay, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Could not determine the team of %s, showing a defeat screen"), *GetNameSafe(PC));
 			}
 
 			// 判断玩家是否胜利（玩家团队与获胜团队相同）
 			// 注意：如果 PlayerTeam 是 255（未获取到），bIsVictory 将始终为 false
 			bool bIsVictory = (PlayerTeam != 255) && (PlayerTeam == WinningTeamID);
 
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] ===== VICTORY CHECK ====="));
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] PlayerTeam: %d, WinningTeamID: %d"), PlayerTeam, WinningTeamID);
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] PlayerTeam != 255: %d"), (PlayerTeam != 255));
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] PlayerTeam == WinningTeamID: %d"), (PlayerTeam == WinningTeamID));
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Final bIsVictory: %d"), bIsVictory);
-			UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] ========================="));
+			SHOOTER_TRACE_FACT(GameEndScreen, PlayerTeam, WinningTeamID, bIsVictory);
+			UE_LOG(LogShooterGameplay, Verbose, TEXT("[ShowGameEndScreenForAllPlayers] %s - PlayerTeam: %d, WinningTeamID: %d, bIsVictory: %d"),
+				*GetNameSafe(PC), PlayerTeam, WinningTeamID, bIsVictory);
 
 			// 优先使用已存在的共享 ShooterUI（在 IncrementTeamScore 中创建的）
 			// 这样可以避免创建多个 UI widget 导致重叠
@@ -379,62 +590,46 @@ void AShooterGameMode::ShowGameEndScreenForAllPlayers(uint8 WinningTeamID)
 				{
 					// 如果 ShooterUI 属于当前玩家，直接使用
 					PlayerUI = ShooterUI;
-					UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Using existing shared ShooterUI for player: %s"), 
-						*GetNameSafe(PC));
-				}
-				else
-				{
-					UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] ShooterUI exists but belongs to different player. ShooterUI owner: %s, Current player: %s"), 
-						*GetNameSafe(ShooterUIOwner), *GetNameSafe(PC));
 				}
 			}
-			else
-			{
-				UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] ShooterUI is null or invalid"));
-			}
 			
 			// 如果共享 UI 不可用，为这个玩家获取或创建独立的 UI
 			if (!PlayerUI)
 			{
-				UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Getting/creating UI for player: %s"), 
-					*GetNameSafe(PC));
 				PlayerUI = GetOrCreateUIForPlayer(PC);
 			}
 
 			if (PlayerUI)
 			{
 				// 三重检查：确保游戏确实已经结束
-				if (bGameEnded && WinningTeamID != 255)
+				if (IsGameEnded() && WinningTeamID != 255)
 				{
-					UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Calling BP_ShowGameEndScreen for player"));
-					UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Parameters - bIsVictory: %d, WinningTeamID: %d, PlayerTeam: %d"), 
-						bIsVictory, WinningTeamID, PlayerTeam);
 					// 显示游戏结束界面（仅在游戏真正结束时调用）
 					// 注意：这是唯一应该调用 BP_ShowGameEndScreen 的地方
 					// 如果蓝图中 BP_UpdateScore 或其他地方也调用了显示结算面板，那是错误的
-					PlayerUI->BP_ShowGameEndScreen(bIsVictory, WinningTeamID, PlayerTeam, PlayerStatsArray);
+					PlayerUI->BP_ShowGameEndScreen(bIsVictory, WinningTeamID, PlayerTeam, AllPlayerStats);
 				}
 				else
 				{
-					UE_LOG(LogTemp, Error, TEXT("[ShowGameEndScreenForAllPlayers] ERROR: Cannot show game end screen! bGameEnded: %d, WinningTeamID: %d"), 
-						bGameEnded, WinningTeamID);
+					UE_LOG(LogShooterGameplay, Error, TEXT("[ShowGameEndScreenForAllPlayers] Cannot show game end screen! bGameEnded: %d, WinningTeamID: %d"), 
+						IsGameEnded(), WinningTeamID);
 				}
 			}
 			else
 			{
-				UE_LOG(LogTemp, Error, TEXT("[ShowGameEndScreenForAllPlayers] Failed to get/create UI for player"));
+				UE_LOG(LogShooterGameplay, Error, TEXT("[ShowGameEndScreenForAllPlayers] Failed to get/create UI for player %s"), *GetNameSafe(PC));
 			}
 		}
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("[ShowGameEndScreenForAllPlayers] Completed - Processed %d players"), PlayerCount);
+	UE_LOG(LogShooterGameplay, Log, TEXT("[ShowGameEndScreenForAllPlayers] Showed the game end screen to %d local players (WinningTeamID: %d)"), PlayerCount, WinningTeamID);
 }
 
 UShooterUI* AShooterGameMode::GetOrCreateUIForPlayer(APlayerController* PC)
 {
 	if (!PC || !ShooterUIClass)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[GetOrCreateUIForPlayer] Invalid PC or ShooterUIClass"));
+		UE_LOG(LogShooterGameplay, Warning, TEXT("[GetOrCreateUIForPlayer] Invalid PC or ShooterUIClass"));
 		return nullptr;
 	}
 
@@ -443,8 +638,6 @@ UShooterUI* AShooterGameMode::GetOrCreateUIForPlayer(APlayerController* PC)
 	{
 		if (IsValid(*ExistingUI))
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[GetOrCreateUIForPlayer] Reusing existing UI widget for player: %s"), 
-				*GetNameSafe(PC));
 			return *ExistingUI;
 		}
 		else
@@ -455,19 +648,17 @@ UShooterUI* AShooterGameMode::GetOrCreateUIForPlayer(APlayerController* PC)
 	}
 
 	// 如果不存在，创建新的 UI widget
-	UE_LOG(LogTemp, Warning, TEXT("[GetOrCreateUIForPlayer] Creating new UI widget for player: %s"), 
+	UE_LOG(LogShooterGameplay, Verbose, TEXT("[GetOrCreateUIForPlayer] Creating new UI widget for player: %s"), 
 		*GetNameSafe(PC));
 
 	UShooterUI* PlayerUI = CreateWidget<UShooterUI>(PC, ShooterUIClass);
 	if (PlayerUI)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[GetOrCreateUIForPlayer] UI widget created and added to viewport"));
 		PlayerUI->AddToViewport(0);
 		
 		// 确保结算面板默认隐藏（只在游戏结束时显示）
 		// 注意：这需要在蓝图中实现 BP_HideGameEndScreen 来隐藏结算面板
 		PlayerUI->BP_HideGameEndScreen();
-		UE_LOG(LogTemp, Warning, TEXT("[GetOrCreateUIForPlayer] Called BP_HideGameEndScreen to ensure end screen is hidden"));
 		
 		// 将 UI 存储到 Map 中，避免重复创建
 		PlayerUIMap.Add(PC, PlayerUI);
@@ -475,25 +666,22 @@ UShooterUI* AShooterGameMode::GetOrCreateUIForPlayer(APlayerController* PC)
 		return PlayerUI;
 	}
 
-	UE_LOG(LogTemp, Error, TEXT("[GetOrCreateUIForPlayer] Failed to create UI widget"));
+	UE_LOG(LogShooterGameplay, Error, TEXT("[GetOrCreateUIForPlayer] Failed to create UI widget"));
 	return nullptr;
 }
 
 void AShooterGameMode::StopAllAIBehavior()
 {
-	// 遍历所有 AI Controller 并停止它们的行为
+	// 停止所有 AI Controller 的行为
 	if (!HasAuthority())
 	{
 		return;
 	}
 
-	for (TActorIterator<AShooterAIController> It(GetWorld()); It; ++It)
+	// AI 种群子系统在连续数组中跟踪所有 AI 控制器，不需要遍历 Actor
+	if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
 	{
-		if (AShooterAIController* ShooterAIC = *It)
-		{
-			// 调用 AI Controller 的公共方法来停止所有行为
-			ShooterAIC->StopAIBehavior(TEXT("GameEnded"));
-		}
+		Population->StopAll(TEXT("GameEnded"));
 	}
 }
 
@@ -505,43 +693,147 @@ void AShooterGameMode::RestartGame()
 		return;
 	}
 
+	// 默认原地重置回合，不重新加载地图
+	if (!ShooterRound::bUseServerTravel)
+	{
+		ResetRound();
+		return;
+	}
+
 	// 重置游戏状态
-	bGameEnded = false;
-	WinningTeam = 255;
-	TeamScores.Empty();
-	PlayerStatsArray.Empty();
+	if (AShooterGameState* ShooterGameState = GetShooterGameState())
+	{
+		ShooterGameState->ClearGameEnded();
+		ShooterGameState->ResetScores();
+	}
 	
 	// 清理玩家 UI Map（游戏重启时清除所有玩家的 UI 引用）
 	PlayerUIMap.Empty();
 
 	// 清除所有定时器
-	GetWorld()->GetTimerManager().ClearTimer(TimeUpdateTimer);
+	GetWorld()->GetTimerManager().ClearTimer(MatchEndTimer);
 	GetWorld()->GetTimerManager().ClearTimer(VictoryRestartTimer);
 
-	// 重新初始化游戏时间
-	GameStartTime = GetWorld()->GetTimeSeconds();
-	RemainingTime = GameTimeLimit;
+	// 重启游戏：重新加载当前地图
+	if (UWorld* World = GetWorld())
+	{
+		World->ServerTravel(ShooterRound::GetReloadURL(World), false);
+	}
+}
+
+void AShooterGameMode::ResetRound()
+{
+	// 仅在服务器端执行
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRoundReset);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// 清除定时器并重新开始比赛时钟
+	GetWorld()->GetTimerManager().ClearTimer(MatchEndTimer);
+	GetWorld()->GetTimerManager().ClearTimer(VictoryRestartTimer);
+
+	// 重置游戏状态
+	AShooterGameState* ShooterGameState = GetShooterGameState();
+	if (ShooterGameState)
+	{
+		ShooterGameState->ClearGameEnded();
+		ShooterGameState->ResetScores();
+	}
+
+	StartMatchTimer();
+
+	// NPC 回到出生点，已销毁的 NPC 重新生成，拾取物恢复
+	int32 NumNPCsRestored = 0;
+	int32 NumNPCsRespawned = 0;
+	int32 NumPickupsReset = 0;
+
+	if (UShooterRoundSubsystem* Round = GetWorld()->GetSubsystem<UShooterRoundSubsystem>())
+	{
+		Round->ResetNPCs(NumNPCsRestored, NumNPCsRespawned);
+		NumPickupsReset = Round->ResetLocalActors();
+	}
+
+	// 分帧重启所有 AI 的 StateTree（同时恢复被暂停或停止的 AI）
+	if (UShooterAIPopulationSubsystem* Population = GetWorld()->GetSubsystem<UShooterAIPopulationSubsystem>())
+	{
+		Population->RestartAll(true);
+	}
+
+	// 玩家角色原地回收到出生点（回收失败时销毁，由玩家控制器重新生成）
+	int32 NumPlayersReset = 0;
 
-	// 重新启用所有玩家的输入
 	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
 	{
-		if (APlayerController* PC = It->Get())
+		APlayerController* PC = It->Get();
+		if (!PC)
 		{
-			if (APawn* ControlledPawn = PC->GetPawn())
+			continue;
+		}
+
+		AShooterPlayerController* ShooterPC = Cast<AShooterPlayerController>(PC);
+		AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(PC->GetPawn());
+
+		if (ShooterPC && ShooterCharacter)
+		{
+			if (!ShooterPC->RecyclePawn(ShooterCharacter))
 			{
-				ControlledPawn->EnableInput(PC);
+				ShooterCharacter->Destroy();
 			}
 		}
+		else if (!PC->GetPawn())
+		{
+			RestartPlayer(PC);
+		}
+		else
+		{
+			PC->GetPawn()->EnableInput(PC);
+		}
+
+		// 恢复游戏输入模式（游戏结束时切换到了 UI 模式）
+		PC->SetShowMouseCursor(false);
+		PC->SetInputMode(FInputModeGameOnly());
+
+		++NumPlayersReset;
 	}
 
-	// 重启游戏：重新加载当前地图
-	if (UWorld* World = GetWorld())
+	// 隐藏结算和死亡界面，保留 UI widget 供下一回合使用
+	if (ShooterUI)
 	{
-		FString CurrentMapName = World->GetMapName();
-		// Remove the "UEDPIE_" prefix if present (for PIE)
-		CurrentMapName.RemoveFromStart(TEXT("UEDPIE_"));
-		World->ServerTravel(CurrentMapName, false);
+		ShooterUI->BP_HideGameEndScreen();
+		ShooterUI->BP_HideDeathScreen();
 	}
+
+	for (const TPair<APlayerController*, TObjectPtr<UShooterUI>>& PlayerUI : PlayerUIMap)
+	{
+		if (IsValid(PlayerUI.Value))
+		{
+			PlayerUI.Value->BP_HideGameEndScreen();
+			PlayerUI.Value->BP_HideDeathScreen();
+		}
+	}
+
+	// 通知客户端新回合开始（客户端重置本地拾取物）
+	if (ShooterGameState)
+	{
+		ShooterGameState->BeginNewRound();
+	}
+
+	// 每个回合写入单独的遥测文件
+	if (UShooterTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UShooterTelemetrySubsystem>())
+	{
+		if (Telemetry->IsRecording())
+		{
+			Telemetry->Restart();
+		}
+	}
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Round %d reset in place in %.2f ms: %d NPCs restored, %d NPCs respawned, %d pickups, %d players"),
+		ShooterGameState ? ShooterGameState->GetRoundNumber() : 0, (FPlatformTime::Seconds() - StartTime) * 1000.0,
+		NumNPCsRestored, NumNPCsRespawned, NumPickupsReset, NumPlayersReset);
 }
 
 void AShooterGameMode::QuitGame()
@@ -567,38 +859,15 @@ void AShooterGameMode::RestartGameAfterVictory()
 	RestartGame();
 }
 
-void AShooterGameMode::OnRep_TeamScores()
+bool AShooterGameMode::IsGameEnded() const
 {
-	// Update UI when scores are replicated
-	// 注意：比分更新应该由 UI_Shooter widget 处理，这里不需要创建 WBP_ShooterUI
-	// WBP_ShooterUI 只用于结算面板，应该在游戏结束时才创建
-	// 如果 ShooterUI 存在，可以尝试更新，但通常比分更新应该由 UI_Shooter 处理
-	if (ShooterUI)
-	{
-		for (const FTeamScoreData& ScoreData : TeamScores)
-		{
-			ShooterUI->BP_UpdateScore(ScoreData.TeamID, ScoreData.Score);
-		}
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("[OnRep_TeamScores] ShooterUI is null - score update should be handled by UI_Shooter widget"));
-	}
+	const AShooterGameState* ShooterGameState = GetShooterGameState();
+	return ShooterGameState && ShooterGameState->IsGameEnded();
 }
 
-void AShooterGameMode::OnRep_RemainingTime()
+AShooterGameState* AShooterGameMode::GetShooterGameState() const
 {
-	// Update UI when remaining time changes
-	// 注意：时间更新应该由 UI_Shooter widget 处理，这里不需要创建 WBP_ShooterUI
-	// WBP_ShooterUI 只用于结算面板，应该在游戏结束时才创建
-	if (ShooterUI)
-	{
-		ShooterUI->BP_UpdateRemainingTime(RemainingTime);
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("[OnRep_RemainingTime] ShooterUI is null - time update should be handled by UI_Shooter widget"));
-	}
+	return GetGameState<AShooterGameState>();
 }
 
 void AShooterGameMode::RecordKill(APlayerController* KillerController)
@@ -609,26 +878,12 @@ void AShooterGameMode::RecordKill(APlayerController* KillerController)
 		return;
 	}
 
-	// Find or create stats entry
-	int32 StatsIndex = INDEX_NONE;
-	for (int32 i = 0; i < PlayerStatsArray.Num(); ++i)
-	{
-		if (PlayerStatsArray[i].PlayerController == KillerController)
-		{
-			StatsIndex = i;
-			break;
-		}
-	}
-
-	if (StatsIndex != INDEX_NONE)
+	// stats are keyed by the stable PlayerState id, looked up in O(1)
+	const int32 PlayerId = AShooterGameState::GetPlayerIdFor(KillerController);
+	AShooterGameState* ShooterGameState = GetShooterGameState();
+	if (ShooterGameState && PlayerId != INDEX_NONE)
 	{
-		PlayerStatsArray[StatsIndex].Kills++;
-	}
-	else
-	{
-		FPlayerStats NewStats(KillerController);
-		NewStats.Kills = 1;
-		PlayerStatsArray.Add(NewStats);
+		ShooterGameState->AddKill(PlayerId);
 	}
 }
 
@@ -640,54 +895,16 @@ void AShooterGameMode::RecordDeath(APlayerController* VictimController)
 		return;
 	}
 
-	// Find or create stats entry
-	int32 StatsIndex = INDEX_NONE;
-	for (int32 i = 0; i < PlayerStatsArray.Num(); ++i)
+	const int32 PlayerId = AShooterGameState::GetPlayerIdFor(VictimController);
+	AShooterGameState* ShooterGameState = GetShooterGameState();
+	if (ShooterGameState && PlayerId != INDEX_NONE)
 	{
-		if (PlayerStatsArray[i].PlayerController == VictimController)
-		{
-			StatsIndex = i;
-			break;
-		}
-	}
-
-	if (StatsIndex != INDEX_NONE)
-	{
-		PlayerStatsArray[StatsIndex].Deaths++;
-	}
-	else
-	{
-		FPlayerStats NewStats(VictimController);
-		NewStats.Deaths = 1;
-		PlayerStatsArray.Add(NewStats);
+		ShooterGameState->AddDeath(PlayerId);
 	}
 }
 
 FPlayerStats AShooterGameMode::GetPlayerStats(APlayerController* PlayerController) const
 {
-	for (const FPlayerStats& Stats : PlayerStatsArray)
-	{
-		if (Stats.PlayerController == PlayerController)
-		{
-			return Stats;
-		}
-	}
-	return FPlayerStats();
-}
-
-void AShooterGameMode::OnRep_PlayerStats()
-{
-	// Update UI when player stats change
-	// This can be used in Blueprint to update statistics display
-}
-
-void AShooterGameMode::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
-{
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-
-	DOREPLIFETIME(AShooterGameMode, TeamScores);
-	DOREPLIFETIME(AShooterGameMode, bGameEnded);
-	DOREPLIFETIME(AShooterGameMode, WinningTeam);
-	DOREPLIFETIME(AShooterGameMode, RemainingTime);
-	DOREPLIFETIME(AShooterGameMode, PlayerStatsArray);
+	const AShooterGameState* ShooterGameState = GetShooterGameState();
+	return ShooterGameState ? ShooterGameState->GetPlayerStats(PlayerController) : FPlayerStats();
 }
@@ -9,34 +9,19 @@
 #include "ShooterGameMode.generated.h"
 
 class APlayerController;
+class AShooterGameState;
+struct FShooterGameplayEvent;
 
 
-
-/** Structure to hold team score data */
-USTRUCT()
-struct FTeamScoreData
-{
-	GENERATED_BODY()
-
-	UPROPERTY()
-	uint8 TeamID = 0;
-
-	UPROPERTY()
-	int32 Score = 0;
-
-	FTeamScoreData() {}
-
-	FTeamScoreData(uint8 InTeamID, int32 InScore)
-		: TeamID(InTeamID), Score(InScore) {}
-};
-
 /**
  *  射击游戏 GameMode
  *  功能：
  *  - 管理游戏 UI（得分板、击杀提示等）
- *  - 跟踪团队得分和玩家统计数据（击杀/死亡/助攻）
+ *  - 跟踪团队得分和玩家统计数据（击杀/死亡/助攻），数据保存在 AShooterGameState 中复制到客户端
  *  - 处理游戏胜利条件和游戏时间限制
  *  - 网络同步得分和游戏状态
+ *  - 重来时原地重置回合（NPC、拾取物、玩家角色、定时器），不重新加载地图
+ *  - 订阅游戏事件总线显示击杀提示和死亡界面（名字在这里由 PlayerId 解析）
  */
 UCLASS(abstract)
 class FPSDEMO_API AShooterGameMode : public AGameModeBase
@@ -59,10 +44,6 @@ public:
 	UPROPERTY()
 	TMap<APlayerController*, TObjectPtr<UShooterUI>> PlayerUIMap;
 
-	/** 团队得分数组（每个团队一个得分数据） */
-	UPROPERTY(ReplicatedUsing=OnRep_TeamScores)
-	TArray<FTeamScoreData> TeamScores;
-
 	/** 获胜所需的目标得分（任一团队达到此分数即获胜） */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shooter", meta = (ClampMin = 1))
 	int32 TargetScore = 10;
@@ -74,51 +55,46 @@ public:
 	/** 胜利重启定时器句柄 */
 	FTimerHandle VictoryRestartTimer;
 
-	/** 游戏是否已结束 */
-	UPROPERTY(Replicated, BlueprintReadOnly)
-	bool bGameEnded = false;
-
-	/** 获胜团队 ID */
-	UPROPERTY(Replicated, BlueprintReadOnly)
-	uint8 WinningTeam = 255;
-
 	/** 游戏时间限制（秒，0 = 无时间限制） */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shooter", meta = (ClampMin = 0, Units = "s"))
 	float GameTimeLimit = 300.0f;
 
-	/** Remaining game time in seconds */
-	UPROPERTY(ReplicatedUsing=OnRep_RemainingTime, BlueprintReadOnly)
-	float RemainingTime = 0.0f;
-
-	/** Time when the game started */
-	float GameStartTime = 0.0f;
+	/** 比赛时间到期定时器（一次性，剩余时间由 GameState 的比赛时钟在各机器本地计算） */
+	FTimerHandle MatchEndTimer;
 
-	/** Timer handle for updating remaining time */
-	FTimerHandle TimeUpdateTimer;
+public:
 
-	/** Array of player statistics */
-	UPROPERTY(ReplicatedUsing=OnRep_PlayerStats)
-	TArray<FPlayerStats> PlayerStatsArray;
+	/** Constructor */
+	AShooterGameMode();
 
 protected:
 
 	/** Gameplay initialization */
 	virtual void BeginPlay() override;
 
-	/** Replication function for TeamScores */
-	UFUNCTION()
-	void OnRep_TeamScores();
+	/** 返回保存得分和统计的 GameState */
+	AShooterGameState* GetShooterGameState() const;
+
+	/** 返回比赛是否已结束（状态保存在 GameState 中复制到客户端） */
+	bool IsGameEnded() const;
+
+	/** 开始比赛时钟和比赛时间到期定时器 */
+	void StartMatchTimer();
 
-	/** Replication function for RemainingTime */
-	UFUNCTION()
-	void OnRep_RemainingTime();
+	/** 击杀事件：显示击杀提示 */
+	void HandleKillEvent(const FShooterGameplayEvent& Event);
 
-	/** Replication function for PlayerStatsMap */
-	UFUNCTION()
-	void OnRep_PlayerStats();
+	/** 死亡事件：向被击杀的本地玩家显示死亡界面 */
+	void HandleDeathEvent(const FShooterGameplayEvent& Event);
 
-	/** Updates the remaining game time */
-	void UpdateRemainingTime();
+	/** 重生事件：隐藏重生的本地玩家的死亡界面 */
+	void HandleRespawnEvent(const FShooterGameplayEvent& Event);
+
+	/** 返回 PlayerId 对应的玩家是否是本地玩家 */
+	bool IsLocalPlayerId(int32 PlayerId) const;
+
+	/** 比赛时间到期（MatchEndTimer 回调） */
+	void OnMatchTimeExpired();
 
 	/** Checks if time limit has been reached */
 	void CheckTimeLimit();
@@ -146,13 +122,19 @@ public:
 
 	/** Returns the remaining game time */
 	UFUNCTION(BlueprintPure, Category="Shooter")
-	float GetRemainingTime() const { return RemainingTime; }
+	float GetRemainingTime() const;
+
+	/** 服务器端：原地重置回合，不重新加载地图（得分、定时器、NPC、拾取物、玩家角色和 UI） */
+	void ResetRound();
 
 protected:
 
 	/** 为所有玩家显示游戏结束界面（内部函数） */
 	void ShowGameEndScreenForAllPlayers(uint8 WinningTeamID);
 
+	/** 发布比赛结束事件 */
+	void PublishMatchEnd(uint8 WinningTeamID);
+
 	/** 为指定玩家获取或创建 UI widget（内部函数） */
 	UShooterUI* GetOrCreateUIForPlayer(APlayerController* PC);
 
@@ -167,7 +149,7 @@ protected:
 	UFUNCTION(BlueprintCallable, Category="Shooter")
 	void DisableAllPlayerInput();
 
-	/** 重启游戏（手动调用，用于重来按钮） */
+	/** 重启游戏（手动调用，用于重来按钮）。默认原地重置回合，Shooter.Round.UseServerTravel 为 1 时重新加载地图 */
 	UFUNCTION(BlueprintCallable, Category="Shooter")
 	void RestartGame();
 
@@ -177,7 +159,4 @@ protected:
 
 	/** Restarts the game after victory (deprecated - replaced by RestartGame) */
 	void RestartGameAfterVictory();
-
-	/** Get the lifetime replicated props */
-	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 };
@@ -0,0 +1,422 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterGameState.h"
+#include "ShooterRoundSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+void FShooterTeamScoreItem::PostReplicatedAdd(const FShooterTeamScoreArray& InArraySerializer)
+{
+	PostReplicatedChange(InArraySerializer);
+}
+
+void FShooterTeamScoreItem::PostReplicatedChange(const FShooterTeamScoreArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnTeamScoreChanged.Broadcast(TeamID, Score);
+	}
+}
+
+const FShooterTeamScoreItem* FShooterTeamScoreArray::Find(uint8 TeamID) const
+{
+	RebuildIndex();
+
+	const int32* Index = IndexByTeam.Find(TeamID);
+	return Index ? &Items[*Index] : nullptr;
+}
+
+FShooterTeamScoreItem& FShooterTeamScoreArray::FindOrAdd(uint8 TeamID)
+{
+	RebuildIndex();
+
+	if (const int32* Index = IndexByTeam.Find(TeamID))
+	{
+		return Items[*Index];
+	}
+
+	const int32 NewIndex = Items.AddDefaulted();
+	Items[NewIndex].TeamID = TeamID;
+	IndexByTeam.Add(TeamID, NewIndex);
+
+	return Items[NewIndex];
+}
+
+void FShooterTeamScoreArray::Reset()
+{
+	Items.Reset();
+	IndexByTeam.Reset();
+	bIndexDirty = false;
+	MarkArrayDirty();
+}
+
+void FShooterTeamScoreArray::PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize)
+{
+	bIndexDirty = true;
+}
+
+void FShooterTeamScoreArray::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	if (bIndexDirty)
+	{
+		return;
+	}
+
+	for (int32 Index : AddedIndices)
+	{
+		IndexByTeam.Add(Items[Index].TeamID, Index);
+	}
+}
+
+void FShooterTeamScoreArray::RebuildIndex() const
+{
+	if (!bIndexDirty)
+	{
+		return;
+	}
+
+	IndexByTeam.Reset();
+	for (int32 Index = 0; Index < Items.Num(); ++Index)
+	{
+		IndexByTeam.Add(Items[Index].TeamID, Index);
+	}
+
+	bIndexDirty = false;
+}
+
+void FShooterPlayerStatsItem::PostReplicatedAdd(const FShooterPlayerStatsArray& InArraySerializer)
+{
+	PostReplicatedChange(InArraySerializer);
+}
+
+void FShooterPlayerStatsItem::PostReplicatedChange(const FShooterPlayerStatsArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnPlayerStatsChanged.Broadcast(Stats);
+	}
+}
+
+const FShooterPlayerStatsItem* FShooterPlayerStatsArray::Find(int32 PlayerId) const
+{
+	RebuildIndex();
+
+	const int32* Index = IndexByPlayerId.Find(PlayerId);
+	return Index ? &Items[*Index] : nullptr;
+}
+
+FShooterPlayerStatsItem& FShooterPlayerStatsArray::FindOrAdd(int32 PlayerId)
+{
+	RebuildIndex();
+
+	if (const int32* Index = IndexByPlayerId.Find(PlayerId))
+	{
+		return Items[*Index];
+	}
+
+	const int32 NewIndex = Items.AddDefaulted();
+	Items[NewIndex].Stats = FPlayerStats(PlayerId);
+	IndexByPlayerId.Add(PlayerId, NewIndex);
+
+	return Items[NewIndex];
+}
+
+void FShooterPlayerStatsArray::Reset()
+{
+	Items.Reset();
+	IndexByPlayerId.Reset();
+	bIndexDirty = false;
+	MarkArrayDirty();
+}
+
+void FShooterPlayerStatsArray::PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize)
+{
+	bIndexDirty = true;
+}
+
+void FShooterPlayerStatsArray::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	if (bIndexDirty)
+	{
+		return;
+	}
+
+	for (int32 Index : AddedIndices)
+	{
+		IndexByPlayerId.Add(Items[Index].Stats.PlayerId, Index);
+	}
+}
+
+void FShooterPlayerStatsArray::RebuildIndex() const
+{
+	if (!bIndexDirty)
+	{
+		return;
+	}
+
+	IndexByPlayerId.Reset();
+	for (int32 Index = 0; Index < Items.Num(); ++Index)
+	{
+		IndexByPlayerId.Add(Items[Index].Stats.PlayerId, Index);
+	}
+
+	bIndexDirty = false;
+}
+
+AShooterGameState::AShooterGameState()
+{
+	TeamScores.Owner = this;
+	PlayerStats.Owner = this;
+
+	// the match clock is the only thing that ticks, and only while it's running
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void AShooterGameState::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// the owner is not replicated, so make sure it survives duplication and loading
+	TeamScores.Owner = this;
+	PlayerStats.Owner = this;
+}
+
+void AShooterGameState::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// only broadcast when the displayed second changes
+	const int32 Seconds = FMath::CeilToInt(GetRemainingTime());
+	if (Seconds != LastBroadcastSeconds)
+	{
+		LastBroadcastSeconds = Seconds;
+		OnRemainingTimeChanged.Broadcast(GetRemainingTime());
+	}
+}
+
+void AShooterGameState::StartMatchClock(float TimeLimit)
+{
+	MatchEndTime = TimeLimit > 0.0f ? GetServerWorldTimeSeconds() + TimeLimit : 0.0;
+	FrozenRemainingTime = -1.0f;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, MatchEndTime, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, FrozenRemainingTime, this);
+
+	UpdateMatchClock();
+}
+
+void AShooterGameState::StopMatchClock(bool bExpired)
+{
+	if (!IsMatchClockRunning())
+	{
+		return;
+	}
+
+	FrozenRemainingTime = bExpired ? 0.0f : GetRemainingTime();
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, FrozenRemainingTime, this);
+
+	UpdateMatchClock();
+}
+
+float AShooterGameState::GetRemainingTime() const
+{
+	if (!HasTimeLimit())
+	{
+		return 0.0f;
+	}
+
+	if (FrozenRemainingTime >= 0.0f)
+	{
+		return FrozenRemainingTime;
+	}
+
+	// the server world time is kept in sync by the base GameState
+	return FMath::Max(0.0f, (float)(MatchEndTime - GetServerWorldTimeSeconds()));
+}
+
+void AShooterGameState::OnRep_MatchClock()
+{
+	UpdateMatchClock();
+}
+
+void AShooterGameState::UpdateMatchClock()
+{
+	SetActorTickEnabled(IsMatchClockRunning());
+
+	LastBroadcastSeconds = FMath::CeilToInt(GetRemainingTime());
+	OnRemainingTimeChanged.Broadcast(GetRemainingTime());
+}
+
+int32 AShooterGameState::AddTeamScore(uint8 TeamID)
+{
+	FShooterTeamScoreItem& Item = TeamScores.FindOrAdd(TeamID);
+	++Item.Score;
+	TeamScores.MarkItemDirty(Item);
+
+	// listen servers don't get replication callbacks
+	OnTeamScoreChanged.Broadcast(Item.TeamID, Item.Score);
+
+	return Item.Score;
+}
+
+void AShooterGameState::AddKill(int32 PlayerId)
+{
+	FShooterPlayerStatsItem& Item = PlayerStats.FindOrAdd(PlayerId);
+	++Item.Stats.Kills;
+	PlayerStats.MarkItemDirty(Item);
+
+	OnPlayerStatsChanged.Broadcast(Item.Stats);
+}
+
+void AShooterGameState::AddDeath(int32 PlayerId)
+{
+	FShooterPlayerStatsItem& Item = PlayerStats.FindOrAdd(PlayerId);
+	++Item.Stats.Deaths;
+	PlayerStats.MarkItemDirty(Item);
+
+	OnPlayerStatsChanged.Broadcast(Item.Stats);
+}
+
+void AShooterGameState::BeginNewRound()
+{
+	++RoundNumber;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, RoundNumber, this);
+
+	OnRoundStarted.Broadcast(RoundNumber);
+}
+
+void AShooterGameState::EndGame(uint8 InWinningTeam)
+{
+	if (bGameEnded)
+	{
+		return;
+	}
+
+	bGameEnded = true;
+	WinningTeam = InWinningTeam;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, bGameEnded, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, WinningTeam, this);
+
+	OnGameEnded.Broadcast(WinningTeam);
+}
+
+void AShooterGameState::ClearGameEnded()
+{
+	bGameEnded = false;
+	WinningTeam = 255;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, bGameEnded, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, WinningTeam, this);
+}
+
+void AShooterGameState::OnRep_GameEnded()
+{
+	// WinningTeam is applied in the same update, before rep notifies run
+	if (bGameEnded)
+	{
+		OnGameEnded.Broadcast(WinningTeam);
+	}
+}
+
+void AShooterGameState::OnRep_RoundNumber()
+{
+	// pickups don't replicate, so every client restores its own
+	if (UShooterRoundSubsystem* Round = GetWorld()->GetSubsystem<UShooterRoundSubsystem>())
+	{
+		Round->ResetLocalActors();
+	}
+
+	OnRoundStarted.Broadcast(RoundNumber);
+}
+
+void AShooterGameState::ResetScores()
+{
+	TeamScores.Reset();
+	PlayerStats.Reset();
+}
+
+int32 AShooterGameState::GetTeamScore(uint8 TeamID) const
+{
+	const FShooterTeamScoreItem* Item = TeamScores.Find(TeamID);
+	return Item ? Item->Score : 0;
+}
+
+FPlayerStats AShooterGameState::GetPlayerStatsById(int32 PlayerId) const
+{
+	const FShooterPlayerStatsItem* Item = PlayerStats.Find(PlayerId);
+	return Item ? Item->Stats : FPlayerStats();
+}
+
+FPlayerStats AShooterGameState::GetPlayerStats(APlayerController* PlayerController) const
+{
+	const int32 PlayerId = GetPlayerIdFor(PlayerController);
+	return PlayerId != INDEX_NONE ? GetPlayerStatsById(PlayerId) : FPlayerStats();
+}
+
+TArray<FPlayerStats> AShooterGameState::GetAllPlayerStats() const
+{
+	TArray<FPlayerStats> AllStats;
+	AllStats.Reserve(PlayerStats.Items.Num());
+
+	for (const FShooterPlayerStatsItem& Item : PlayerStats.Items)
+	{
+		AllStats.Add(Item.Stats);
+	}
+
+	return AllStats;
+}
+
+int32 AShooterGameState::GetPlayerIdFor(const APlayerController* PlayerController)
+{
+	const APlayerState* PlayerState = PlayerController ? PlayerController->PlayerState.Get() : nullptr;
+	return PlayerState ? PlayerState->GetPlayerId() : INDEX_NONE;
+}
+
+APlayerState* AShooterGameState::FindPlayerStateById(int32 PlayerId) const
+{
+	if (PlayerId == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	// the player list is short, a linear scan is cheaper than keeping a map in sync
+	for (APlayerState* PlayerState : PlayerArray)
+	{
+		if (PlayerState && PlayerState->GetPlayerId() == PlayerId)
+		{
+			return PlayerState;
+		}
+	}
+
+	return nullptr;
+}
+
+FString AShooterGameState::GetPlayerNameById(int32 PlayerId) const
+{
+	const APlayerState* PlayerState = FindPlayerStateById(PlayerId);
+	return PlayerState ? PlayerState->GetPlayerName() : FString(TEXT("Unknown"));
+}
+
+void AShooterGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// fast arrays track their own dirty items, so they don't use the push model
+	DOREPLIFETIME(AShooterGameState, TeamScores);
+	DOREPLIFETIME(AShooterGameState, PlayerStats);
+
+	// push model: the clock only replicates when it starts or stops
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterGameState, MatchEndTime, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterGameState, FrozenRemainingTime, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterGameState, RoundNumber, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterGameState, bGameEnded, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterGameState, WinningTeam, Params);
+}
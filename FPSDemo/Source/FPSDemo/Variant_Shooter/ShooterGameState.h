@@ -0,0 +1,355 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ShooterTypes.h"
+#include "ShooterGameState.generated.h"
+
+class AShooterGameState;
+class APlayerController;
+class APlayerState;
+struct FShooterTeamScoreArray;
+struct FShooterPlayerStatsArray;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FShooterTeamScoreChangedDelegate, uint8, TeamID, int32, Score);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FShooterPlayerStatsChangedDelegate, const FPlayerStats&, Stats);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FShooterRemainingTimeChangedDelegate, float, RemainingTime);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FShooterRoundStartedDelegate, int32, RoundNumber);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FShooterGameEndedDelegate, uint8, WinningTeam);
+
+/** 一个团队的得分（快速数组元素，只有变化的元素会被复制） */
+USTRUCT(BlueprintType)
+struct FShooterTeamScoreItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** 团队 ID */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	uint8 TeamID = 0;
+
+	/** 团队得分 */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	int32 Score = 0;
+
+	/** 客户端：新团队复制到达 */
+	void PostReplicatedAdd(const FShooterTeamScoreArray& InArraySerializer);
+
+	/** 客户端：团队得分变化 */
+	void PostReplicatedChange(const FShooterTeamScoreArray& InArraySerializer);
+};
+
+/** 团队得分快速数组，按团队 ID 建立索引 */
+USTRUCT()
+struct FShooterTeamScoreArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	/** 团队得分 */
+	UPROPERTY()
+	TArray<FShooterTeamScoreItem> Items;
+
+	/** 所属 GameState（用于广播变化） */
+	UPROPERTY(NotReplicated)
+	TObjectPtr<AShooterGameState> Owner;
+
+	/** 返回团队的元素，不存在时返回 nullptr */
+	const FShooterTeamScoreItem* Find(uint8 TeamID) const;
+
+	/** 服务器端：返回团队的元素，不存在时添加 */
+	FShooterTeamScoreItem& FindOrAdd(uint8 TeamID);
+
+	/** 清空所有团队 */
+	void Reset();
+
+	/** 客户端：元素即将被移除（移除会交换元素顺序，索引需要重建） */
+	void PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize);
+
+	/** 客户端：新元素加入 */
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+
+	/** Delta serializes only the items that changed */
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FShooterTeamScoreItem, FShooterTeamScoreArray>(Items, DeltaParms, *this);
+	}
+
+private:
+
+	/** 重建团队 ID 到数组下标的索引 */
+	void RebuildIndex() const;
+
+	/** 团队 ID 到数组下标（不复制，客户端收到增删后重建） */
+	mutable TMap<uint8, int32> IndexByTeam;
+
+	/** 索引需要重建 */
+	mutable bool bIndexDirty = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterTeamScoreArray> : public TStructOpsTypeTraitsBase2<FShooterTeamScoreArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+/** 一名玩家的统计数据（快速数组元素，只有变化的元素会被复制） */
+USTRUCT(BlueprintType)
+struct FShooterPlayerStatsItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** 统计数据（以 PlayerId 为键） */
+	UPROPERTY(BlueprintReadOnly, Category="Shooter")
+	FPlayerStats Stats;
+
+	/** 客户端：新玩家复制到达 */
+	void PostReplicatedAdd(const FShooterPlayerStatsArray& InArraySerializer);
+
+	/** 客户端：玩家统计变化 */
+	void PostReplicatedChange(const FShooterPlayerStatsArray& InArraySerializer);
+};
+
+/** 玩家统计快速数组，按 PlayerId 建立索引 */
+USTRUCT()
+struct FShooterPlayerStatsArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	/** 玩家统计 */
+	UPROPERTY()
+	TArray<FShooterPlayerStatsItem> Items;
+
+	/** 所属 GameState（用于广播变化） */
+	UPROPERTY(NotReplicated)
+	TObjectPtr<AShooterGameState> Owner;
+
+	/** 返回玩家的元素，不存在时返回 nullptr */
+	const FShooterPlayerStatsItem* Find(int32 PlayerId) const;
+
+	/** 服务器端：返回玩家的元素，不存在时添加 */
+	FShooterPlayerStatsItem& FindOrAdd(int32 PlayerId);
+
+	/** 清空所有玩家 */
+	void Reset();
+
+	/** 客户端：元素即将被移除（移除会交换元素顺序，索引需要重建） */
+	void PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize);
+
+	/** 客户端：新元素加入 */
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+
+	/** Delta serializes only the items that changed */
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FShooterPlayerStatsItem, FShooterPlayerStatsArray>(Items, DeltaParms, *this);
+	}
+
+private:
+
+	/** 重建 PlayerId 到数组下标的索引 */
+	void RebuildIndex() const;
+
+	/** PlayerId 到数组下标（不复制，客户端收到增删后重建） */
+	mutable TMap<int32, int32> IndexByPlayerId;
+
+	/** 索引需要重建 */
+	mutable bool bIndexDirty = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterPlayerStatsArray> : public TStructOpsTypeTraitsBase2<FShooterPlayerStatsArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+/**
+ *  射击游戏 GameState
+ *  功能：
+ *  - 保存团队得分和玩家统计（击杀/死亡/助攻），复制到所有客户端（GameMode 只存在于服务器）
+ *  - 使用快速数组逐元素增量复制：一次击杀只发送变化的团队和玩家，流量与变化量成正比，与数组大小无关
+ *  - 玩家统计以 PlayerState 的 PlayerId 为键，通过 PlayerId 到下标的索引 O(1) 查找
+ *  - 客户端收到变化时广播 OnTeamScoreChanged / OnPlayerStatsChanged，供记分板 UI 绑定
+ *  - 比赛时钟：服务器只在开始和停止时复制结束时间戳，各机器用同步后的服务器世界时间在本地计算剩余时间，
+ *    显示的整秒变化时广播 OnRemainingTimeChanged（每秒零网络流量）
+ *  - 回合编号：原地重置回合时加一，客户端收到后重置本地的非复制 Actor 并广播 OnRoundStarted
+ *  - 比赛结束状态和获胜团队：只在结束和重置时复制，客户端收到后广播 OnGameEnded
+ */
+UCLASS()
+class FPSDEMO_API AShooterGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** 团队得分 */
+	UPROPERTY(Replicated)
+	FShooterTeamScoreArray TeamScores;
+
+	/** 玩家统计 */
+	UPROPERTY(Replicated)
+	FShooterPlayerStatsArray PlayerStats;
+
+	/** 比赛结束的服务器世界时间（秒，0 = 无时间限制） */
+	UPROPERTY(ReplicatedUsing=OnRep_MatchClock)
+	double MatchEndTime = 0.0;
+
+	/** 时钟停止时冻结的剩余时间（秒，负数 = 时钟运行中） */
+	UPROPERTY(ReplicatedUsing=OnRep_MatchClock)
+	float FrozenRemainingTime = -1.0f;
+
+	/** 上次广播的剩余整秒数（本地，不复制） */
+	int32 LastBroadcastSeconds = INDEX_NONE;
+
+	/** 当前回合编号（每次原地重置加一） */
+	UPROPERTY(ReplicatedUsing=OnRep_RoundNumber)
+	int32 RoundNumber = 0;
+
+	/** 比赛是否已结束 */
+	UPROPERTY(ReplicatedUsing=OnRep_GameEnded)
+	bool bGameEnded = false;
+
+	/** 获胜团队 ID（255 = 没有获胜团队），与 bGameEnded 同时标记为脏，在同一次更新中到达 */
+	UPROPERTY(Replicated)
+	uint8 WinningTeam = 255;
+
+public:
+
+	/** 团队得分变化（服务器和客户端都会广播） */
+	UPROPERTY(BlueprintAssignable, Category="Shooter")
+	FShooterTeamScoreChangedDelegate OnTeamScoreChanged;
+
+	/** 玩家统计变化（服务器和客户端都会广播） */
+	UPROPERTY(BlueprintAssignable, Category="Shooter")
+	FShooterPlayerStatsChangedDelegate OnPlayerStatsChanged;
+
+	/** 显示的剩余整秒数变化（由本地时钟驱动，不产生网络流量；UShooterUI 自动绑定） */
+	UPROPERTY(BlueprintAssignable, Category="Shooter")
+	FShooterRemainingTimeChangedDelegate OnRemainingTimeChanged;
+
+	/** 原地重置后新回合开始（服务器和客户端都会广播，UI 可以在这里隐藏结算界面） */
+	UPROPERTY(BlueprintAssignable, Category="Shooter")
+	FShooterRoundStartedDelegate OnRoundStarted;
+
+	/** 比赛结束（服务器和客户端都会广播，没有获胜团队时为 255） */
+	UPROPERTY(BlueprintAssignable, Category="Shooter")
+	FShooterGameEndedDelegate OnGameEnded;
+
+public:
+
+	/** Constructor */
+	AShooterGameState();
+
+	/** 服务器端：团队得分加一，返回新得分 */
+	int32 AddTeamScore(uint8 TeamID);
+
+	/** 服务器端：玩家击杀数加一 */
+	void AddKill(int32 PlayerId);
+
+	/** 服务器端：玩家死亡数加一 */
+	void AddDeath(int32 PlayerId);
+
+	/** 服务器端：清空得分和统计 */
+	void ResetScores();
+
+	/** 服务器端：从现在开始计时（TimeLimit 为 0 时无时间限制） */
+	void StartMatchClock(float TimeLimit);
+
+	/** 服务器端：停止计时并冻结剩余时间（bExpired 时冻结为 0） */
+	void StopMatchClock(bool bExpired = false);
+
+	/** 服务器端：开始新回合（回合编号加一并通知客户端） */
+	void BeginNewRound();
+
+	/** 返回当前回合编号 */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	int32 GetRoundNumber() const { return RoundNumber; }
+
+	/** 服务器端：结束比赛并记录获胜团队（255 = 没有获胜团队） */
+	void EndGame(uint8 InWinningTeam);
+
+	/** 服务器端：清除比赛结束状态（重新开始比赛时） */
+	void ClearGameEnded();
+
+	/** 返回比赛是否已结束 */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	bool IsGameEnded() const { return bGameEnded; }
+
+	/** 返回获胜团队 ID（比赛未结束或没有获胜团队时为 255） */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	uint8 GetWinningTeam() const { return WinningTeam; }
+
+	/** 返回比赛剩余时间（秒，由同步后的服务器世界时间在本地计算，每帧平滑变化） */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	float GetRemainingTime() const;
+
+	/** 返回比赛是否有时间限制 */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	bool HasTimeLimit() const { return MatchEndTime > 0.0; }
+
+	/** 返回比赛时钟是否在运行 */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	bool IsMatchClockRunning() const { return HasTimeLimit() && FrozenRemainingTime < 0.0f; }
+
+	/** 返回团队得分（没有得分时为 0） */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	int32 GetTeamScore(uint8 TeamID) const;
+
+	/** 返回所有团队的得分 */
+	const TArray<FShooterTeamScoreItem>& GetTeamScores() const { return TeamScores.Items; }
+
+	/** 返回玩家的统计数据（没有记录时 PlayerId 为 INDEX_NONE） */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	FPlayerStats GetPlayerStatsById(int32 PlayerId) const;
+
+	/** 返回控制器对应玩家的统计数据 */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	FPlayerStats GetPlayerStats(APlayerController* PlayerController) const;
+
+	/** 返回所有玩家的统计数据（结算界面使用） */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	TArray<FPlayerStats> GetAllPlayerStats() const;
+
+	/** 返回控制器对应的 PlayerId，没有 PlayerState 时返回 INDEX_NONE */
+	static int32 GetPlayerIdFor(const APlayerController* PlayerController);
+
+	/** 在复制的玩家列表中查找 PlayerId 对应的 PlayerState，找不到时返回 nullptr */
+	APlayerState* FindPlayerStateById(int32 PlayerId) const;
+
+	/** 返回 PlayerId 对应的显示名字（NPC 和已离开的玩家返回 Unknown） */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	FString GetPlayerNameById(int32 PlayerId) const;
+
+protected:
+
+	/** Sets up the fast array owners */
+	virtual void PostInitializeComponents() override;
+
+	/** Advances the local match clock display */
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** 比赛时钟复制回调：开始或停止本地时钟 */
+	UFUNCTION()
+	void OnRep_MatchClock();
+
+	/** 只在时钟运行时 Tick，并立即广播一次当前剩余时间 */
+	void UpdateMatchClock();
+
+	/** 回合编号复制回调：重置本地的非复制 Actor */
+	UFUNCTION()
+	void OnRep_RoundNumber();
+
+	/** 比赛结束复制回调：比赛结束时广播 OnGameEnded */
+	UFUNCTION()
+	void OnRep_GameEnded();
+
+	/** Get the lifetime replicated props */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+};
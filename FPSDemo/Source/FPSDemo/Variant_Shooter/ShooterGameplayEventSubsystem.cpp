@@ -0,0 +1,135 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterCombatantSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay Event Dispatch"), STAT_ShooterGameplayEventDispatch, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gameplay Events Published"), STAT_ShooterGameplayEventsPublished, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gameplay Events Dropped"), STAT_ShooterGameplayEventsDropped, STATGROUP_Shooter);
+
+namespace ShooterGameplayEvents
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "The event ring buffer capacity must be a power of two");
+
+	static bool bLogEvents = false;
+	static FAutoConsoleVariableRef CVarLogEvents(
+		TEXT("Shooter.Events.Log"),
+		bLogEvents,
+		TEXT("If true, logs every gameplay event when it's dispatched."));
+}
+
+bool UShooterGameplayEventSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterGameplayEventSubsystem::Publish(EShooterGameplayEventType Type, int32 InstigatorId, uint8 InstigatorTeam, int32 TargetId, uint8 TargetTeam, float Value,
+	const FVector& TargetLocation, const FVector& InstigatorLocation)
+{
+	// the ring is full: hand the pending events out now instead of overwriting them
+	if (NextSequence - NextDispatchSequence >= ShooterGameplayEvents::Capacity)
+	{
+		if (!bDispatching)
+		{
+			Dispatch();
+		}
+		else
+		{
+			// subscribers flooding the bus from inside a dispatch lose the oldest events
+			++NextDispatchSequence;
+			INC_DWORD_STAT(STAT_ShooterGameplayEventsDropped);
+		}
+	}
+
+	FShooterGameplayEvent& Event = Events[NextSequence & (ShooterGameplayEvents::Capacity - 1)];
+	Event.Type = Type;
+	Event.InstigatorTeam = InstigatorTeam;
+	Event.TargetTeam = TargetTeam;
+	Event.InstigatorId = InstigatorId;
+	Event.TargetId = TargetId;
+	Event.Value = Value;
+	Event.TargetLocation = TargetLocation;
+	Event.InstigatorLocation = InstigatorLocation;
+	Event.Time = GetWorld()->GetTimeSeconds();
+	Event.Sequence = NextSequence++;
+
+	INC_DWORD_STAT(STAT_ShooterGameplayEventsPublished);
+}
+
+void UShooterGameplayEventSubsystem::PublishCombat(EShooterGameplayEventType Type, const AController* Instigator, const APawn* Target, float Value)
+{
+	uint8 InstigatorTeam = 255;
+	uint8 TargetTeam = 255;
+
+	if (const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		InstigatorTeam = Combatants->GetTeamForController(Instigator);
+
+		const int32 TargetIndex = Combatants->FindByPawn(Target);
+		if (TargetIndex != INDEX_NONE)
+		{
+			TargetTeam = Combatants->GetTeam(TargetIndex);
+		}
+	}
+
+	// the instigator may have no pawn left (dead, or damage from a world hazard), so fall back to where the target is
+	const FVector TargetLocation = Target ? Target->GetActorLocation() : FVector::ZeroVector;
+	const APawn* InstigatorPawn = Instigator ? Instigator->GetPawn() : nullptr;
+	const FVector InstigatorLocation = InstigatorPawn ? InstigatorPawn->GetActorLocation() : TargetLocation;
+
+	Publish(Type, GetPlayerId(Instigator), InstigatorTeam, GetPlayerId(Target ? Target->GetController() : nullptr), TargetTeam, Value, TargetLocation, InstigatorLocation);
+}
+
+void UShooterGameplayEventSubsystem::Dispatch()
+{
+	if (bDispatching || NextDispatchSequence == NextSequence)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterGameplayEventDispatch);
+
+	TGuardValue<bool> DispatchGuard(bDispatching, true);
+
+	// events published by subscribers are picked up by this same loop
+	while (NextDispatchSequence != NextSequence)
+	{
+		// copy the event so a subscriber publishing into a full ring can't overwrite it mid broadcast
+		const FShooterGameplayEvent Event = Events[NextDispatchSequence & (ShooterGameplayEvents::Capacity - 1)];
+		++NextDispatchSequence;
+
+		if (ShooterGameplayEvents::bLogEvents)
+		{
+			UE_LOG(LogFPSDemo, Display, TEXT("Event %u %s: instigator %d (team %d) target %d (team %d) value %.1f"),
+				Event.Sequence, *UEnum::GetValueAsString(Event.Type), Event.InstigatorId, Event.InstigatorTeam, Event.TargetId, Event.TargetTeam, Event.Value);
+		}
+
+		EventDelegates[(int32)Event.Type].Broadcast(Event);
+	}
+}
+
+void UShooterGameplayEventSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Dispatch();
+}
+
+TStatId UShooterGameplayEventSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterGameplayEventSubsystem, STATGROUP_Tickables);
+}
+
+int32 UShooterGameplayEventSubsystem::GetPlayerId(const AController* Controller)
+{
+	const APlayerState* PlayerState = Controller ? Controller->PlayerState.Get() : nullptr;
+	return PlayerState ? PlayerState->GetPlayerId() : INDEX_NONE;
+}
@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterGameplayEventSubsystem.generated.h"
+
+class AController;
+class APawn;
+
+namespace ShooterGameplayEvents
+{
+	/** 环形缓冲区容量（2 的幂） */
+	constexpr uint32 Capacity = 256;
+}
+
+/** 游戏事件类型 */
+UENUM(BlueprintType)
+enum class EShooterGameplayEventType : uint8
+{
+	/** 击杀：Instigator 击杀了 Target */
+	Kill,
+
+	/** 死亡：Target 死亡，Instigator 是击杀者，Value 是重生等待时间 */
+	Death,
+
+	/** 伤害：Target 本帧受到 Instigator 的合并伤害，Value 是伤害值 */
+	Damage,
+
+	/** 得分：InstigatorTeam 的得分变为 Value */
+	Score,
+
+	/** 重生：Target 重生 */
+	Respawn,
+
+	/** 比赛结束：InstigatorTeam 获胜（255 = 平局或无获胜团队） */
+	MatchEnd,
+
+	Num UMETA(Hidden)
+};
+
+/**
+ *  一个游戏事件
+ *  只保存 id 和数值，不保存字符串或对象指针，写入环形缓冲区时不分配内存
+ *  玩家以 PlayerState 的 PlayerId 标识（NPC 和未知来源为 INDEX_NONE），名字由消费者在需要显示时解析
+ */
+struct FShooterGameplayEvent
+{
+	/** 事件类型 */
+	EShooterGameplayEventType Type = EShooterGameplayEventType::Kill;
+
+	/** 发起者的团队（255 = 未知） */
+	uint8 InstigatorTeam = 255;
+
+	/** 目标的团队（255 = 未知） */
+	uint8 TargetTeam = 255;
+
+	/** 发起者的 PlayerId */
+	int32 InstigatorId = INDEX_NONE;
+
+	/** 目标的 PlayerId */
+	int32 TargetId = INDEX_NONE;
+
+	/** 事件数值（伤害、得分、重生时间等，含义见事件类型） */
+	float Value = 0.0f;
+
+	/** 目标 Pawn 的位置（战斗事件，其他事件为零） */
+	FVector TargetLocation = FVector::ZeroVector;
+
+	/** 发起者 Pawn 的位置（战斗事件，发起者没有 Pawn 时取目标位置） */
+	FVector InstigatorLocation = FVector::ZeroVector;
+
+	/** 发布时的世界时间（秒） */
+	float Time = 0.0f;
+
+	/** 发布序号（单调递增） */
+	uint32 Sequence = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FShooterGameplayEventDelegate, const FShooterGameplayEvent&);
+
+/**
+ *  游戏事件总线子系统
+ *  功能：
+ *  - 战斗代码发布类型化事件（击杀、死亡、伤害、得分、重生、比赛结束），只写入预分配的环形缓冲区，热路径上不构造字符串也不分配内存
+ *  - 每帧统一按发布顺序分发给按类型订阅的消费者（UI、统计、遥测），缓冲区写满时立即分发；只有订阅者在分发过程中继续发布并再次写满缓冲区时，才丢弃最旧的未分发事件（计入 Events Dropped 统计）
+ *  - 战斗代码不再直接访问 UI，名字格式化只在显示事件的消费者中进行
+ *  - Shooter.Events.Log 1 输出每个分发的事件
+ */
+UCLASS()
+class FPSDEMO_API UShooterGameplayEventSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 发布一个事件 */
+	void Publish(EShooterGameplayEventType Type, int32 InstigatorId, uint8 InstigatorTeam, int32 TargetId, uint8 TargetTeam, float Value = 0.0f,
+		const FVector& TargetLocation = FVector::ZeroVector, const FVector& InstigatorLocation = FVector::ZeroVector);
+
+	/** 发布一个战斗事件，PlayerId、团队和位置从控制器、Pawn 和战斗者注册表读取 */
+	void PublishCombat(EShooterGameplayEventType Type, const AController* Instigator, const APawn* Target, float Value = 0.0f);
+
+	/** 返回某类事件的订阅委托 */
+	FShooterGameplayEventDelegate& OnEvent(EShooterGameplayEventType Type) { return EventDelegates[(int32)Type]; }
+
+	/** 立即分发所有未分发的事件 */
+	void Dispatch();
+
+	/** 返回控制器的 PlayerId，没有 PlayerState 时返回 INDEX_NONE */
+	static int32 GetPlayerId(const AController* Controller);
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Dispatches the events published this frame */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 预分配的事件环形缓冲区 */
+	FShooterGameplayEvent Events[ShooterGameplayEvents::Capacity];
+
+	/** 各类事件的订阅者 */
+	FShooterGameplayEventDelegate EventDelegates[(int32)EShooterGameplayEventType::Num];
+
+	/** 下一个事件的序号 */
+	uint32 NextSequence = 0;
+
+	/** 下一个要分发的事件序号 */
+	uint32 NextDispatchSequence = 0;
+
+	/** 正在分发（分发期间发布的事件在同一次分发中处理） */
+	bool bDispatching = false;
+};
@@ -0,0 +1,114 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterGameplayTrace.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "FPSDemo.h"
+
+UE_TRACE_CHANNEL_DEFINE(ShooterGameplayChannel)
+UE_TRACE_EVENT_DEFINE(ShooterGameplay, Fact)
+
+/** Baseline for Shooter.Log.BenchmarkKill. Written at Warning like the LogTemp lines it stands in for */
+DEFINE_LOG_CATEGORY_STATIC(LogShooterKillBaseline, Log, All);
+
+namespace ShooterGameplayLog
+{
+	void LogKill(const TCHAR* Context, const APawn* Victim, const AController* Killer, uint8 VictimTeam, uint8 KillerTeam, bool bScored)
+	{
+		// the ids match the gameplay events and telemetry, -1 for NPCs
+		SHOOTER_TRACE_FACT5(Kill,
+			UShooterGameplayEventSubsystem::GetPlayerId(Victim ? Victim->GetController() : nullptr),
+			UShooterGameplayEventSubsystem::GetPlayerId(Killer),
+			VictimTeam, KillerTeam, bScored);
+
+		// the names are only looked up when the verbose line is actually written
+		UE_LOG(LogShooterGameplay, Verbose, TEXT("[%s] %s (%d) killed by %s (%d) - VictimTeam: %d, KillerTeam: %d, Scored: %d"),
+			Context,
+			*GetNameSafe(Victim), UShooterGameplayEventSubsystem::GetPlayerId(Victim ? Victim->GetController() : nullptr),
+			*GetNameSafe(Killer), UShooterGameplayEventSubsystem::GetPlayerId(Killer),
+			VictimTeam, KillerTeam, bScored);
+	}
+
+	/** The kill logging Die did before LogKill: about eight Warning lines per kill, names looked up every time */
+	static void LogKillMultiLine(const TCHAR* Context, const APawn* Victim, const AController* Killer, uint8 VictimTeam, uint8 KillerTeam)
+	{
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] Character died - Team: %d"), Context, VictimTeam);
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] GameMode found, processing kill/death"), Context);
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] LastDamageInstigator: %s"), Context, *GetNameSafe(Killer));
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] ===== KILL SCORE LOGIC ====="), Context);
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] Victim TeamByte: %d, Killer TeamByte: %d"), Context, VictimTeam, KillerTeam);
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] KillerTeamByte != 255: %d"), Context, (KillerTeam != 255));
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] KillerTeamByte != TeamByte: %d"), Context, (KillerTeam != VictimTeam));
+
+		if (KillerTeam != 255 && KillerTeam != VictimTeam)
+		{
+			UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] Incrementing score for team %d (killer) vs team %d (victim) - %s"), Context, KillerTeam, VictimTeam, *GetNameSafe(Victim));
+		}
+		else
+		{
+			UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] Not incrementing score - KillerTeam: %d, VictimTeam: %d"), Context, KillerTeam, VictimTeam);
+		}
+
+		UE_LOG(LogShooterKillBaseline, Warning, TEXT("[%s] ============================="), Context);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkKillCommand(
+		TEXT("Shooter.Log.BenchmarkKill"),
+		TEXT("Times the old multi-line kill logging against LogKill with the current log verbosity and trace channel state. Usage: Shooter.Log.BenchmarkKill [Count=10000]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (!World)
+			{
+				return;
+			}
+
+			const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+
+			// log a real pawn so the verbose path pays for its name lookups
+			const APawn* Victim = nullptr;
+			for (TActorIterator<APawn> It(World); It; ++It)
+			{
+				Victim = *It;
+				break;
+			}
+
+			const AController* Killer = Victim ? Victim->GetController() : nullptr;
+
+			// before: every line formatted and written, like the LogTemp warnings Die used to emit
+			double StartTime = FPlatformTime::Seconds();
+
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				LogKillMultiLine(TEXT("Benchmark"), Victim, Killer, 0, 1);
+			}
+
+			const double MultiLineTime = FPlatformTime::Seconds() - StartTime;
+
+			// after: whatever the current verbosity and trace settings cost
+			StartTime = FPlatformTime::Seconds();
+
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				LogKill(TEXT("Benchmark"), Victim, Killer, 0, 1, true);
+			}
+
+			const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+#if UE_TRACE_ENABLED
+			const bool bTraceEnabled = UE_TRACE_CHANNELEXPR_IS_ENABLED(ShooterGameplayChannel);
+#else
+			const bool bTraceEnabled = false;
+#endif
+
+			UE_LOG(LogFPSDemo, Display, TEXT("Kill logging, %d kills: old multi-line %.2f ms (%.1f ns per kill), LogKill %.2f ms (%.1f ns per kill, verbose log: %d, trace: %d)"),
+				Count,
+				MultiLineTime * 1000.0, MultiLineTime * 1.0e9 / Count,
+				ElapsedTime * 1000.0, ElapsedTime * 1.0e9 / Count,
+				UE_LOG_ACTIVE(LogShooterGameplay, Verbose) ? 1 : 0, bTraceEnabled ? 1 : 0);
+		}));
+}
@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Trace/Trace.h"
+
+class APawn;
+class AController;
+
+/** 结构化追踪记录的事实类型（A 到 E 的含义见各类型，未使用的字段为 0） */
+enum class EShooterTraceFact : uint8
+{
+	/** 击杀结算：A = 被击杀者 PlayerId，B = 击杀者 PlayerId（NPC 为 -1），C = 被击杀者团队，D = 击杀者团队，E = 是否为击杀者团队得分 */
+	Kill,
+
+	/** 得分变化：A = 团队，B = 新得分 */
+	Score,
+
+	/** 胜利：A = 获胜团队，B = 目标得分 */
+	Victory,
+
+	/** 结算界面：A = 玩家团队，B = 获胜团队，C = 是否胜利 */
+	GameEndScreen
+};
+
+/** 结构化游戏追踪通道（-trace=ShooterGameplay 或 Trace.Enable ShooterGameplay 开启） */
+UE_TRACE_CHANNEL_EXTERN(ShooterGameplayChannel, FPSDEMO_API);
+
+UE_TRACE_EVENT_BEGIN_EXTERN(ShooterGameplay, Fact)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint8, Type)
+	UE_TRACE_EVENT_FIELD(int32, A)
+	UE_TRACE_EVENT_FIELD(int32, B)
+	UE_TRACE_EVENT_FIELD(int32, C)
+	UE_TRACE_EVENT_FIELD(int32, D)
+	UE_TRACE_EVENT_FIELD(int32, E)
+UE_TRACE_EVENT_END()
+
+/**
+ *  写入一条二进制事实记录，不格式化字符串
+ *  通道关闭时只有一次分支判断，参数不会被求值；UE_TRACE_ENABLED 为 0 的构建中整条语句被移除
+ */
+#define SHOOTER_TRACE_FACT5(FactType, InA, InB, InC, InD, InE) \
+	UE_TRACE_LOG(ShooterGameplay, Fact, ShooterGameplayChannel) \
+		<< Fact.Cycle(FPlatformTime::Cycles64()) \
+		<< Fact.Type(uint8(EShooterTraceFact::FactType)) \
+		<< Fact.A(int32(InA)) \
+		<< Fact.B(int32(InB)) \
+		<< Fact.C(int32(InC)) \
+		<< Fact.D(int32(InD)) \
+		<< Fact.E(int32(InE))
+
+/** 只用到 A、B、C 的事实 */
+#define SHOOTER_TRACE_FACT(FactType, InA, InB, InC) SHOOTER_TRACE_FACT5(FactType, InA, InB, InC, 0, 0)
+
+/**
+ *  射击游戏的结构化日志
+ *  功能：
+ *  - 击杀、得分、胜利等事实同时写入 LogShooterGameplay（Verbose，Shipping/Test 构建中编译移除）和 ShooterGameplay 追踪通道
+ *  - 默认不输出也不格式化；Log LogShooterGameplay Verbose 开启文本日志，Trace.Enable ShooterGameplay 开启二进制记录
+ *  - Shooter.Log.BenchmarkKill [Count] 对比旧的多行 Warning 日志（重构前 Die 中约 8 行）和当前设置下每次击杀的日志开销
+ */
+namespace ShooterGameplayLog
+{
+	/** 记录一次击杀结算（角色和 NPC 的 Die 共用，Victim 此时仍被占有） */
+	FPSDEMO_API void LogKill(const TCHAR* Context, const APawn* Victim, const AController* Killer, uint8 VictimTeam, uint8 KillerTeam, bool bScored);
+}
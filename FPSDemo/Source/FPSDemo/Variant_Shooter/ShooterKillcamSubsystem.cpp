@@ -0,0 +1,697 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterKillcamSubsystem.h"
+#include "ShooterCombatantSubsystem.h"
+#include "ShooterPlayerController.h"
+#include "Camera/CameraActor.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Killcam Record"), STAT_ShooterKillcamRecord, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Killcam Playback"), STAT_ShooterKillcamPlayback, STATGROUP_Shooter);
+DECLARE_MEMORY_STAT(TEXT("Killcam Buffer"), STAT_ShooterKillcamBuffer, STATGROUP_Shooter);
+
+namespace ShooterKillcam
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Shooter.Killcam.Enable"),
+		bEnabled,
+		TEXT("Records the local combatants into a fixed size ring buffer and replays the killer's view on death. Read when the world begins play."));
+
+	static float Duration = 4.0f;
+	static FAutoConsoleVariableRef CVarDuration(
+		TEXT("Shooter.Killcam.Duration"),
+		Duration,
+		TEXT("Seconds kept in the killcam buffer (clamped to 1-10). Read when the world begins play."));
+
+	static float SampleRate = 15.0f;
+	static FAutoConsoleVariableRef CVarSampleRate(
+		TEXT("Shooter.Killcam.SampleRate"),
+		SampleRate,
+		TEXT("Killcam samples per second (clamped to 5-30). Read when the world begins play."));
+
+	static int32 MaxActors = 24;
+	static FAutoConsoleVariableRef CVarMaxActors(
+		TEXT("Shooter.Killcam.MaxActors"),
+		MaxActors,
+		TEXT("Maximum number of combatants recorded at once (clamped to 1-64). Read when the world begins play."));
+
+	static float BlendTime = 0.25f;
+	static FAutoConsoleVariableRef CVarBlendTime(
+		TEXT("Shooter.Killcam.BlendTime"),
+		BlendTime,
+		TEXT("Seconds the view blends into the killcam."));
+
+	/** Hard caps on the buffer dimensions, whatever the cvars say */
+	static constexpr float MaxDurationLimit = 10.0f;
+	static constexpr float MaxSampleRateLimit = 30.0f;
+	static constexpr int32 MaxActorsLimit = 64;
+
+	/** Position quantization step in cm */
+	static constexpr float PositionStep = 2.0f;
+
+	/** Shooters remembered as threats to the local player */
+	static constexpr int32 MaxThreats = 8;
+
+	/** A shot counts as aimed at the local player within about 14 degrees */
+	static constexpr float ThreatAimCosine = 0.97f;
+
+	/** Recorded pawns rank as if this much closer (squared), so pawns at the boundary don't swap slots every frame */
+	static constexpr float KeepSlotBias = 0.8f;
+
+	static_assert(MaxActorsLimit <= 64, "UpdateSlots tracks the wanted slots in a 64 bit mask");
+}
+
+void UShooterKillcamSubsystem::ReportShot(const APawn* Shooter)
+{
+	if (!bRecording || bPlaying)
+	{
+		return;
+	}
+
+	NoteThreat(Shooter);
+
+	if (const int32* SlotIndex = SlotIndices.Find(Shooter))
+	{
+		Slots[*SlotIndex].PendingFlags |= ShooterKillcamFlags::Fired;
+	}
+}
+
+bool UShooterKillcamSubsystem::StartPlayback(AShooterPlayerController* InViewer, const APawn* Killer, float MaxDuration, TSubclassOf<AActor> InGhostClass)
+{
+	if (!bRecording || bPlaying || !InViewer || !Killer || NumFrames < 2)
+	{
+		return false;
+	}
+
+	const int32* SlotIndex = SlotIndices.Find(Killer);
+	if (!SlotIndex)
+	{
+		return false;
+	}
+
+	// never run past the respawn, the playback ends early if the viewer respawns anyway
+	const float NewestTime = FrameTimes[GetFrameIndex(NumFrames - 1)];
+	const float OldestTime = FrameTimes[GetFrameIndex(0)];
+	const float PlaybackDuration = FMath::Min(NewestTime - OldestTime, MaxDuration);
+
+	if (PlaybackDuration <= 0.0f)
+	{
+		return false;
+	}
+
+	UWorld* World = GetWorld();
+
+	bPlaying = true;
+	Viewer = InViewer;
+	ViewerPawn = InViewer->GetPawn();
+	bViewerSeenDead = false;
+	KillerSlot = *SlotIndex;
+	KillerEyeHeight = Killer->BaseEyeHeight;
+	PlaybackEndTime = NewestTime;
+	PlaybackTime = NewestTime - PlaybackDuration;
+
+	PlaybackFrame = 0;
+	while (PlaybackFrame < NumFrames - 2 && FrameTimes[GetFrameIndex(PlaybackFrame + 1)] <= PlaybackTime)
+	{
+		++PlaybackFrame;
+	}
+
+	// the camera and the ghosts are local only and reused between playbacks
+	if (!KillcamCamera)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		KillcamCamera = World->SpawnActor<ACameraActor>(ACameraActor::StaticClass(), FTransform::Identity, SpawnParams);
+		KillcamCamera->SetReplicates(false);
+	}
+
+	if (InGhostClass != GhostClass)
+	{
+		for (AActor* Ghost : GhostPool)
+		{
+			if (Ghost)
+			{
+				Ghost->Destroy();
+			}
+		}
+
+		GhostPool.Reset();
+		GhostClass = InGhostClass;
+	}
+
+	int32 NumGhosts = 0;
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		SlotGhosts[Slot] = INDEX_NONE;
+
+		if (!GhostClass || Slot == KillerSlot || !Slots[Slot].bInUse)
+		{
+			continue;
+		}
+
+		if (NumGhosts == GhostPool.Num())
+		{
+			AActor* Ghost = World->SpawnActorDeferred<AActor>(GhostClass, FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+			if (!Ghost)
+			{
+				break;
+			}
+
+			Ghost->SetReplicates(false);
+			Ghost->SetActorEnableCollision(false);
+			Ghost->SetActorHiddenInGame(true);
+			Ghost->FinishSpawning(FTransform::Identity);
+			GhostPool.Add(Ghost);
+		}
+
+		SlotGhosts[Slot] = NumGhosts++;
+	}
+
+	InViewer->SetViewTargetWithBlend(KillcamCamera, ShooterKillcam::BlendTime);
+
+	// place the camera and the ghosts before the first rendered frame
+	TickPlayback(0.0f);
+
+	if (bPlaying)
+	{
+		InViewer->OnKillcamStarted(PlaybackDuration);
+	}
+
+	UE_LOG(LogFPSDemo, Verbose, TEXT("Killcam: playing %.2f s of %s (%d frames buffered, %d ghosts)"),
+		PlaybackDuration, *GetNameSafe(Killer), NumFrames, NumGhosts);
+
+	return bPlaying;
+}
+
+void UShooterKillcamSubsystem::StopPlayback()
+{
+	if (!bPlaying)
+	{
+		return;
+	}
+
+	bPlaying = false;
+
+	for (AActor* Ghost : GhostPool)
+	{
+		if (Ghost)
+		{
+			Ghost->SetActorHiddenInGame(true);
+		}
+	}
+
+	for (int32& GhostIndex : SlotGhosts)
+	{
+		GhostIndex = INDEX_NONE;
+	}
+
+	if (AShooterPlayerController* PC = Viewer.Get())
+	{
+		APawn* Pawn = PC->GetPawn();
+		PC->SetViewTarget(Pawn ? static_cast<AActor*>(Pawn) : static_cast<AActor*>(PC));
+		PC->OnKillcamEnded();
+	}
+
+	Viewer.Reset();
+	ViewerPawn.Reset();
+	KillerSlot = INDEX_NONE;
+
+	// the recording was paused during the playback. Start over with an empty ring, so the next killcam
+	// never interpolates across the pause
+	OldestFrame = 0;
+	NumFrames = 0;
+	SampleTimer = 0.0f;
+}
+
+SIZE_T UShooterKillcamSubsystem::GetBufferSize() const
+{
+	return Samples.GetAllocatedSize() + FrameTimes.GetAllocatedSize() + Slots.GetAllocatedSize()
+		+ SlotIndices.GetAllocatedSize() + FreeSlots.GetAllocatedSize() + SlotGhosts.GetAllocatedSize()
+		+ Threats.GetAllocatedSize();
+}
+
+bool UShooterKillcamSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterKillcamSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// a dedicated server has no one to show the killcam to
+	if (!ShooterKillcam::bEnabled || InWorld.GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	const float BufferDuration = FMath::Clamp(ShooterKillcam::Duration, 1.0f, ShooterKillcam::MaxDurationLimit);
+	const float BufferSampleRate = FMath::Clamp(ShooterKillcam::SampleRate, 5.0f, ShooterKillcam::MaxSampleRateLimit);
+
+	// the whole buffer is allocated once, recording never allocates
+	SampleInterval = 1.0f / BufferSampleRate;
+	MaxFrames = FMath::CeilToInt(BufferDuration * BufferSampleRate) + 1;
+	MaxSlots = FMath::Clamp(ShooterKillcam::MaxActors, 1, ShooterKillcam::MaxActorsLimit);
+
+	Samples.SetNumZeroed(MaxFrames * MaxSlots);
+	FrameTimes.SetNumZeroed(MaxFrames);
+	Slots.SetNum(MaxSlots);
+	SlotGhosts.Init(INDEX_NONE, MaxSlots);
+	SlotIndices.Reserve(MaxSlots);
+	Threats.SetNum(ShooterKillcam::MaxThreats);
+
+	FreeSlots.Reserve(MaxSlots);
+	for (int32 Slot = MaxSlots - 1; Slot >= 0; --Slot)
+	{
+		FreeSlots.Add(Slot);
+	}
+
+	OldestFrame = 0;
+	NumFrames = 0;
+	SampleTimer = 0.0f;
+	bRecording = true;
+
+	INC_MEMORY_STAT_BY(STAT_ShooterKillcamBuffer, GetBufferSize());
+
+	UE_LOG(LogFPSDemo, Log, TEXT("Killcam: %d frames x %d actors, %llu bytes"), MaxFrames, MaxSlots, (uint64)GetBufferSize());
+}
+
+void UShooterKillcamSubsystem::Deinitialize()
+{
+	StopPlayback();
+
+	if (bRecording)
+	{
+		DEC_MEMORY_STAT_BY(STAT_ShooterKillcamBuffer, GetBufferSize());
+		bRecording = false;
+	}
+
+	Samples.Empty();
+	FrameTimes.Empty();
+	Slots.Empty();
+	SlotIndices.Empty();
+	FreeSlots.Empty();
+	SlotGhosts.Empty();
+	Threats.Empty();
+	Candidates.Empty();
+	GhostPool.Empty();
+	KillcamCamera = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UShooterKillcamSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bPlaying)
+	{
+		TickPlayback(DeltaTime);
+		return;
+	}
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	SampleTimer -= DeltaTime;
+	if (SampleTimer <= 0.0f)
+	{
+		// don't try to catch up after a hitch
+		SampleTimer = FMath::Max(SampleTimer + SampleInterval, 0.0f);
+
+		RecordFrame();
+	}
+}
+
+TStatId UShooterKillcamSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterKillcamSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterKillcamSubsystem::RecordFrame()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterKillcamRecord);
+
+	UpdateSlots();
+
+	// overwrite the oldest frame once the ring is full
+	int32 Frame;
+	if (NumFrames < MaxFrames)
+	{
+		Frame = GetFrameIndex(NumFrames++);
+	}
+	else
+	{
+		Frame = OldestFrame;
+		OldestFrame = (OldestFrame + 1) % MaxFrames;
+	}
+
+	FrameTimes[Frame] = GetWorld()->GetTimeSeconds();
+
+	FShooterKillcamSample* FrameSamples = &Samples[Frame * MaxSlots];
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		FShooterKillcamSlot& SlotData = Slots[Slot];
+		FShooterKillcamSample& Sample = FrameSamples[Slot];
+
+		const APawn* Pawn = SlotData.bInUse ? SlotData.Pawn.Get() : nullptr;
+		if (!Pawn)
+		{
+			Sample.Flags = 0;
+			continue;
+		}
+
+		QuantizeSample(Pawn, Sample);
+		Sample.Generation = SlotData.Generation;
+		Sample.Flags = ShooterKillcamFlags::Valid | SlotData.PendingFlags;
+		SlotData.PendingFlags = 0;
+	}
+}
+
+void UShooterKillcamSubsystem::UpdateSlots()
+{
+	// release the slots of destroyed pawns
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (Slots[Slot].bInUse && !Slots[Slot].Pawn.IsValid())
+		{
+			ReleaseSlot(Slot);
+		}
+	}
+
+	const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>();
+	if (!Combatants)
+	{
+		return;
+	}
+
+	// rank from where the local player is looking, which still works while they are dead
+	APlayerController* LocalPC = GetWorld()->GetFirstPlayerController();
+	const APawn* LocalPawn = LocalPC ? LocalPC->GetPawn() : nullptr;
+
+	FVector ViewLocation = FVector::ZeroVector;
+	FRotator ViewRotation;
+	if (LocalPC)
+	{
+		LocalPC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	// the registry only holds the combatants this machine knows about, i.e. the network relevant ones on a client.
+	// The local player and whoever shot at them come first, so the killer is recorded however crowded it gets
+	Candidates.Reset();
+
+	for (int32 Index = 0; Index < Combatants->Num(); ++Index)
+	{
+		APawn* Pawn = Combatants->GetPawn(Index);
+		if (!Pawn)
+		{
+			continue;
+		}
+
+		float Priority = FVector::DistSquared(Pawn->GetActorLocation(), ViewLocation);
+
+		if (SlotIndices.Contains(Pawn))
+		{
+			Priority *= ShooterKillcam::KeepSlotBias;
+		}
+
+		if (Pawn == LocalPawn || IsRecentThreat(Pawn, Now))
+		{
+			Priority = -1.0f;
+		}
+
+		Candidates.Add({ Pawn, Priority });
+	}
+
+	if (Candidates.Num() > MaxSlots)
+	{
+		Candidates.Sort([](const FShooterKillcamCandidate& A, const FShooterKillcamCandidate& B) { return A.Priority < B.Priority; });
+		Candidates.SetNum(MaxSlots, EAllowShrinking::No);
+	}
+
+	// free the slots of pawns that dropped out of the best, before handing out slots to the new ones
+	uint64 WantedSlots = 0;
+	for (const FShooterKillcamCandidate& Candidate : Candidates)
+	{
+		if (const int32* Slot = SlotIndices.Find(Candidate.Pawn))
+		{
+			WantedSlots |= uint64(1) << *Slot;
+		}
+	}
+
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (Slots[Slot].bInUse && !(WantedSlots & (uint64(1) << Slot)))
+		{
+			ReleaseSlot(Slot);
+		}
+	}
+
+	for (const FShooterKillcamCandidate& Candidate : Candidates)
+	{
+		APawn* Pawn = Candidate.Pawn;
+		if (SlotIndices.Contains(Pawn) || FreeSlots.Num() == 0)
+		{
+			continue;
+		}
+
+		const int32 Slot = FreeSlots.Pop(EAllowShrinking::No);
+
+		// bump the generation so the previous occupant's samples are ignored
+		FShooterKillcamSlot& SlotData = Slots[Slot];
+		SlotData.Pawn = Pawn;
+		SlotData.Key = Pawn;
+		SlotData.Generation++;
+		SlotData.PendingFlags = 0;
+		SlotData.bInUse = true;
+
+		SlotIndices.Add(Pawn, Slot);
+	}
+}
+
+void UShooterKillcamSubsystem::ReleaseSlot(int32 Slot)
+{
+	FShooterKillcamSlot& SlotData = Slots[Slot];
+	SlotIndices.Remove(SlotData.Key);
+	SlotData.Pawn.Reset();
+	SlotData.bInUse = false;
+	FreeSlots.Add(Slot);
+}
+
+void UShooterKillcamSubsystem::NoteThreat(const APawn* Shooter)
+{
+	const APlayerController* LocalPC = GetWorld()->GetFirstPlayerController();
+	const APawn* LocalPawn = LocalPC ? LocalPC->GetPawn() : nullptr;
+	if (!Shooter || !LocalPawn || Shooter == LocalPawn || Threats.Num() == 0)
+	{
+		return;
+	}
+
+	// clients never learn who damaged them, so a shot aimed at the local player stands in for it
+	const FVector ToLocalPawn = (LocalPawn->GetActorLocation() - Shooter->GetPawnViewLocation()).GetSafeNormal();
+	if ((ToLocalPawn | Shooter->GetBaseAimRotation().Vector()) < ShooterKillcam::ThreatAimCosine)
+	{
+		return;
+	}
+
+	// refresh the shooter's entry, or replace the oldest one
+	int32 Entry = 0;
+	for (int32 Index = 0; Index < Threats.Num(); ++Index)
+	{
+		if (Threats[Index].Pawn == Shooter)
+		{
+			Entry = Index;
+			break;
+		}
+
+		if (Threats[Index].Time < Threats[Entry].Time)
+		{
+			Entry = Index;
+		}
+	}
+
+	Threats[Entry].Pawn = Shooter;
+	Threats[Entry].Time = GetWorld()->GetTimeSeconds();
+}
+
+bool UShooterKillcamSubsystem::IsRecentThreat(const APawn* Pawn, float Now) const
+{
+	// anything older than the buffer can't be in a killcam anyway
+	const float Window = MaxFrames * SampleInterval;
+
+	for (const FShooterKillcamThreat& Threat : Threats)
+	{
+		if (Threat.Pawn == Pawn && Threat.Time >= 0.0f && Now - Threat.Time <= Window)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UShooterKillcamSubsystem::TickPlayback(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterKillcamPlayback);
+
+	AShooterPlayerController* PC = Viewer.Get();
+	if (!PC || PlaybackTime >= PlaybackEndTime)
+	{
+		StopPlayback();
+		return;
+	}
+
+	// the respawn never waits for the killcam: a new pawn, or the old one alive again, ends the playback
+	if (APawn* CurrentPawn = PC->GetPawn())
+	{
+		if (CurrentPawn != ViewerPawn.Get())
+		{
+			StopPlayback();
+			return;
+		}
+
+		if (const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+		{
+			// the death may replicate after the killcam request, so only a pawn seen dead can come back
+			const int32 Index = Combatants->FindByPawn(CurrentPawn);
+			const bool bAlive = Index != INDEX_NONE && Combatants->IsAlive(Index);
+
+			if (!bAlive)
+			{
+				bViewerSeenDead = true;
+			}
+			else if (bViewerSeenDead)
+			{
+				StopPlayback();
+				return;
+			}
+		}
+	}
+	else if (ViewerPawn.IsValid())
+	{
+		ViewerPawn.Reset();
+	}
+
+	PlaybackTime = FMath::Min(PlaybackTime + DeltaTime, PlaybackEndTime);
+
+	// advance through the frames we passed and replay their shots
+	while (PlaybackFrame < NumFrames - 2 && FrameTimes[GetFrameIndex(PlaybackFrame + 1)] <= PlaybackTime)
+	{
+		++PlaybackFrame;
+
+		for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+		{
+			const FShooterKillcamSample& Sample = GetSample(PlaybackFrame, Slot);
+			if (IsSampleValid(Sample, Slot) && (Sample.Flags & ShooterKillcamFlags::Fired))
+			{
+				FVector Location;
+				FRotator Rotation;
+				DequantizeSample(Sample, Location, Rotation);
+
+				PC->OnKillcamShot(Location, Rotation, Slot == KillerSlot);
+			}
+		}
+	}
+
+	const float FrameStartTime = FrameTimes[GetFrameIndex(PlaybackFrame)];
+	const float FrameEndTime = FrameTimes[GetFrameIndex(PlaybackFrame + 1)];
+	const float Alpha = FrameEndTime > FrameStartTime ? FMath::Clamp((PlaybackTime - FrameStartTime) / (FrameEndTime - FrameStartTime), 0.0f, 1.0f) : 1.0f;
+
+	FVector Location;
+	FRotator Rotation;
+
+	if (KillcamCamera && InterpolateSlot(KillerSlot, Alpha, Location, Rotation))
+	{
+		KillcamCamera->SetActorLocationAndRotation(Location + FVector(0.0f, 0.0f, KillerEyeHeight), Rotation);
+	}
+
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (SlotGhosts[Slot] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		AActor* Ghost = GhostPool[SlotGhosts[Slot]];
+		if (!Ghost)
+		{
+			continue;
+		}
+
+		if (InterpolateSlot(Slot, Alpha, Location, Rotation))
+		{
+			Ghost->SetActorLocationAndRotation(Location, FRotator(0.0f, Rotation.Yaw, 0.0f));
+			Ghost->SetActorHiddenInGame(false);
+		}
+		else
+		{
+			Ghost->SetActorHiddenInGame(true);
+		}
+	}
+}
+
+bool UShooterKillcamSubsystem::IsSampleValid(const FShooterKillcamSample& Sample, int32 Slot) const
+{
+	return (Sample.Flags & ShooterKillcamFlags::Valid) && Sample.Generation == Slots[Slot].Generation;
+}
+
+bool UShooterKillcamSubsystem::InterpolateSlot(int32 Slot, float Alpha, FVector& OutLocation, FRotator& OutRotation) const
+{
+	const FShooterKillcamSample& From = GetSample(PlaybackFrame, Slot);
+	const FShooterKillcamSample& To = GetSample(PlaybackFrame + 1, Slot);
+
+	const bool bFromValid = IsSampleValid(From, Slot);
+	const bool bToValid = IsSampleValid(To, Slot);
+
+	if (bFromValid && bToValid)
+	{
+		FVector ToLocation;
+		FRotator ToRotation;
+		DequantizeSample(From, OutLocation, OutRotation);
+		DequantizeSample(To, ToLocation, ToRotation);
+
+		OutLocation = FMath::Lerp(OutLocation, ToLocation, Alpha);
+		OutRotation = FMath::Lerp(OutRotation, ToRotation, Alpha);
+		return true;
+	}
+
+	// the actor appeared or disappeared between the two frames
+	if (bFromValid || bToValid)
+	{
+		DequantizeSample(bFromValid ? From : To, OutLocation, OutRotation);
+		return true;
+	}
+
+	return false;
+}
+
+void UShooterKillcamSubsystem::QuantizeSample(const APawn* Pawn, FShooterKillcamSample& OutSample)
+{
+	const FVector Location = Pawn->GetActorLocation() / ShooterKillcam::PositionStep;
+	OutSample.X = (int16)FMath::Clamp(FMath::RoundToInt(Location.X), -MAX_int16, MAX_int16);
+	OutSample.Y = (int16)FMath::Clamp(FMath::RoundToInt(Location.Y), -MAX_int16, MAX_int16);
+	OutSample.Z = (int16)FMath::Clamp(FMath::RoundToInt(Location.Z), -MAX_int16, MAX_int16);
+
+	const FRotator AimRotation = Pawn->GetBaseAimRotation();
+	OutSample.Yaw = FRotator::CompressAxisToShort(AimRotation.Yaw);
+	OutSample.Pitch = FRotator::CompressAxisToShort(AimRotation.Pitch);
+}
+
+void UShooterKillcamSubsystem::DequantizeSample(const FShooterKillcamSample& Sample, FVector& OutLocation, FRotator& OutRotation)
+{
+	OutLocation = FVector(Sample.X, Sample.Y, Sample.Z) * ShooterKillcam::PositionStep;
+	OutRotation = FRotator(FRotator::DecompressAxisFromShort(Sample.Pitch), FRotator::DecompressAxisFromShort(Sample.Yaw), 0.0f);
+}
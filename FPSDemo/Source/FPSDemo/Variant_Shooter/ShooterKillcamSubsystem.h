@@ -0,0 +1,232 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "ShooterKillcamSubsystem.generated.h"
+
+class APawn;
+class ACameraActor;
+class AShooterPlayerController;
+
+/** 样本标志位 */
+namespace ShooterKillcamFlags
+{
+	/** 样本有效 */
+	constexpr uint8 Valid = 1 << 0;
+
+	/** 上一个样本之后开过火 */
+	constexpr uint8 Fired = 1 << 1;
+}
+
+/**
+ *  一个 Actor 在一帧中的量化状态（12 字节）
+ *  位置精度 2 cm（范围 ±655 m），朝向量化为 16 位
+ */
+struct FShooterKillcamSample
+{
+	/** 位置（2 cm 为单位） */
+	int16 X = 0;
+	int16 Y = 0;
+	int16 Z = 0;
+
+	/** 瞄准方向 */
+	uint16 Yaw = 0;
+	uint16 Pitch = 0;
+
+	/** 写入时槽位的代数，与槽位当前代数不同时样本属于之前的占用者 */
+	uint8 Generation = 0;
+
+	/** ShooterKillcamFlags 位掩码 */
+	uint8 Flags = 0;
+};
+
+/** 录制槽位：一个被录制的 Pawn */
+struct FShooterKillcamSlot
+{
+	/** 占用槽位的 Pawn */
+	TWeakObjectPtr<APawn> Pawn;
+
+	/** Pawn 在映射中的键（Pawn 销毁后仍可用于移除） */
+	TObjectKey<APawn> Key;
+
+	/** 槽位代数，每次分配给新的 Pawn 时递增 */
+	uint8 Generation = 0;
+
+	/** 下一个样本要写入的标志（开火） */
+	uint8 PendingFlags = 0;
+
+	/** 槽位是否被占用 */
+	bool bInUse = false;
+};
+
+/** 最近向本地玩家开火的战斗者 */
+struct FShooterKillcamThreat
+{
+	/** 开火的 Pawn */
+	TWeakObjectPtr<const APawn> Pawn;
+
+	/** 最近一次开火的世界时间 */
+	float Time = -1.0f;
+};
+
+/** 分配槽位时的候选战斗者 */
+struct FShooterKillcamCandidate
+{
+	/** 战斗者 */
+	APawn* Pawn = nullptr;
+
+	/** 优先级（越小越优先），威胁为负数，其余为到本地视角的距离平方 */
+	float Priority = 0.0f;
+};
+
+/**
+ *  击杀回放子系统（拥有本地玩家的世界）
+ *  功能：
+ *  - 以 Shooter.Killcam.SampleRate 的频率把本机可见（网络相关）的战斗者的量化位置、瞄准方向和开火事件写入固定大小的环形缓冲区，不需要录制整场比赛
+ *  - 缓冲区在世界开始时按 Shooter.Killcam.Duration、SampleRate、MaxActors 一次分配（均有硬上限），之后录制不分配内存，
+ *    每次采样的开销只与录制的 Actor 数量有关，Pawn 到槽位的查找为 O(1)
+ *  - 战斗者多于槽位时，本地玩家和最近向本地玩家开火的战斗者始终优先，其余按到本地视角的距离分配，已录制的战斗者略微优先以免来回替换
+ *  - 回放结束后清空缓冲区，暂停期间的空档不会被插值
+ *  - 玩家死亡时服务器通过 ClientPlayKillcam 通知被击杀者，本地从击杀者的视角回放死亡前的几秒，其他战斗者用可选的幽灵 Actor 表示
+ *  - 回放不阻塞重生流程：持续时间不超过重生等待时间，玩家重生后立即结束并恢复视角
+ */
+UCLASS()
+class FPSDEMO_API UShooterKillcamSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 记录一次开火（写入该 Pawn 的下一个样本） */
+	void ReportShot(const APawn* Shooter);
+
+	/** 从击杀者的视角开始回放，没有击杀者的录制数据时返回 false */
+	bool StartPlayback(AShooterPlayerController* InViewer, const APawn* Killer, float MaxDuration, TSubclassOf<AActor> InGhostClass);
+
+	/** 结束回放并恢复视角 */
+	void StopPlayback();
+
+	/** 返回是否正在回放 */
+	bool IsPlaying() const { return bPlaying; }
+
+	/** 返回缓冲区占用的内存（字节） */
+	SIZE_T GetBufferSize() const;
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Allocates the ring buffer when this world has local players */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Releases the ring buffer */
+	virtual void Deinitialize() override;
+
+	/** Records a sample or advances the playback */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 录制一帧 */
+	void RecordFrame();
+
+	/** 释放失效 Pawn 的槽位，把槽位分配给优先级最高的战斗者 */
+	void UpdateSlots();
+
+	/** 释放一个槽位 */
+	void ReleaseSlot(int32 Slot);
+
+	/** 开火方向指向本地玩家时，把开火者记为威胁 */
+	void NoteThreat(const APawn* Shooter);
+
+	/** 返回 Pawn 是否在缓冲区时长内向本地玩家开过火 */
+	bool IsRecentThreat(const APawn* Pawn, float Now) const;
+
+	/** 推进回放 */
+	void TickPlayback(float DeltaTime);
+
+	/** 返回逻辑帧（0 = 最旧）在缓冲区中的位置 */
+	int32 GetFrameIndex(int32 LogicalFrame) const { return (OldestFrame + LogicalFrame) % MaxFrames; }
+
+	/** 返回一个样本 */
+	const FShooterKillcamSample& GetSample(int32 LogicalFrame, int32 Slot) const { return Samples[GetFrameIndex(LogicalFrame) * MaxSlots + Slot]; }
+
+	/** 返回样本是否属于槽位当前的占用者 */
+	bool IsSampleValid(const FShooterKillcamSample& Sample, int32 Slot) const;
+
+	/** 在两个样本之间插值，返回是否有效 */
+	bool InterpolateSlot(int32 Slot, float Alpha, FVector& OutLocation, FRotator& OutRotation) const;
+
+	/** 量化一个 Pawn 的状态 */
+	static void QuantizeSample(const APawn* Pawn, FShooterKillcamSample& OutSample);
+
+	/** 还原样本的位置和朝向 */
+	static void DequantizeSample(const FShooterKillcamSample& Sample, FVector& OutLocation, FRotator& OutRotation);
+
+	/** 环形缓冲区：MaxFrames 帧，每帧 MaxSlots 个样本 */
+	TArray<FShooterKillcamSample> Samples;
+
+	/** 每帧的世界时间 */
+	TArray<float> FrameTimes;
+
+	/** 录制槽位 */
+	TArray<FShooterKillcamSlot> Slots;
+
+	/** Pawn 到槽位的映射（预留 MaxSlots 个元素） */
+	TMap<TObjectKey<APawn>, int32> SlotIndices;
+
+	/** 空闲槽位 */
+	TArray<int32> FreeSlots;
+
+	/** 最近的威胁（固定大小，覆盖最旧的） */
+	TArray<FShooterKillcamThreat> Threats;
+
+	/** 分配槽位用的候选列表（跨帧复用内存） */
+	TArray<FShooterKillcamCandidate> Candidates;
+
+	/** 缓冲区容量 */
+	int32 MaxFrames = 0;
+	int32 MaxSlots = 0;
+
+	/** 最旧一帧的位置和已录制的帧数 */
+	int32 OldestFrame = 0;
+	int32 NumFrames = 0;
+
+	/** 采样间隔和距离下一次采样的时间 */
+	float SampleInterval = 0.0f;
+	float SampleTimer = 0.0f;
+
+	/** 是否在录制（专用服务器上不录制） */
+	bool bRecording = false;
+
+	/** 回放状态 */
+	bool bPlaying = false;
+	TWeakObjectPtr<AShooterPlayerController> Viewer;
+	TWeakObjectPtr<APawn> ViewerPawn;
+	bool bViewerSeenDead = false;
+	int32 KillerSlot = INDEX_NONE;
+	float KillerEyeHeight = 0.0f;
+	float PlaybackTime = 0.0f;
+	float PlaybackEndTime = 0.0f;
+	int32 PlaybackFrame = 0;
+
+	/** 回放用的摄像机（复用） */
+	UPROPERTY()
+	TObjectPtr<ACameraActor> KillcamCamera;
+
+	/** 幽灵 Actor 池（复用，回放结束后隐藏） */
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> GhostPool;
+
+	/** 幽灵 Actor 的类 */
+	UPROPERTY()
+	TSubclassOf<AActor> GhostClass;
+
+	/** 槽位到幽灵 Actor 池下标的映射 */
+	TArray<int32> SlotGhosts;
+};
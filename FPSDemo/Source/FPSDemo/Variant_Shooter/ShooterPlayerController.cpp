@@ -8,9 +8,68 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "ShooterCharacter.h"
+#include "ShooterSpawnPointSubsystem.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "ShooterGameState.h"
+#include "ShooterKillcamSubsystem.h"
+#include "ShooterLatencyTrace.h"
 #include "ShooterBulletCounterUI.h"
 #include "FPSDemo.h"
 #include "Widgets/Input/SVirtualJoystick.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Respawn (Recycle)"), STAT_ShooterRespawnRecycle, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Respawn (Spawn)"), STAT_ShooterRespawnSpawn, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Recycled Respawns"), STAT_ShooterRecycledRespawns, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawned Respawns"), STAT_ShooterSpawnedRespawns, STATGROUP_Shooter);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Accepted Server RPCs"), STAT_ShooterAcceptedRPCs, STATGROUP_ShooterNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dropped Server RPCs"), STAT_ShooterDroppedRPCs, STATGROUP_ShooterNet);
+
+static FAutoConsoleCommandWithWorld ShooterDumpRPCLimitsCommand(
+	TEXT("Shooter.DumpRPCLimits"),
+	TEXT("Logs the accepted and dropped server RPC counters for every player connection."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		static const TCHAR* RPCNames[] = { TEXT("StartFiring"), TEXT("StopFiring"), TEXT("Reload"), TEXT("ReportClientAim") };
+
+		for (TActorIterator<AShooterPlayerController> It(World); It; ++It)
+		{
+			for (int32 i = 0; i < (int32)EShooterServerRPC::Num; ++i)
+			{
+				const FShooterRPCTokenBucket& Bucket = It->GetServerRPCBucket((EShooterServerRPC)i);
+				UE_LOG(LogFPSDemo, Log, TEXT("%s %s: accepted %u, dropped %u"), *GetNameSafe(*It), RPCNames[i], Bucket.AcceptedCount, Bucket.DroppedCount);
+			}
+		}
+	}));
+
+bool FShooterRPCTokenBucket::TryConsume(double Now, float RefillRate, float BurstSize)
+{
+	// refill based on the time since the last call. A fresh bucket starts full
+	if (LastRefillTime <= 0.0)
+	{
+		Tokens = BurstSize;
+	}
+	else
+	{
+		Tokens = FMath::Min(BurstSize, Tokens + static_cast<float>(Now - LastRefillTime) * RefillRate);
+	}
+
+	LastRefillTime = Now;
+
+	if (Tokens >= 1.0f)
+	{
+		Tokens -= 1.0f;
+		++AcceptedCount;
+		return true;
+	}
+
+	++DroppedCount;
+	return false;
+}
 
 void AShooterPlayerController::BeginPlay()
 {
@@ -48,6 +107,18 @@ void AShooterPlayerController::BeginPlay()
 			UE_LOG(LogFPSDemo, Error, TEXT("Could not spawn bullet counter widget."));
 
 		}
+
+		// remote clients get the kill feed through ClientReceiveCombatNotifications and their own deaths and
+		// respawns through ClientReceivePersonalCombatNotifications, the host's UI is driven by the game mode
+		if (GetNetMode() == NM_Client)
+		{
+			if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+			{
+				Events->OnEvent(EShooterGameplayEventType::Kill).AddUObject(this, &AShooterPlayerController::HandleKillEvent);
+				Events->OnEvent(EShooterGameplayEventType::Death).AddUObject(this, &AShooterPlayerController::HandleDeathEvent);
+				Events->OnEvent(EShooterGameplayEventType::Respawn).AddUObject(this, &AShooterPlayerController::HandleRespawnEvent);
+			}
+		}
 		
 	}
 }
@@ -107,26 +178,117 @@ void AShooterPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 		BulletCounterUI->BP_UpdateBulletCounter(0, 0);
 	}
 
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRespawnSpawn);
+
+	// respawn on the same team as the destroyed pawn
+	const AShooterCharacter* DestroyedCharacter = Cast<AShooterCharacter>(DestroyedActor);
+	const uint8 TeamByte = DestroyedCharacter ? DestroyedCharacter->GetTeamByte() : 0;
+
 	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
+	FTransform SpawnTransform;
 
-	if (ActorList.Num() > 0)
+	if (FindRespawnTransform(TeamByte, SpawnTransform))
 	{
-		// select a random player start
-		AActor* RandomPlayerStart = ActorList[FMath::RandRange(0, ActorList.Num() - 1)];
-
 		// spawn a character at the player start
-		const FTransform SpawnTransform = RandomPlayerStart->GetActorTransform();
-
 		if (AShooterCharacter* RespawnedCharacter = GetWorld()->SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform))
 		{
+			INC_DWORD_STAT(STAT_ShooterSpawnedRespawns);
+
 			// possess the character
 			Possess(RespawnedCharacter);
+
+			if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+			{
+				Events->PublishCombat(EShooterGameplayEventType::Respawn, nullptr, RespawnedCharacter);
+			}
 		}
 	}
 }
 
+bool AShooterPlayerController::FindRespawnTransform(uint8 TeamByte, FTransform& OutTransform)
+{
+	// the spawn point subsystem keeps the player starts scored against nearby threats
+	UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>();
+	return SpawnPoints && SpawnPoints->ChooseSpawnTransform(TeamByte, OutTransform);
+}
+
+bool AShooterPlayerController::RecyclePawn(AShooterCharacter* DeadCharacter)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRespawnRecycle);
+
+	// only recycle the pawn we're currently possessing
+	if (!DeadCharacter || DeadCharacter != GetPawn())
+	{
+		return false;
+	}
+
+	FTransform SpawnTransform;
+	if (!FindRespawnTransform(DeadCharacter->GetTeamByte(), SpawnTransform) || !DeadCharacter->RecycleForRespawn(SpawnTransform))
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterRecycledRespawns);
+
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		Events->PublishCombat(EShooterGameplayEventType::Respawn, nullptr, DeadCharacter);
+	}
+
+	// reset the bullet counter HUD
+	if (BulletCounterUI)
+	{
+		BulletCounterUI->BP_UpdateBulletCounter(0, 0);
+	}
+
+	return true;
+}
+
+EShooterRPCRateResult AShooterPlayerController::ConsumeServerRPCToken(EShooterServerRPC RPC)
+{
+	const double Now = GetWorld()->GetRealTimeSeconds();
+
+	// pick the rate for this RPC
+	float RefillRate = FiringRPCRate;
+	float BurstSize = FiringRPCBurst;
+
+	if (RPC == EShooterServerRPC::Reload)
+	{
+		RefillRate = ReloadRPCRate;
+		BurstSize = ReloadRPCBurst;
+
+	} else if (RPC == EShooterServerRPC::ReportClientAim)
+	{
+		RefillRate = ClientAimRPCRate;
+		BurstSize = ClientAimRPCBurst;
+	}
+
+	if (ServerRPCBuckets[(int32)RPC].TryConsume(Now, RefillRate, BurstSize))
+	{
+		INC_DWORD_STAT(STAT_ShooterAcceptedRPCs);
+		return EShooterRPCRateResult::Accepted;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterDroppedRPCs);
+
+	// track drops over a one second window to detect sustained flooding
+	if (Now - DroppedRPCWindowStart > 1.0)
+	{
+		DroppedRPCWindowStart = Now;
+		DroppedRPCsInWindow = 0;
+	}
+
+	++DroppedRPCsInWindow;
+
+	if (MaxDroppedRPCsPerSecond > 0 && DroppedRPCsInWindow > MaxDroppedRPCsPerSecond)
+	{
+		UE_LOG(LogFPSDemo, Warning, TEXT("%s exceeded %d dropped server RPCs per second, disconnecting."), *GetNameSafe(this), MaxDroppedRPCsPerSecond);
+		return EShooterRPCRateResult::Kick;
+	}
+
+	return EShooterRPCRateResult::Dropped;
+}
+
 void AShooterPlayerController::OnBulletCountUpdated(int32 MagazineSize, int32 Bullets)
 {
 	// update the UI
@@ -143,3 +305,119 @@ void AShooterPlayerController::OnPawnDamaged(float LifePercent)
 		BulletCounterUI->BP_Damaged(LifePercent);
 	}
 }
+
+void AShooterPlayerController::ClientConfirmHits_Implementation(const FShooterHitConfirmBatch& Batch)
+{
+	// traced shots end here
+	if (UShooterLatencyTraceSubsystem::IsEnabled())
+	{
+		if (UShooterLatencyTraceSubsystem* LatencyTrace = GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>())
+		{
+			for (const FShooterHitConfirm& Hit : Batch.Hits)
+			{
+				LatencyTrace->RecordStage(Hit.LatencyTraceId, EShooterLatencyStage::ConfirmReceived);
+			}
+		}
+	}
+
+	if (IsValid(BulletCounterUI))
+	{
+		BulletCounterUI->BP_HitsConfirmed(Batch.Hits);
+	}
+}
+
+void AShooterPlayerController::ClientReceiveCombatNotifications_Implementation(const FShooterCombatNotificationBatch& Batch)
+{
+	PublishCombatNotifications(Batch);
+}
+
+void AShooterPlayerController::ClientReceivePersonalCombatNotifications_Implementation(const FShooterCombatNotificationBatch& Batch)
+{
+	PublishCombatNotifications(Batch);
+}
+
+void AShooterPlayerController::PublishCombatNotifications(const FShooterCombatNotificationBatch& Batch)
+{
+	// consumers on the client handle the notifications the same way the server handles its own events
+	if (UShooterGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<UShooterGameplayEventSubsystem>())
+	{
+		for (const FShooterCombatNotification& Notification : Batch.Notifications)
+		{
+			Events->Publish(Notification.Type, Notification.InstigatorId, Notification.InstigatorTeam, Notification.TargetId, Notification.TargetTeam, Notification.Value);
+		}
+	}
+}
+
+void AShooterPlayerController::HandleKillEvent(const FShooterGameplayEvent& Event)
+{
+	// the kill feed only lists players
+	if (!IsValid(BulletCounterUI) || Event.TargetId == INDEX_NONE)
+	{
+		return;
+	}
+
+	// ids resolve against the replicated player list
+	if (const AShooterGameState* ShooterGameState = GetWorld()->GetGameState<AShooterGameState>())
+	{
+		BulletCounterUI->BP_ShowKillFeed(ShooterGameState->GetPlayerNameById(Event.InstigatorId), ShooterGameState->GetPlayerNameById(Event.TargetId));
+	}
+}
+
+void AShooterPlayerController::HandleDeathEvent(const FShooterGameplayEvent& Event)
+{
+	if (!IsValid(BulletCounterUI) || Event.TargetId == INDEX_NONE || Event.TargetId != UShooterGameplayEventSubsystem::GetPlayerId(this))
+	{
+		return;
+	}
+
+	if (const AShooterGameState* ShooterGameState = GetWorld()->GetGameState<AShooterGameState>())
+	{
+		BulletCounterUI->BP_ShowDeathScreen(ShooterGameState->GetPlayerNameById(Event.InstigatorId), Event.Value);
+	}
+}
+
+void AShooterPlayerController::HandleRespawnEvent(const FShooterGameplayEvent& Event)
+{
+	if (IsValid(BulletCounterUI) && Event.TargetId != INDEX_NONE && Event.TargetId == UShooterGameplayEventSubsystem::GetPlayerId(this))
+	{
+		BulletCounterUI->BP_HideDeathScreen();
+	}
+}
+
+void AShooterPlayerController::ClientPlayKillcam_Implementation(APawn* Killer, float RespawnTime)
+{
+	// 击杀者已经不在本地（不相关或已销毁）时没有可回放的数据
+	if (!Killer || Killer == GetPawn())
+	{
+		return;
+	}
+
+	if (UShooterKillcamSubsystem* Killcam = GetWorld()->GetSubsystem<UShooterKillcamSubsystem>())
+	{
+		Killcam->StartPlayback(this, Killer, RespawnTime, KillcamGhostClass);
+	}
+}
+
+void AShooterPlayerController::OnKillcamStarted(float Duration)
+{
+	if (IsValid(BulletCounterUI))
+	{
+		BulletCounterUI->BP_KillcamStarted(Duration);
+	}
+}
+
+void AShooterPlayerController::OnKillcamShot(const FVector& Location, const FRotator& Rotation, bool bFromKiller)
+{
+	if (IsValid(BulletCounterUI))
+	{
+		BulletCounterUI->BP_KillcamShot(Location, Rotation, bFromKiller);
+	}
+}
+
+void AShooterPlayerController::OnKillcamEnded()
+{
+	if (IsValid(BulletCounterUI))
+	{
+		BulletCounterUI->BP_KillcamEnded();
+	}
+}
@@ -4,12 +4,60 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "ShooterDamageSubsystem.h"
+#include "ShooterCombatNotifySubsystem.h"
 #include "ShooterPlayerController.generated.h"
 
 class UInputMappingContext;
 class AShooterCharacter;
 class UShooterBulletCounterUI;
 
+/** 受令牌桶限流保护的服务器 RPC 类型 */
+enum class EShooterServerRPC : uint8
+{
+	StartFiring,
+	StopFiring,
+	Reload,
+	ReportClientAim,
+
+	Num
+};
+
+/** 令牌桶限流检查结果 */
+enum class EShooterRPCRateResult : uint8
+{
+	/** 有可用令牌，正常执行 */
+	Accepted,
+
+	/** 超出速率，丢弃本次调用 */
+	Dropped,
+
+	/** 持续滥用，应当断开连接 */
+	Kick
+};
+
+/**
+ *  单个 RPC 的令牌桶
+ *  以 RefillRate 个/秒的速率补充令牌，最多累积 BurstSize 个，每次调用消耗一个
+ */
+struct FShooterRPCTokenBucket
+{
+	/** 当前可用令牌数 */
+	float Tokens = 0.0f;
+
+	/** 上次补充令牌的时间 */
+	double LastRefillTime = 0.0;
+
+	/** 通过限流的调用次数 */
+	uint32 AcceptedCount = 0;
+
+	/** 被丢弃的调用次数 */
+	uint32 DroppedCount = 0;
+
+	/** 补充令牌并尝试消耗一个，返回是否有可用令牌 */
+	bool TryConsume(double Now, float RefillRate, float BurstSize);
+};
+
 /**
  *  Simple PlayerController for a first person shooter game
  *  Manages input mappings
@@ -52,6 +100,47 @@ protected:
 	/** Pointer to the bullet counter UI widget */
 	TObjectPtr<UShooterBulletCounterUI> BulletCounterUI;
 
+	/** 击杀回放中代表其他战斗者的 Actor 类（只在本地生成，不复制；为空时只回放击杀者的视角） */
+	UPROPERTY(EditAnywhere, Category="Shooter|Killcam")
+	TSubclassOf<AActor> KillcamGhostClass;
+
+	/** 射击 RPC（开始/停止射击）的令牌补充速率（次/秒） */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 1))
+	float FiringRPCRate = 20.0f;
+
+	/** 射击 RPC 的突发容量（允许短时间内连续调用的次数） */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 1))
+	float FiringRPCBurst = 10.0f;
+
+	/** 换弹 RPC 的令牌补充速率（次/秒） */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 1))
+	float ReloadRPCRate = 2.0f;
+
+	/** 换弹 RPC 的突发容量 */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 1))
+	float ReloadRPCBurst = 3.0f;
+
+	/** 瞄准上报 RPC（射击追踪，每发一次）的令牌补充速率（次/秒） */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 1))
+	float ClientAimRPCRate = 30.0f;
+
+	/** 瞄准上报 RPC 的突发容量 */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 1))
+	float ClientAimRPCBurst = 15.0f;
+
+	/** 一秒内被丢弃的 RPC 超过此数量时断开客户端连接（0 = 从不断开） */
+	UPROPERTY(EditAnywhere, Category="Shooter|Net", meta = (ClampMin = 0))
+	int32 MaxDroppedRPCsPerSecond = 200;
+
+	/** 每种服务器 RPC 的令牌桶（按连接保存，角色重生后依然有效） */
+	FShooterRPCTokenBucket ServerRPCBuckets[(int32)EShooterServerRPC::Num];
+
+	/** 当前丢弃统计窗口的开始时间 */
+	double DroppedRPCWindowStart = 0.0;
+
+	/** 当前统计窗口内被丢弃的 RPC 数量 */
+	int32 DroppedRPCsInWindow = 0;
+
 protected:
 
 	/** Gameplay Initialization */
@@ -67,6 +156,9 @@ protected:
 	UFUNCTION()
 	void OnPawnDestroyed(AActor* DestroyedActor);
 
+	/** 为指定团队选择一个重生位置，没有可用出生点时返回 false */
+	bool FindRespawnTransform(uint8 TeamByte, FTransform& OutTransform);
+
 	/** Called when the bullet count on the possessed pawn is updated */
 	UFUNCTION()
 	void OnBulletCountUpdated(int32 MagazineSize, int32 Bullets);
@@ -74,4 +166,52 @@ protected:
 	/** Called when the possessed pawn is damaged */
 	UFUNCTION()
 	void OnPawnDamaged(float LifePercent);
+
+	/** 远程客户端：在击杀提示中显示涉及玩家的击杀 */
+	void HandleKillEvent(const FShooterGameplayEvent& Event);
+
+	/** 远程客户端：本地玩家死亡时显示死亡界面 */
+	void HandleDeathEvent(const FShooterGameplayEvent& Event);
+
+	/** 远程客户端：本地玩家重生时隐藏死亡界面 */
+	void HandleRespawnEvent(const FShooterGameplayEvent& Event);
+
+public:
+
+	/** 服务器端：将死亡的角色原地回收到新的出生点，失败时返回 false（调用方应回退到销毁重生） */
+	bool RecyclePawn(AShooterCharacter* DeadCharacter);
+
+	/** 服务器端：为指定 RPC 消耗一个令牌（在 RPC 的 _Validate 中调用） */
+	EShooterRPCRateResult ConsumeServerRPCToken(EShooterServerRPC RPC);
+
+	/** 客户端：接收本帧的命中确认批次（每个连接每帧最多一次） */
+	UFUNCTION(Client, Unreliable)
+	void ClientConfirmHits(const FShooterHitConfirmBatch& Batch);
+
+	/** 客户端：接收本帧的击杀提示批次（每个连接每帧最多一次），并发布到本地的事件总线 */
+	UFUNCTION(Client, Unreliable)
+	void ClientReceiveCombatNotifications(const FShooterCombatNotificationBatch& Batch);
+
+	/** 客户端：接收本地玩家自己的死亡和重生通知（可靠，死亡界面不会因丢包卡住），并发布到本地的事件总线 */
+	UFUNCTION(Client, Reliable)
+	void ClientReceivePersonalCombatNotifications(const FShooterCombatNotificationBatch& Batch);
+
+	/** 客户端：把收到的通知发布到本地的事件总线 */
+	void PublishCombatNotifications(const FShooterCombatNotificationBatch& Batch);
+
+	/** 客户端：本地玩家被击杀，从击杀者的视角回放死亡前的几秒（不超过重生等待时间） */
+	UFUNCTION(Client, Unreliable)
+	void ClientPlayKillcam(APawn* Killer, float RespawnTime);
+
+	/** 击杀回放开始 */
+	void OnKillcamStarted(float Duration);
+
+	/** 击杀回放中有人开火 */
+	void OnKillcamShot(const FVector& Location, const FRotator& Rotation, bool bFromKiller);
+
+	/** 击杀回放结束 */
+	void OnKillcamEnded();
+
+	/** 返回指定 RPC 的令牌桶（用于统计导出） */
+	const FShooterRPCTokenBucket& GetServerRPCBucket(EShooterServerRPC RPC) const { return ServerRPCBuckets[(int32)RPC]; }
 };
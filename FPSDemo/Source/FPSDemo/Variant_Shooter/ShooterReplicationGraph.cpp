@@ -0,0 +1,323 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterReplicationGraph.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/NetDriver.h"
+#include "HAL/IConsoleManager.h"
+#include "ShooterCharacter.h"
+#include "ShooterNPC.h"
+#include "ShooterProjectile.h"
+#include "ShooterWeapon.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("RepGraph Owner And Team Gather"), STAT_ShooterRepGraphOwnerAndTeam, STATGROUP_ShooterNet);
+DECLARE_CYCLE_STAT(TEXT("RepGraph Team Buckets"), STAT_ShooterRepGraphTeamBuckets, STATGROUP_ShooterNet);
+
+namespace ShooterRepGraph
+{
+	static float CellSize = 10000.0f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("Shooter.RepGraph.CellSize"),
+		CellSize,
+		TEXT("Size of a replication graph spatial grid cell, in cm. Read when the net driver starts."));
+
+	static float SpatialBiasX = -200000.0f;
+	static FAutoConsoleVariableRef CVarSpatialBiasX(
+		TEXT("Shooter.RepGraph.SpatialBiasX"),
+		SpatialBiasX,
+		TEXT("Smallest X coordinate covered by the spatial grid, in cm. Read when the net driver starts."));
+
+	static float SpatialBiasY = -200000.0f;
+	static FAutoConsoleVariableRef CVarSpatialBiasY(
+		TEXT("Shooter.RepGraph.SpatialBiasY"),
+		SpatialBiasY,
+		TEXT("Smallest Y coordinate covered by the spatial grid, in cm. Read when the net driver starts."));
+
+	static bool bTeammatesAlwaysRelevant = true;
+	static FAutoConsoleVariableRef CVarTeammatesAlwaysRelevant(
+		TEXT("Shooter.RepGraph.TeammatesAlwaysRelevant"),
+		bTeammatesAlwaysRelevant,
+		TEXT("If true, players always receive their teammates regardless of distance."));
+}
+
+void UShooterReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// explicit routes. Anything else is inferred from its class defaults in GetMappingPolicy
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EShooterRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EShooterRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EShooterRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(AShooterWeapon::StaticClass(), EShooterRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APawn::StaticClass(), EShooterRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AShooterProjectile::StaticClass(), EShooterRepNodeMapping::Spatialize_Dynamic);
+
+	// frequencies and cull distances come from each class's defaults. The shooter pawns set their own,
+	// so they are read from their CDOs rather than inherited from APawn's
+	InitClassReplicationInfo(AGameStateBase::StaticClass(), false);
+	InitClassReplicationInfo(APlayerState::StaticClass(), false);
+	InitClassReplicationInfo(APawn::StaticClass(), true);
+	InitClassReplicationInfo(AShooterCharacter::StaticClass(), true);
+	InitClassReplicationInfo(AShooterNPC::StaticClass(), true);
+	InitClassReplicationInfo(AShooterProjectile::StaticClass(), true);
+}
+
+void UShooterReplicationGraph::InitClassReplicationInfo(UClass* Class, bool bSpatialize)
+{
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+
+	FClassReplicationInfo ClassInfo;
+	if (bSpatialize)
+	{
+		ClassInfo.SetCullDistanceSquared(ActorCDO->GetNetCullDistanceSquared());
+	}
+
+	ClassInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->GetNetUpdateFrequency());
+
+	GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+}
+
+void UShooterReplicationGraph::SetWeaponActive(AShooterWeapon* Weapon, bool bActive)
+{
+	UNetDriver* NetDriver = Weapon ? Weapon->GetNetDriver() : nullptr;
+	UShooterReplicationGraph* Graph = NetDriver ? Cast<UShooterReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+	if (!Graph || !Weapon->GetOwner())
+	{
+		return;
+	}
+
+	// the held weapon is seen by everyone who sees its holder. Holstered weapons only reach the owner's node
+	if (bActive)
+	{
+		Graph->GlobalActorReplicationInfoMap.AddDependentActor(Weapon->GetOwner(), Weapon);
+	}
+	else
+	{
+		Graph->GlobalActorReplicationInfoMap.RemoveDependentActor(Weapon->GetOwner(), Weapon);
+	}
+}
+
+const FActorRepListRefView* UShooterReplicationGraph::GetTeamPawnList(uint8 TeamByte, uint32 ReplicationFrameNum)
+{
+	// bucket the players once per frame, every connection then adds its team's list as is
+	if (TeamPawnListsFrame != ReplicationFrameNum)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ShooterRepGraphTeamBuckets);
+
+		TeamPawnListsFrame = ReplicationFrameNum;
+
+		for (FActorRepListRefView& TeamPawnList : TeamPawnLists)
+		{
+			TeamPawnList.Reset();
+		}
+
+		for (const TWeakObjectPtr<AShooterCharacter>& PlayerPawn : PlayerPawns)
+		{
+			if (AShooterCharacter* Character = PlayerPawn.Get())
+			{
+				const int32 Team = Character->GetTeamByte();
+				if (Team >= TeamPawnLists.Num())
+				{
+					TeamPawnLists.SetNum(Team + 1);
+				}
+
+				TeamPawnLists[Team].ConditionalAdd(Character);
+			}
+		}
+	}
+
+	return TeamPawnLists.IsValidIndex(TeamByte) && TeamPawnLists[TeamByte].Num() > 0 ? &TeamPawnLists[TeamByte] : nullptr;
+}
+
+void UShooterReplicationGraph::InitGlobalGraphNodes()
+{
+	// characters, NPCs and projectiles are only considered for connections in nearby cells
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = ShooterRepGraph::CellSize;
+	GridNode->SpatialBias = FVector2D(ShooterRepGraph::SpatialBiasX, ShooterRepGraph::SpatialBiasY);
+	AddGlobalGraphNode(GridNode);
+
+	// game state and scores
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UShooterReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	UShooterReplicationGraphNode_OwnerAndTeam* OwnerAndTeamNode = CreateNewNode<UShooterReplicationGraphNode_OwnerAndTeam>();
+	AddConnectionGraphNode(OwnerAndTeamNode, RepGraphConnection);
+}
+
+EShooterRepNodeMapping UShooterReplicationGraph::GetMappingPolicy(const UClass* Class)
+{
+	if (const EShooterRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class))
+	{
+		return *Policy;
+	}
+
+	// owner only actors are left to the owner's node. Moving actors are updated in the grid every frame
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+	EShooterRepNodeMapping Policy = EShooterRepNodeMapping::Spatialize_Static;
+
+	if (ActorCDO->bAlwaysRelevant)
+	{
+		Policy = EShooterRepNodeMapping::RelevantAllConnections;
+	}
+	else if (ActorCDO->bOnlyRelevantToOwner)
+	{
+		Policy = EShooterRepNodeMapping::NotRouted;
+	}
+	else if (ActorCDO->IsReplicatingMovement())
+	{
+		Policy = EShooterRepNodeMapping::Spatialize_Dynamic;
+	}
+
+	ClassRepNodePolicies.Set(Class, Policy);
+	return Policy;
+}
+
+void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	AActor* Actor = ActorInfo.GetActor();
+
+	// remember the players for the team rules
+	if (AShooterCharacter* Character = Cast<AShooterCharacter>(Actor))
+	{
+		PlayerPawns.Add(Character);
+	}
+
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EShooterRepNodeMapping::NotRouted:
+
+		// the owner's node always gathers the whole inventory. A weapon in hand also replicates with its holder,
+		// which covers NPC weapons as they are never holstered
+		if (Actor->IsA<AShooterWeapon>() && Actor->GetOwner())
+		{
+			HolderWeapons.FindOrAdd(Actor->GetOwner()).AddUnique(Actor);
+
+			if (!Actor->IsHidden())
+			{
+				GlobalActorReplicationInfoMap.AddDependentActor(Actor->GetOwner(), Actor);
+			}
+		}
+		break;
+
+	case EShooterRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EShooterRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+
+	case EShooterRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	}
+}
+
+void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	AActor* Actor = ActorInfo.GetActor();
+
+	if (AShooterCharacter* Character = Cast<AShooterCharacter>(Actor))
+	{
+		PlayerPawns.RemoveSwap(Character);
+	}
+
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EShooterRepNodeMapping::NotRouted:
+		if (Actor->IsA<AShooterWeapon>() && Actor->GetOwner())
+		{
+			GlobalActorReplicationInfoMap.RemoveDependentActor(Actor->GetOwner(), Actor);
+
+			if (TArray<AActor*>* Weapons = HolderWeapons.Find(Actor->GetOwner()))
+			{
+				Weapons->RemoveSwap(Actor);
+				if (Weapons->Num() == 0)
+				{
+					HolderWeapons.Remove(Actor->GetOwner());
+				}
+			}
+		}
+		break;
+
+	case EShooterRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EShooterRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+
+	case EShooterRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	}
+}
+
+void UShooterReplicationGraphNode_OwnerAndTeam::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRepGraphOwnerAndTeam);
+
+	ReplicationActorList.Reset();
+
+	UShooterReplicationGraph* Graph = CastChecked<UShooterReplicationGraph>(GetOuter());
+
+	// split screen connections have several viewers
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		APlayerController* PC = Viewer.InViewer;
+		if (!PC)
+		{
+			continue;
+		}
+
+		// the controller, pawn and inventory are only relevant to their owner
+		ReplicationActorList.ConditionalAdd(PC);
+
+		if (Viewer.ViewTarget)
+		{
+			ReplicationActorList.ConditionalAdd(Viewer.ViewTarget);
+		}
+
+		const AShooterCharacter* ViewerCharacter = Cast<AShooterCharacter>(PC->GetPawn());
+		if (!ViewerCharacter)
+		{
+			continue;
+		}
+
+		ReplicationActorList.ConditionalAdd(PC->GetPawn());
+
+		if (const TArray<AActor*>* Weapons = Graph->GetHolderWeapons(ViewerCharacter))
+		{
+			for (AActor* Weapon : *Weapons)
+			{
+				ReplicationActorList.ConditionalAdd(Weapon);
+			}
+		}
+
+		// teammates are always relevant, so team HUD elements keep working at any distance.
+		// The team's list is shared by every connection on it, the viewer's own pawn in it is harmless
+		if (ShooterRepGraph::bTeammatesAlwaysRelevant)
+		{
+			if (const FActorRepListRefView* TeamPawnList = Graph->GetTeamPawnList(ViewerCharacter->GetTeamByte(), Params.ReplicationFrameNum))
+			{
+				Params.OutGatheredReplicationLists.AddReplicationActorList(*TeamPawnList);
+			}
+		}
+	}
+
+	if (ReplicationActorList.Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+	}
+}
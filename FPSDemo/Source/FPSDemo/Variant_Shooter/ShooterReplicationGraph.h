@@ -0,0 +1,126 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ShooterReplicationGraph.generated.h"
+
+class AShooterCharacter;
+class AShooterWeapon;
+class UReplicationGraphNode_GridSpatialization2D;
+
+/** 一个 Actor 类在复制图中的路由方式 */
+enum class EShooterRepNodeMapping : uint8
+{
+	/** 不加入任何全局节点（由连接节点或父 Actor 负责） */
+	NotRouted,
+
+	/** 对所有连接相关 */
+	RelevantAllConnections,
+
+	/** 加入空间网格，不会移动 */
+	Spatialize_Static,
+
+	/** 加入空间网格，每帧更新所在格子 */
+	Spatialize_Dynamic
+};
+
+/**
+ *  射击游戏的复制图
+ *  功能：
+ *  - 角色、NPC 和投射物放入二维空间网格，每个连接只检查附近格子中的 Actor
+ *  - GameState 和 PlayerState（比分数据）对所有连接相关
+ *  - 手中的武器作为持有者的依附 Actor，随持有者复制给所有看到它的连接（第三人称网格和射击表现需要）
+ *  - 收起的武器不再依附持有者，只由拥有者连接的专属节点复制（背包只对拥有者相关）
+ *  - 每个连接的专属节点提供它的 PlayerController、Pawn 和背包
+ *  - 可选的团队规则：队友对彼此始终相关（Shooter.RepGraph.TeammatesAlwaysRelevant），每帧按队伍分组一次，所有连接共享
+ *  在 DefaultEngine.ini 中通过 ReplicationDriverClassName 启用
+ */
+UCLASS(transient)
+class FPSDEMO_API UShooterReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Sets up the class routing and frequency settings */
+	virtual void InitGlobalActorClassSettings() override;
+
+	/** Creates the spatial grid and the always relevant node */
+	virtual void InitGlobalGraphNodes() override;
+
+	/** Creates the owner and team node for a new connection */
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+
+	/** Routes a new replicated actor to the nodes for its class */
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+
+	/** Removes a replicated actor from the nodes for its class */
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** 服务器端：武器激活或收起时调用，切换它是否随持有者复制给所有连接 */
+	static void SetWeaponActive(AShooterWeapon* Weapon, bool bActive);
+
+	/** 返回持有者的所有武器（包括收起的），没有时返回 nullptr */
+	const TArray<AActor*>* GetHolderWeapons(const AActor* Holder) const { return HolderWeapons.Find(Holder); }
+
+	/** 返回本帧指定队伍的玩家角色列表（每帧第一次调用时重建），没有该队伍时返回 nullptr */
+	const FActorRepListRefView* GetTeamPawnList(uint8 TeamByte, uint32 ReplicationFrameNum);
+
+protected:
+
+	/** 返回类的路由方式，未配置的类按 CDO 的相关性设置推断并缓存 */
+	EShooterRepNodeMapping GetMappingPolicy(const UClass* Class);
+
+	/** 按类的 CDO 设置复制频率和剔除距离 */
+	void InitClassReplicationInfo(UClass* Class, bool bSpatialize);
+
+	/** 空间网格节点 */
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	/** 对所有连接相关的节点 */
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+	/** 已复制的玩家角色 */
+	TArray<TWeakObjectPtr<AShooterCharacter>> PlayerPawns;
+
+	/** 按队伍分组的玩家角色（下标为队伍字节） */
+	TArray<FActorRepListRefView> TeamPawnLists;
+
+	/** TeamPawnLists 重建时的复制帧 */
+	uint32 TeamPawnListsFrame = MAX_uint32;
+
+	/** 各持有者的武器（武器销毁时移除） */
+	TMap<const AActor*, TArray<AActor*>> HolderWeapons;
+
+	/** 各类的路由方式 */
+	TClassMap<EShooterRepNodeMapping> ClassRepNodePolicies;
+};
+
+/**
+ *  每个连接的专属节点
+ *  收集连接的 PlayerController、视角目标、Pawn 和它的全部武器，以及启用团队规则时的队友列表
+ */
+UCLASS()
+class FPSDEMO_API UShooterReplicationGraphNode_OwnerAndTeam : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Actors are gathered per frame, not routed here */
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override { }
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override { }
+
+	/** Gathers the connection's own actors and its teammates */
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+protected:
+
+	/** 本帧收集的 Actor */
+	FActorRepListRefView ReplicationActorList;
+};
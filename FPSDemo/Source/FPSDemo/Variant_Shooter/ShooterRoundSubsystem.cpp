@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterRoundSubsystem.h"
+#include "ShooterNPC.h"
+#include "ShooterPickup.h"
+#include "Engine/World.h"
+
+bool UShooterRoundSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterRoundSubsystem::RegisterNPC(AShooterNPC* NPC, const FTransform& StartTransform)
+{
+	if (!NPC || !NPC->HasAuthority())
+	{
+		return;
+	}
+
+	// only called from BeginPlay, so a linear search is fine. Respawned NPCs already own their record
+	FShooterRoundNPCRecord* Record = NPCRecords.FindByPredicate([NPC](const FShooterRoundNPCRecord& Existing)
+	{
+		return Existing.NPC == NPC;
+	});
+
+	if (!Record)
+	{
+		Record = &NPCRecords.AddDefaulted_GetRef();
+		Record->NPC = NPC;
+		Record->NPCClass = NPC->GetClass();
+	}
+
+	Record->StartTransform = StartTransform;
+}
+
+void UShooterRoundSubsystem::RegisterPickup(AShooterPickup* Pickup)
+{
+	if (Pickup)
+	{
+		Pickups.AddUnique(Pickup);
+	}
+}
+
+void UShooterRoundSubsystem::UnregisterPickup(AShooterPickup* Pickup)
+{
+	Pickups.RemoveSwap(Pickup);
+}
+
+void UShooterRoundSubsystem::ResetNPCs(int32& OutNumRestored, int32& OutNumRespawned)
+{
+	OutNumRestored = 0;
+	OutNumRespawned = 0;
+
+	for (FShooterRoundNPCRecord& Record : NPCRecords)
+	{
+		if (AShooterNPC* NPC = Record.NPC.Get())
+		{
+			NPC->ResetForRound();
+			++OutNumRestored;
+		}
+		else if (RespawnNPC(Record))
+		{
+			++OutNumRespawned;
+		}
+	}
+}
+
+int32 UShooterRoundSubsystem::ResetLocalActors()
+{
+	int32 NumReset = 0;
+
+	for (const TWeakObjectPtr<AShooterPickup>& Pickup : Pickups)
+	{
+		if (AShooterPickup* ValidPickup = Pickup.Get())
+		{
+			ValidPickup->ResetForRound();
+			++NumReset;
+		}
+	}
+
+	return NumReset;
+}
+
+AShooterNPC* UShooterRoundSubsystem::RespawnNPC(FShooterRoundNPCRecord& Record)
+{
+	if (!Record.NPCClass)
+	{
+		return nullptr;
+	}
+
+	// defer the spawn so the record owns the NPC before its BeginPlay registers it
+	AShooterNPC* NPC = GetWorld()->SpawnActorDeferred<AShooterNPC>(Record.NPCClass, Record.StartTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!NPC)
+	{
+		return nullptr;
+	}
+
+	Record.NPC = NPC;
+	NPC->FinishSpawning(Record.StartTransform);
+
+	// placed NPCs are only auto possessed when the level loads
+	if (!NPC->GetController())
+	{
+		NPC->SpawnDefaultController();
+	}
+
+	return NPC;
+}
@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterRoundSubsystem.generated.h"
+
+class AShooterNPC;
+class AShooterPickup;
+
+/** 回合重置时需要恢复的一个 NPC */
+struct FShooterRoundNPCRecord
+{
+	/** NPC（永久死亡被销毁后失效，重置时重新生成） */
+	TWeakObjectPtr<AShooterNPC> NPC;
+
+	/** NPC 类型（重新生成时使用） */
+	TSubclassOf<AShooterNPC> NPCClass;
+
+	/** 出生变换 */
+	FTransform StartTransform;
+};
+
+/**
+ *  回合重置子系统
+ *  功能：
+ *  - 记录关卡中每个 NPC 的类型和出生变换（仅服务器），以及所有拾取物（服务器和客户端）
+ *  - 原地重置回合：NPC 回到出生点并恢复满血，已被销毁的 NPC 在出生点重新生成，拾取物恢复可拾取状态
+ *  - 不重新加载地图：资源、控制器、UI 和各子系统的缓存都保持加载状态
+ *  - 拾取物不复制，客户端在收到 GameState 的回合编号变化时重置本地的拾取物
+ */
+UCLASS()
+class FPSDEMO_API UShooterRoundSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 服务器端：记录一个 NPC 的出生信息（NPC BeginPlay 时调用，重复调用只更新出生变换） */
+	void RegisterNPC(AShooterNPC* NPC, const FTransform& StartTransform);
+
+	/** 注册一个拾取物 */
+	void RegisterPickup(AShooterPickup* Pickup);
+
+	/** 注销一个拾取物 */
+	void UnregisterPickup(AShooterPickup* Pickup);
+
+	/** 服务器端：把所有 NPC 恢复到出生状态（AI 的重启由调用方通过 AI 种群子系统分帧执行） */
+	void ResetNPCs(int32& OutNumRestored, int32& OutNumRespawned);
+
+	/** 重置本机的非复制 Actor（拾取物），返回重置的数量 */
+	int32 ResetLocalActors();
+
+	/** 返回记录的 NPC 数量 */
+	int32 GetNumNPCs() const { return NPCRecords.Num(); }
+
+	/** 返回注册的拾取物数量 */
+	int32 GetNumPickups() const { return Pickups.Num(); }
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** 在出生点重新生成一个已被销毁的 NPC */
+	AShooterNPC* RespawnNPC(FShooterRoundNPCRecord& Record);
+
+	/** NPC 出生记录（记录在 NPC 被销毁后保留） */
+	TArray<FShooterRoundNPCRecord> NPCRecords;
+
+	/** 拾取物 */
+	TArray<TWeakObjectPtr<AShooterPickup>> Pickups;
+};
@@ -0,0 +1,440 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterSpawnPointSubsystem.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/Stats.h"
+#include "GameFramework/Pawn.h"
+#include "ShooterCombatantSubsystem.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Point Grid Rebuild"), STAT_ShooterSpawnGridRebuild, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Spawn Point Scoring"), STAT_ShooterSpawnScoring, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Spawn Point Selection"), STAT_ShooterSpawnSelection, STATGROUP_Shooter);
+
+namespace ShooterSpawnPoints
+{
+	static float CellSize = 2000.0f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("Shooter.SpawnPoints.CellSize"),
+		CellSize,
+		TEXT("Size of a threat grid cell, in cm."));
+
+	static float GridRebuildInterval = 0.25f;
+	static FAutoConsoleVariableRef CVarGridRebuildInterval(
+		TEXT("Shooter.SpawnPoints.GridRebuildInterval"),
+		GridRebuildInterval,
+		TEXT("Seconds between threat grid rebuilds."));
+
+	static int32 ScoredPerTick = 8;
+	static FAutoConsoleVariableRef CVarScoredPerTick(
+		TEXT("Shooter.SpawnPoints.ScoredPerTick"),
+		ScoredPerTick,
+		TEXT("Number of spawn points rescored per frame."));
+
+	static float EnemyWeight = 10.0f;
+	static FAutoConsoleVariableRef CVarEnemyWeight(
+		TEXT("Shooter.SpawnPoints.EnemyWeight"),
+		EnemyWeight,
+		TEXT("Score penalty for each enemy near a spawn point. Enemies in the spawn point's own cell count double."));
+
+	static float HeatWeight = 5.0f;
+	static FAutoConsoleVariableRef CVarHeatWeight(
+		TEXT("Shooter.SpawnPoints.HeatWeight"),
+		HeatWeight,
+		TEXT("Score penalty for each unit of recent combat near a spawn point."));
+
+	static float HeatHalfLife = 5.0f;
+	static FAutoConsoleVariableRef CVarHeatHalfLife(
+		TEXT("Shooter.SpawnPoints.HeatHalfLife"),
+		HeatHalfLife,
+		TEXT("Seconds for reported combat heat to decay to half its value."));
+
+	static float LineOfFirePenalty = 50.0f;
+	static FAutoConsoleVariableRef CVarLineOfFirePenalty(
+		TEXT("Shooter.SpawnPoints.LineOfFirePenalty"),
+		LineOfFirePenalty,
+		TEXT("Score penalty when a nearby enemy has line of sight to the spawn point."));
+
+	static float ReuseCooldown = 2.0f;
+	static FAutoConsoleVariableRef CVarReuseCooldown(
+		TEXT("Shooter.SpawnPoints.ReuseCooldown"),
+		ReuseCooldown,
+		TEXT("Seconds before the same spawn point is preferred again."));
+
+	/** Height above the spawn point used for line of sight checks */
+	static constexpr float EyeHeight = 80.0f;
+
+	/** Heat below this value is dropped from the grid */
+	static constexpr float MinHeat = 0.05f;
+}
+
+bool UShooterSpawnPointSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterSpawnPointSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// clients never choose spawn points
+	if (InWorld.GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	// this is the only time we iterate the world's player starts. Levels streamed in later register their own
+	SpawnPoints.Reset();
+
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+	{
+		AddSpawnPoint(*It);
+	}
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UShooterSpawnPointSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UShooterSpawnPointSubsystem::OnLevelRemoved);
+
+	RebuildThreatGrid();
+	ScoreAllSpawnPoints();
+}
+
+void UShooterSpawnPointSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Super::Deinitialize();
+}
+
+bool UShooterSpawnPointSubsystem::AddSpawnPoint(APlayerStart* PlayerStart)
+{
+	if (!PlayerStart || SpawnPoints.ContainsByPredicate([PlayerStart](const FShooterSpawnPoint& SpawnPoint) { return SpawnPoint.PlayerStart == PlayerStart; }))
+	{
+		return false;
+	}
+
+	FShooterSpawnPoint& SpawnPoint = SpawnPoints.AddDefaulted_GetRef();
+	SpawnPoint.PlayerStart = PlayerStart;
+	SpawnPoint.Transform = PlayerStart->GetActorTransform();
+	SpawnPoint.Cell = GetCell(SpawnPoint.Transform.GetLocation());
+	return true;
+}
+
+void UShooterSpawnPointSubsystem::AddLevelSpawnPoints(ULevel* Level)
+{
+	bool bAdded = false;
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (APlayerStart* PlayerStart = Cast<APlayerStart>(Actor))
+		{
+			bAdded |= AddSpawnPoint(PlayerStart);
+		}
+	}
+
+	if (bAdded)
+	{
+		// indices changed, so republish the best lists
+		ScoreAllSpawnPoints();
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (Level && World == GetWorld() && World->GetNetMode() != NM_Client)
+	{
+		AddLevelSpawnPoints(Level);
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	// a null level means every streamed level went away; their player starts are already gone or going
+	const int32 Removed = SpawnPoints.RemoveAll([Level](const FShooterSpawnPoint& SpawnPoint)
+	{
+		const APlayerStart* PlayerStart = SpawnPoint.PlayerStart.Get();
+		return !PlayerStart || (Level ? PlayerStart->GetLevel() == Level : !PlayerStart->GetLevel()->IsPersistentLevel());
+	});
+
+	if (Removed > 0)
+	{
+		ScoreAllSpawnPoints();
+	}
+}
+
+bool UShooterSpawnPointSubsystem::ChooseSpawnTransform(uint8 TeamByte, FTransform& OutTransform)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSpawnSelection);
+
+	if (SpawnPoints.Num() == 0)
+	{
+		return false;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const int32 TeamSlot = GetTeamSlot(TeamByte);
+	const int32* Best = BestSpawnPoints[TeamSlot];
+
+	// take the best spawn point that wasn't used recently
+	int32 ChosenIndex = INDEX_NONE;
+
+	for (int32 i = 0; i < ShooterSpawnPoints::NumBestSpawnPoints && Best[i] != INDEX_NONE; ++i)
+	{
+		if (Now - SpawnPoints[Best[i]].LastUsedTime >= ShooterSpawnPoints::ReuseCooldown)
+		{
+			ChosenIndex = Best[i];
+			break;
+		}
+	}
+
+	// every cached spawn point was used recently, so fall back to the safest one
+	if (ChosenIndex == INDEX_NONE)
+	{
+		ChosenIndex = Best[0] != INDEX_NONE ? Best[0] : FMath::RandRange(0, SpawnPoints.Num() - 1);
+	}
+
+	FShooterSpawnPoint& SpawnPoint = SpawnPoints[ChosenIndex];
+	SpawnPoint.LastUsedTime = Now;
+
+	OutTransform = SpawnPoint.Transform;
+	return true;
+}
+
+void UShooterSpawnPointSubsystem::ReportCombat(const FVector& Location, float Weight)
+{
+	CombatHeat.FindOrAdd(GetCell(Location)) += Weight;
+}
+
+void UShooterSpawnPointSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (SpawnPoints.Num() == 0)
+	{
+		return;
+	}
+
+	// rebuild the threat grid at a fixed rate
+	TimeUntilGridRebuild -= DeltaTime;
+
+	if (TimeUntilGridRebuild <= 0.0f)
+	{
+		RebuildThreatGrid();
+		TimeUntilGridRebuild = ShooterSpawnPoints::GridRebuildInterval;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSpawnScoring);
+
+	// rescore a few spawn points per frame
+	const int32 NumToScore = FMath::Min(FMath::Max(1, ShooterSpawnPoints::ScoredPerTick), SpawnPoints.Num());
+
+	for (int32 i = 0; i < NumToScore; ++i)
+	{
+		if (NextSpawnToScore == 0)
+		{
+			ResetPendingBest();
+		}
+
+		ScoreSpawnPoint(SpawnPoints[NextSpawnToScore]);
+		InsertIntoBest(NextSpawnToScore);
+
+		// publish the best lists once the sweep wraps around
+		if (++NextSpawnToScore >= SpawnPoints.Num())
+		{
+			FMemory::Memcpy(BestSpawnPoints, PendingBestSpawnPoints, sizeof(BestSpawnPoints));
+			NextSpawnToScore = 0;
+		}
+	}
+}
+
+TStatId UShooterSpawnPointSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterSpawnPointSubsystem, STATGROUP_Tickables);
+}
+
+FIntPoint UShooterSpawnPointSubsystem::GetCell(const FVector& Location) const
+{
+	const float CellSize = FMath::Max(100.0f, ShooterSpawnPoints::CellSize);
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UShooterSpawnPointSubsystem::RebuildThreatGrid()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSpawnGridRebuild);
+
+	// keep the allocation between rebuilds
+	ThreatGrid.Reset();
+
+	const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>();
+	const int32 NumCombatants = Combatants ? Combatants->Num() : 0;
+
+	// the registry already knows every combatant's team and alive state, no actor iteration or casts
+	for (int32 Index = 0; Index < NumCombatants; ++Index)
+	{
+		const APawn* Pawn = Combatants->GetPawn(Index);
+		if (!Pawn || !Combatants->IsAlive(Index))
+		{
+			continue;
+		}
+
+		const FVector Location = Pawn->GetActorLocation();
+		const int32 TeamSlot = GetTeamSlot(Combatants->GetTeam(Index));
+
+		FShooterThreatCell& Cell = ThreatGrid.FindOrAdd(GetCell(Location));
+		Cell.TeamLocations[TeamSlot] = Location;
+		++Cell.TeamCounts[TeamSlot];
+		++Cell.Total;
+	}
+
+	// decay the combat heat
+	const float Decay = FMath::Pow(0.5f, ShooterSpawnPoints::GridRebuildInterval / FMath::Max(0.01f, ShooterSpawnPoints::HeatHalfLife));
+
+	for (auto It = CombatHeat.CreateIterator(); It; ++It)
+	{
+		It.Value() *= Decay;
+
+		if (It.Value() < ShooterSpawnPoints::MinHeat)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::ScoreSpawnPoint(FShooterSpawnPoint& SpawnPoint)
+{
+	using namespace ShooterSpawnPoints;
+
+	int32 Enemies[NumTeamSlots] = {};
+	const FVector* EnemyLocations[NumTeamSlots] = {};
+	float Heat = 0.0f;
+
+	// gather the 3x3 neighbourhood
+	for (int32 Y = -1; Y <= 1; ++Y)
+	{
+		for (int32 X = -1; X <= 1; ++X)
+		{
+			const FIntPoint CellCoords = SpawnPoint.Cell + FIntPoint(X, Y);
+			const bool bIsCenter = X == 0 && Y == 0;
+
+			if (const float* CellHeat = CombatHeat.Find(CellCoords))
+			{
+				Heat += *CellHeat;
+			}
+
+			const FShooterThreatCell* Cell = ThreatGrid.Find(CellCoords);
+			if (!Cell)
+			{
+				continue;
+			}
+
+			for (int32 TeamSlot = 0; TeamSlot < NumTeamSlots; ++TeamSlot)
+			{
+				const int32 CellEnemies = Cell->Total - Cell->TeamCounts[TeamSlot];
+				Enemies[TeamSlot] += bIsCenter ? CellEnemies * 2 : CellEnemies;
+
+				// remember one enemy position per team for the line of sight check, preferring the center cell
+				if (!EnemyLocations[TeamSlot] || bIsCenter)
+				{
+					for (int32 OtherSlot = 0; OtherSlot < NumTeamSlots; ++OtherSlot)
+					{
+						if (OtherSlot != TeamSlot && Cell->TeamCounts[OtherSlot] > 0)
+						{
+							EnemyLocations[TeamSlot] = &Cell->TeamLocations[OtherSlot];
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	const FVector SpawnEye = SpawnPoint.Transform.GetLocation() + FVector(0.0f, 0.0f, EyeHeight);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterSpawnLineOfFire), false);
+	QueryParams.AddIgnoredActor(SpawnPoint.PlayerStart.Get());
+
+	for (int32 TeamSlot = 0; TeamSlot < NumTeamSlots; ++TeamSlot)
+	{
+		float Score = -EnemyWeight * Enemies[TeamSlot] - HeatWeight * Heat;
+
+		// one trace per team, only when an enemy is close enough to matter
+		if (EnemyLocations[TeamSlot])
+		{
+			const FVector EnemyEye = *EnemyLocations[TeamSlot] + FVector(0.0f, 0.0f, EyeHeight);
+
+			if (!GetWorld()->LineTraceTestByChannel(EnemyEye, SpawnEye, ECC_Visibility, QueryParams))
+			{
+				Score -= LineOfFirePenalty;
+			}
+		}
+
+		SpawnPoint.TeamScores[TeamSlot] = Score;
+	}
+}
+
+void UShooterSpawnPointSubsystem::InsertIntoBest(int32 SpawnIndex)
+{
+	using namespace ShooterSpawnPoints;
+
+	const FShooterSpawnPoint& SpawnPoint = SpawnPoints[SpawnIndex];
+
+	for (int32 TeamSlot = 0; TeamSlot < NumTeamSlots; ++TeamSlot)
+	{
+		int32* Best = PendingBestSpawnPoints[TeamSlot];
+		const float Score = SpawnPoint.TeamScores[TeamSlot];
+
+		// insertion into a short sorted list
+		for (int32 i = 0; i < NumBestSpawnPoints; ++i)
+		{
+			if (Best[i] == INDEX_NONE || Score > SpawnPoints[Best[i]].TeamScores[TeamSlot])
+			{
+				for (int32 j = NumBestSpawnPoints - 1; j > i; --j)
+				{
+					Best[j] = Best[j - 1];
+				}
+
+				Best[i] = SpawnIndex;
+				break;
+			}
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::ScoreAllSpawnPoints()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSpawnScoring);
+
+	ResetPendingBest();
+
+	for (int32 SpawnIndex = 0; SpawnIndex < SpawnPoints.Num(); ++SpawnIndex)
+	{
+		ScoreSpawnPoint(SpawnPoints[SpawnIndex]);
+		InsertIntoBest(SpawnIndex);
+	}
+
+	FMemory::Memcpy(BestSpawnPoints, PendingBestSpawnPoints, sizeof(BestSpawnPoints));
+
+	// restart the incremental sweep
+	NextSpawnToScore = 0;
+}
+
+void UShooterSpawnPointSubsystem::ResetPendingBest()
+{
+	for (int32 TeamSlot = 0; TeamSlot < ShooterSpawnPoints::NumTeamSlots; ++TeamSlot)
+	{
+		for (int32 i = 0; i < ShooterSpawnPoints::NumBestSpawnPoints; ++i)
+		{
+			PendingBestSpawnPoints[TeamSlot][i] = INDEX_NONE;
+		}
+	}
+}
@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSpawnPointSubsystem.generated.h"
+
+class APlayerStart;
+class ULevel;
+
+namespace ShooterSpawnPoints
+{
+	/** 单独计分的团队数量，更大的团队 ID 归入最后一个"未知"槽位 */
+	constexpr int32 MaxTeams = 4;
+
+	/** 计分槽位数量（MaxTeams + 未知团队） */
+	constexpr int32 NumTeamSlots = MaxTeams + 1;
+
+	/** 每个团队缓存的最佳出生点数量 */
+	constexpr int32 NumBestSpawnPoints = 4;
+}
+
+/** 威胁网格中的一个格子 */
+struct FShooterThreatCell
+{
+	/** 各团队在此格子中的角色数量 */
+	uint16 TeamCounts[ShooterSpawnPoints::NumTeamSlots] = {};
+
+	/** 格子中的角色总数 */
+	uint16 Total = 0;
+
+	/** 各团队在此格子中任意一个角色的位置（用于视线检查） */
+	FVector TeamLocations[ShooterSpawnPoints::NumTeamSlots];
+};
+
+/** 一个已注册的出生点 */
+struct FShooterSpawnPoint
+{
+	/** 出生点 Actor */
+	TWeakObjectPtr<APlayerStart> PlayerStart;
+
+	/** 缓存的出生变换 */
+	FTransform Transform;
+
+	/** 所在网格坐标 */
+	FIntPoint Cell;
+
+	/** 各团队视角下的评分（越高越安全） */
+	float TeamScores[ShooterSpawnPoints::NumTeamSlots] = {};
+
+	/** 上次被选中的时间 */
+	double LastUsedTime = -1000.0;
+};
+
+/**
+ *  出生点注册与威胁感知选择子系统
+ *  功能：
+ *  - 在开始游戏时注册一次所有 PlayerStart，之后只在流式关卡加载/卸载时注册或注销该关卡中的 PlayerStart
+ *  - 定期把所有角色写入粗粒度的二维空间网格（按团队计数），并记录近期战斗热度
+ *  - 每帧只增量更新少量出生点的评分（邻近敌人、战斗热度、敌人视线）
+ *  - 每轮评分结束时为每个团队缓存最佳出生点列表，选择出生点为 O(1)
+ */
+UCLASS()
+class FPSDEMO_API UShooterSpawnPointSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 为指定团队选择最安全的出生点，没有出生点时返回 false */
+	bool ChooseSpawnTransform(uint8 TeamByte, FTransform& OutTransform);
+
+	/** 报告一次战斗事件（受伤、爆炸等），附近的出生点会在一段时间内被降低评分 */
+	void ReportCombat(const FVector& Location, float Weight = 1.0f);
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Registers the level's player starts */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Stops listening for streamed levels */
+	virtual void Deinitialize() override;
+
+	/** Incrementally updates the threat grid and spawn scores */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 添加一个出生点（不重新评分），已注册时返回 false */
+	bool AddSpawnPoint(APlayerStart* PlayerStart);
+
+	/** 注册一个关卡中的所有 PlayerStart */
+	void AddLevelSpawnPoints(ULevel* Level);
+
+	/** 流式关卡加载完成：注册其中的出生点 */
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+
+	/** 流式关卡卸载：注销其中的出生点 */
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	/** 把团队 ID 映射为计分槽位 */
+	static int32 GetTeamSlot(uint8 TeamByte) { return TeamByte < ShooterSpawnPoints::MaxTeams ? TeamByte : ShooterSpawnPoints::MaxTeams; }
+
+	/** 世界坐标转网格坐标 */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** 重建威胁网格并衰减战斗热度 */
+	void RebuildThreatGrid();
+
+	/** 重新计算一个出生点在所有团队视角下的评分 */
+	void ScoreSpawnPoint(FShooterSpawnPoint& SpawnPoint);
+
+	/** 把出生点插入正在构建的最佳列表 */
+	void InsertIntoBest(int32 SpawnIndex);
+
+	/** 立即为所有出生点评分并发布最佳列表（注册变化后调用） */
+	void ScoreAllSpawnPoints();
+
+	/** 清空正在构建的最佳列表 */
+	void ResetPendingBest();
+
+	/** 已注册的出生点 */
+	TArray<FShooterSpawnPoint> SpawnPoints;
+
+	/** 当前威胁网格 */
+	TMap<FIntPoint, FShooterThreatCell> ThreatGrid;
+
+	/** 战斗热度网格（随时间衰减） */
+	TMap<FIntPoint, float> CombatHeat;
+
+	/** 已发布的各团队最佳出生点索引（按评分从高到低，INDEX_NONE 表示空） */
+	int32 BestSpawnPoints[ShooterSpawnPoints::NumTeamSlots][ShooterSpawnPoints::NumBestSpawnPoints];
+
+	/** 本轮评分中正在构建的最佳出生点索引 */
+	int32 PendingBestSpawnPoints[ShooterSpawnPoints::NumTeamSlots][ShooterSpawnPoints::NumBestSpawnPoints];
+
+	/** 下一个要评分的出生点 */
+	int32 NextSpawnToScore = 0;
+
+	/** 距离下次重建威胁网格的时间 */
+	float TimeUntilGridRebuild = 0.0f;
+
+	/** 流式关卡回调句柄 */
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -0,0 +1,479 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterTelemetry.h"
+#include "ShooterCombatantSubsystem.h"
+#include "ShooterGameplayEventSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+#include "Async/Async.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Stats/Stats.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Telemetry Position Sample"), STAT_ShooterTelemetrySample, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Telemetry Records Queued"), STAT_ShooterTelemetryQueued, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Telemetry Records Dropped"), STAT_ShooterTelemetryDropped, STATGROUP_Shooter);
+
+namespace ShooterTelemetry
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Shooter.Telemetry.Enable"),
+		bEnabled,
+		TEXT("Streams per-match telemetry (kills, deaths, damage, shots, positions, score) to Saved/Telemetry on the server. Read when the world begins play."));
+
+	static float PositionInterval = 1.0f;
+	static FAutoConsoleVariableRef CVarPositionInterval(
+		TEXT("Shooter.Telemetry.PositionInterval"),
+		PositionInterval,
+		TEXT("Seconds between combatant position samples. 0 disables position sampling."));
+
+	static int32 QueueCapacity = 16384;
+	static FAutoConsoleVariableRef CVarQueueCapacity(
+		TEXT("Shooter.Telemetry.QueueCapacity"),
+		QueueCapacity,
+		TEXT("Number of records the game thread can queue before the writer thread catches up. Rounded up to a power of two."));
+
+	static int32 RecordsPerBlock = 4096;
+	static FAutoConsoleVariableRef CVarRecordsPerBlock(
+		TEXT("Shooter.Telemetry.RecordsPerBlock"),
+		RecordsPerBlock,
+		TEXT("Number of records compressed together in one block of the telemetry file."));
+
+	static float FlushInterval = 5.0f;
+	static FAutoConsoleVariableRef CVarFlushInterval(
+		TEXT("Shooter.Telemetry.FlushInterval"),
+		FlushInterval,
+		TEXT("Maximum number of seconds records wait before a partial block is written."));
+
+	static FAutoConsoleCommandWithWorld RestartCommand(
+		TEXT("Shooter.Telemetry.Restart"),
+		TEXT("Closes the current telemetry file and starts a new one."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UShooterTelemetrySubsystem>() : nullptr)
+			{
+				Telemetry->Restart();
+			}
+		}));
+
+	/** Serializes one column of a block */
+	template<typename GetterType>
+	static void SerializeColumn(FArchive& Ar, TArray<FShooterTelemetryRecord>& Records, GetterType Getter)
+	{
+		for (FShooterTelemetryRecord& Record : Records)
+		{
+			Ar << Getter(Record);
+		}
+	}
+}
+
+void ShooterTelemetryFormat::SerializeColumns(FArchive& Ar, TArray<FShooterTelemetryRecord>& Records)
+{
+	using namespace ShooterTelemetry;
+
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> uint8& { return Record.Type; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> uint8& { return Record.SubjectTeam; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> uint8& { return Record.OtherTeam; });
+
+	// times are stored as deltas, which are small and repeat a lot
+	uint32 PreviousTimeMs = 0;
+	for (FShooterTelemetryRecord& Record : Records)
+	{
+		uint32 DeltaMs = Record.TimeMs - PreviousTimeMs;
+		Ar << DeltaMs;
+
+		if (Ar.IsLoading())
+		{
+			Record.TimeMs = PreviousTimeMs + DeltaMs;
+		}
+
+		PreviousTimeMs = Record.TimeMs;
+	}
+
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> int32& { return Record.SubjectId; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> int32& { return Record.OtherId; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> float& { return Record.Value; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> float& { return Record.Location.X; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> float& { return Record.Location.Y; });
+	SerializeColumn(Ar, Records, [](FShooterTelemetryRecord& Record) -> float& { return Record.Location.Z; });
+}
+
+FShooterTelemetryWriter::FShooterTelemetryWriter(const FString& InFilePath, const FString& InMapName, uint32 QueueCapacity, uint32 InRecordsPerBlock, float InFlushInterval)
+	: Queue(FMath::RoundUpToPowerOfTwo(FMath::Max(QueueCapacity, 2u)))
+	, FilePath(InFilePath)
+	, MapName(InMapName)
+	, RecordsPerBlock(FMath::Clamp(InRecordsPerBlock, 1u, ShooterTelemetryFormat::MaxRecordsPerBlock))
+	, FlushInterval(FMath::Max(InFlushInterval, 0.1f))
+{
+}
+
+FShooterTelemetryWriter::~FShooterTelemetryWriter()
+{
+	Shutdown();
+}
+
+bool FShooterTelemetryWriter::Start()
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("ShooterTelemetryWriter"), 0, TPri_BelowNormal);
+
+	return Thread != nullptr;
+}
+
+void FShooterTelemetryWriter::Shutdown()
+{
+	if (Thread)
+	{
+		// the thread writes whatever is still queued before it exits
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (WakeEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+}
+
+void FShooterTelemetryWriter::Stop()
+{
+	bStopRequested = true;
+
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+uint32 FShooterTelemetryWriter::Run()
+{
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not open telemetry file %s for writing."), *FilePath);
+		return 1;
+	}
+
+	WriteHeader();
+
+	PendingRecords.Reserve(RecordsPerBlock);
+	LastBlockTime = FPlatformTime::Seconds();
+
+	// the game thread never waits on us, we poll a few times per second
+	while (!bStopRequested)
+	{
+		WakeEvent->Wait(250);
+
+		DrainQueue();
+
+		if (PendingRecords.Num() > 0 && FPlatformTime::Seconds() - LastBlockTime >= FlushInterval)
+		{
+			WriteBlock();
+		}
+	}
+
+	// the game thread has stopped producing, write everything that's left
+	DrainQueue();
+	WriteBlock();
+
+	Writer->Close();
+	Writer.Reset();
+
+	UE_LOG(LogFPSDemo, Log, TEXT("Wrote %llu telemetry records to %s (%llu bytes raw, %llu bytes compressed)."),
+		NumRecordsWritten, *FilePath, NumRawBytes, NumCompressedBytes);
+
+	return 0;
+}
+
+void FShooterTelemetryWriter::WriteHeader()
+{
+	uint32 Magic = ShooterTelemetryFormat::FileMagic;
+	uint32 Version = ShooterTelemetryFormat::FileVersion;
+	int64 StartTicks = FDateTime::UtcNow().GetTicks();
+
+	*Writer << Magic << Version << StartTicks << MapName;
+}
+
+void FShooterTelemetryWriter::DrainQueue()
+{
+	FShooterTelemetryRecord Record;
+	while (Queue.Dequeue(Record))
+	{
+		PendingRecords.Add(Record);
+
+		if ((uint32)PendingRecords.Num() >= RecordsPerBlock)
+		{
+			WriteBlock();
+		}
+	}
+}
+
+void FShooterTelemetryWriter::WriteBlock()
+{
+	LastBlockTime = FPlatformTime::Seconds();
+
+	if (PendingRecords.Num() == 0)
+	{
+		return;
+	}
+
+	// lay the block out column by column
+	ColumnBuffer.Reset();
+	FMemoryWriter ColumnWriter(ColumnBuffer);
+	ShooterTelemetryFormat::SerializeColumns(ColumnWriter, PendingRecords);
+
+	const int32 UncompressedSize = ColumnBuffer.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+	CompressedBuffer.SetNumUninitialized(CompressedSize, EAllowShrinking::No);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, CompressedBuffer.GetData(), CompressedSize, ColumnBuffer.GetData(), UncompressedSize))
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not compress a telemetry block of %d records, dropping it."), PendingRecords.Num());
+		PendingRecords.Reset();
+		return;
+	}
+
+	uint32 NumRecords = PendingRecords.Num();
+	uint32 RawSize = UncompressedSize;
+	uint32 BlockSize = CompressedSize;
+
+	*Writer << NumRecords << RawSize << BlockSize;
+	Writer->Serialize(CompressedBuffer.GetData(), CompressedSize);
+
+	// a crash only loses the block being built
+	Writer->Flush();
+
+	NumRecordsWritten += NumRecords;
+	NumRawBytes += RawSize;
+	NumCompressedBytes += BlockSize;
+
+	PendingRecords.Reset();
+}
+
+bool UShooterTelemetrySubsystem::IsEnabled()
+{
+	return ShooterTelemetry::bEnabled;
+}
+
+bool UShooterTelemetrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterTelemetrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// telemetry is recorded where the gameplay is decided
+	if (IsEnabled() && InWorld.GetNetMode() != NM_Client)
+	{
+		StartWriter();
+	}
+}
+
+void UShooterTelemetrySubsystem::Deinitialize()
+{
+	StopWriter();
+
+	Super::Deinitialize();
+}
+
+void UShooterTelemetrySubsystem::Restart()
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	// finish the old file off the game thread, the new one starts right away
+	if (Writer)
+	{
+		Async(EAsyncExecution::ThreadPool, [OldWriter = MoveTemp(Writer)]() mutable
+		{
+			OldWriter.Reset();
+		});
+	}
+
+	StartWriter();
+}
+
+void UShooterTelemetrySubsystem::StartWriter()
+{
+	const FString MapName = GetWorld()->GetMapName();
+	const FString FilePath = FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Match_%s_%s.stlm"), *MapName, *FDateTime::Now().ToString(TEXT("%Y.%m.%d-%H.%M.%S.%s")));
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+
+	Writer = MakeUnique<FShooterTelemetryWriter>(FilePath, MapName, ShooterTelemetry::QueueCapacity, ShooterTelemetry::RecordsPerBlock, ShooterTelemetry::FlushInterval);
+
+	if (!Writer->Start())
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not start the telemetry writer thread."));
+		Writer.Reset();
+		return;
+	}
+
+	PositionSampleTimer = 0.0f;
+
+	UE_LOG(LogFPSDemo, Log, TEXT("Recording telemetry to %s."), *FilePath);
+}
+
+void UShooterTelemetrySubsystem::StopWriter()
+{
+	// blocks until the writer thread has flushed the queue
+	Writer.Reset();
+}
+
+void UShooterTelemetrySubsystem::Record(EShooterTelemetryType Type, int32 SubjectId, uint8 SubjectTeam, int32 OtherId, uint8 OtherTeam, float Value, const FVector& Location)
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	FShooterTelemetryRecord Record;
+	Record.Type = (uint8)Type;
+	Record.SubjectTeam = SubjectTeam;
+	Record.OtherTeam = OtherTeam;
+	Record.TimeMs = (uint32)FMath::Max(0, FMath::RoundToInt(GetWorld()->GetTimeSeconds() * 1000.0));
+	Record.SubjectId = SubjectId;
+	Record.OtherId = OtherId;
+	Record.Value = Value;
+	Record.Location = FVector3f(Location);
+
+	// never wait for the writer thread on the game thread
+	if (Writer->Enqueue(Record))
+	{
+		INC_DWORD_STAT(STAT_ShooterTelemetryQueued);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_ShooterTelemetryDropped);
+	}
+}
+
+void UShooterTelemetrySubsystem::RecordCombat(EShooterTelemetryType Type, const AController* Subject, const APawn* Other, float Value, const FVector& Location)
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	uint8 SubjectTeam = 255;
+	uint8 OtherTeam = 255;
+
+	if (const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		SubjectTeam = Combatants->GetTeamForController(Subject);
+
+		const int32 OtherIndex = Combatants->FindByPawn(Other);
+		if (OtherIndex != INDEX_NONE)
+		{
+			OtherTeam = Combatants->GetTeam(OtherIndex);
+		}
+	}
+
+	const int32 SubjectId = UShooterGameplayEventSubsystem::GetPlayerId(Subject);
+	const int32 OtherId = UShooterGameplayEventSubsystem::GetPlayerId(Other ? Other->GetController() : nullptr);
+
+	Record(Type, SubjectId, SubjectTeam, OtherId, OtherTeam, Value, Location);
+}
+
+void UShooterTelemetrySubsystem::RecordKill(const AController* Killer, const APawn* Victim)
+{
+	if (!Writer || !Victim)
+	{
+		return;
+	}
+
+	uint8 KillerTeam = 255;
+	uint8 VictimTeam = 255;
+
+	if (const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>())
+	{
+		KillerTeam = Combatants->GetTeamForController(Killer);
+
+		const int32 VictimIndex = Combatants->FindByPawn(Victim);
+		if (VictimIndex != INDEX_NONE)
+		{
+			VictimTeam = Combatants->GetTeam(VictimIndex);
+		}
+	}
+
+	const int32 KillerId = UShooterGameplayEventSubsystem::GetPlayerId(Killer);
+	const int32 VictimId = UShooterGameplayEventSubsystem::GetPlayerId(Victim->GetController());
+
+	const FVector VictimLocation = Victim->GetActorLocation();
+
+	// deaths without a killer (falling out of the world) only get the death record
+	if (Killer)
+	{
+		const APawn* KillerPawn = Killer->GetPawn();
+		Record(EShooterTelemetryType::Kill, KillerId, KillerTeam, VictimId, VictimTeam, 0.0f, KillerPawn ? KillerPawn->GetActorLocation() : VictimLocation);
+	}
+
+	Record(EShooterTelemetryType::Death, VictimId, VictimTeam, KillerId, KillerTeam, 0.0f, VictimLocation);
+}
+
+void UShooterTelemetrySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!Writer || ShooterTelemetry::PositionInterval <= 0.0f)
+	{
+		return;
+	}
+
+	PositionSampleTimer -= DeltaTime;
+	if (PositionSampleTimer <= 0.0f)
+	{
+		PositionSampleTimer += ShooterTelemetry::PositionInterval;
+
+		// don't try to catch up after a hitch
+		PositionSampleTimer = FMath::Max(PositionSampleTimer, 0.0f);
+
+		SamplePositions();
+	}
+}
+
+TStatId UShooterTelemetrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterTelemetrySubsystem, STATGROUP_Tickables);
+}
+
+void UShooterTelemetrySubsystem::SamplePositions()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterTelemetrySample);
+
+	const UShooterCombatantSubsystem* Combatants = GetWorld()->GetSubsystem<UShooterCombatantSubsystem>();
+	if (!Combatants)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Combatants->Num(); ++Index)
+	{
+		const APawn* Pawn = Combatants->GetPawn(Index);
+		if (!Pawn || !Combatants->IsAlive(Index))
+		{
+			continue;
+		}
+
+		Record(EShooterTelemetryType::Position, UShooterGameplayEventSubsystem::GetPlayerId(Combatants->GetController(Index)), Combatants->GetTeam(Index),
+			INDEX_NONE, 255, 0.0f, Pawn->GetActorLocation());
+	}
+}
@@ -0,0 +1,240 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HAL/Runnable.h"
+#include "Containers/CircularQueue.h"
+#include <atomic>
+#include "ShooterTelemetry.generated.h"
+
+class AController;
+class APawn;
+class FRunnableThread;
+class FEvent;
+
+/** 遥测记录类型 */
+enum class EShooterTelemetryType : uint8
+{
+	/** 击杀：Subject 是击杀者，Other 是被击杀者（玩家和 NPC），位置是击杀者的位置 */
+	Kill,
+
+	/** 死亡：Subject 是死亡的玩家或 NPC，Other 是击杀者（没有击杀者时为未知），位置是死亡位置 */
+	Death,
+
+	/** 伤害：Subject 造成伤害，Other 受到伤害，Value 是本帧实际扣除的生命值（被拒绝的伤害不记录），位置是受害者的位置 */
+	Damage,
+
+	/** 射击：Subject 开火，位置是投射物生成位置 */
+	Shot,
+
+	/** 位置采样：Subject 的位置（低频采样，包括 NPC） */
+	Position,
+
+	/** 得分：SubjectTeam 的得分变为 Value */
+	Score,
+
+	Num
+};
+
+/**
+ *  一条遥测记录
+ *  玩家以 PlayerId 标识（NPC 为 INDEX_NONE，通过团队区分），团队 255 表示未知
+ */
+struct FShooterTelemetryRecord
+{
+	/** EShooterTelemetryType */
+	uint8 Type = 0;
+
+	/** Subject 的团队 */
+	uint8 SubjectTeam = 255;
+
+	/** Other 的团队 */
+	uint8 OtherTeam = 255;
+
+	/** 世界时间（毫秒） */
+	uint32 TimeMs = 0;
+
+	/** 主体的 PlayerId */
+	int32 SubjectId = INDEX_NONE;
+
+	/** 另一方的 PlayerId */
+	int32 OtherId = INDEX_NONE;
+
+	/** 记录数值（含义见记录类型） */
+	float Value = 0.0f;
+
+	/** 记录位置 */
+	FVector3f Location = FVector3f::ZeroVector;
+};
+
+/**
+ *  遥测文件格式（小端）
+ *
+ *  文件头：
+ *    uint32 Magic = 'STLM'，uint32 Version，int64 开始时间（UTC ticks），FString 地图名
+ *
+ *  之后是任意数量的数据块，直到文件结束：
+ *    uint32 NumRecords，uint32 UncompressedSize，uint32 CompressedSize，uint8[CompressedSize] Zlib 压缩数据
+ *
+ *  解压后的数据块按列存储，每列 NumRecords 个值，列的顺序：
+ *    uint8 Type，uint8 SubjectTeam，uint8 OtherTeam，
+ *    uint32 TimeMs（与块内上一条记录的差值，第一条为绝对值），
+ *    int32 SubjectId，int32 OtherId，float Value，float X，float Y，float Z
+ *
+ *  同类数据相邻存放，压缩率远高于按行存储；每个数据块写完后立即刷新，进程崩溃时只丢失最后一个块
+ */
+namespace ShooterTelemetryFormat
+{
+	/** 文件头魔数 'STLM' */
+	constexpr uint32 FileMagic = 0x4D4C5453;
+
+	/** 文件格式版本 */
+	constexpr uint32 FileVersion = 1;
+
+	/** 单个数据块的最大记录数（读取时用于拒绝损坏的文件） */
+	constexpr uint32 MaxRecordsPerBlock = 65536;
+
+	/** 按列序列化一个数据块（读取时 Records 需要预先设置大小） */
+	FPSDEMO_API void SerializeColumns(FArchive& Ar, TArray<FShooterTelemetryRecord>& Records);
+}
+
+/**
+ *  遥测写入线程
+ *  游戏线程通过无锁的单生产者单消费者队列提交记录，后台线程按列打包、压缩并追加到文件
+ */
+class FPSDEMO_API FShooterTelemetryWriter : public FRunnable
+{
+public:
+
+	FShooterTelemetryWriter(const FString& InFilePath, const FString& InMapName, uint32 QueueCapacity, uint32 InRecordsPerBlock, float InFlushInterval);
+	virtual ~FShooterTelemetryWriter();
+
+	/** 启动写入线程 */
+	bool Start();
+
+	/** 请求停止，等待剩余的记录写完后关闭文件 */
+	void Shutdown();
+
+	/** 游戏线程：提交一条记录，队列已满时返回 false */
+	bool Enqueue(const FShooterTelemetryRecord& Record) { return Queue.Enqueue(Record); }
+
+	/** 返回输出文件路径 */
+	const FString& GetFilePath() const { return FilePath; }
+
+protected:
+
+	/** FRunnable interface */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	/** 写入文件头 */
+	void WriteHeader();
+
+	/** 把队列中的记录移到待写入列表，写满的数据块立即写出 */
+	void DrainQueue();
+
+	/** 压缩并写出待写入的记录 */
+	void WriteBlock();
+
+	/** 记录队列（游戏线程生产，写入线程消费） */
+	TCircularQueue<FShooterTelemetryRecord> Queue;
+
+	/** 输出文件 */
+	FString FilePath;
+
+	/** 地图名（写入文件头） */
+	FString MapName;
+
+	/** 每个数据块的记录数 */
+	uint32 RecordsPerBlock;
+
+	/** 未写满的数据块最长保留时间（秒） */
+	float FlushInterval;
+
+	/** 写入线程 */
+	FRunnableThread* Thread = nullptr;
+
+	/** 唤醒写入线程 */
+	FEvent* WakeEvent = nullptr;
+
+	/** 已请求停止 */
+	std::atomic<bool> bStopRequested { false };
+
+	/** 以下成员只在写入线程上访问 */
+	TUniquePtr<FArchive> Writer;
+	TArray<FShooterTelemetryRecord> PendingRecords;
+	TArray<uint8> ColumnBuffer;
+	TArray<uint8> CompressedBuffer;
+	double LastBlockTime = 0.0;
+	uint64 NumRecordsWritten = 0;
+	uint64 NumRawBytes = 0;
+	uint64 NumCompressedBytes = 0;
+};
+
+/**
+ *  比赛遥测子系统（服务器）
+ *  功能：
+ *  - 通过 Shooter.Telemetry.Enable 开启，世界开始时在 Saved/Telemetry 下为本场比赛创建一个文件
+ *  - 记录击杀、死亡、伤害、射击、得分和低频位置采样；游戏线程上只复制一条定长记录到无锁队列，不格式化也不做文件 IO
+ *  - 后台线程按列打包、Zlib 压缩后流式写入文件（格式见 ShooterTelemetryFormat）
+ *  - 由 ShooterTelemetryReader commandlet 离线读取，输出汇总或导出 CSV
+ */
+UCLASS()
+class FPSDEMO_API UShooterTelemetrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 返回遥测是否开启 */
+	static bool IsEnabled();
+
+	/** 提交一条记录（没有正在写入的文件时直接返回） */
+	void Record(EShooterTelemetryType Type, int32 SubjectId, uint8 SubjectTeam, int32 OtherId, uint8 OtherTeam, float Value, const FVector& Location);
+
+	/** 提交一条战斗记录，PlayerId 和团队从控制器、Pawn 和战斗者注册表读取 */
+	void RecordCombat(EShooterTelemetryType Type, const AController* Subject, const APawn* Other, float Value, const FVector& Location);
+
+	/** 提交一次击杀的击杀和死亡记录（角色和 NPC 的 Die 调用，Victim 此时仍被占有），双方的 PlayerId 和团队都写入 */
+	void RecordKill(const AController* Killer, const APawn* Victim);
+
+	/** 返回是否正在写入 */
+	bool IsRecording() const { return Writer.IsValid(); }
+
+	/** 结束当前文件并开始一个新文件 */
+	void Restart();
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Opens the telemetry file on the server */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Flushes and closes the telemetry file */
+	virtual void Deinitialize() override;
+
+	/** Samples the combatant positions */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 开始写入一个新文件 */
+	void StartWriter();
+
+	/** 结束写入 */
+	void StopWriter();
+
+	/** 采样所有存活战斗者的位置 */
+	void SamplePositions();
+
+	/** 写入线程 */
+	TUniquePtr<FShooterTelemetryWriter> Writer;
+
+	/** 距离下一次位置采样的时间 */
+	float PositionSampleTimer = 0.0f;
+};
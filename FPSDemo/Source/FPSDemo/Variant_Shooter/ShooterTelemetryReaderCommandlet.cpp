@@ -0,0 +1,253 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterTelemetryReaderCommandlet.h"
+#include "ShooterTelemetry.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Serialization/MemoryReader.h"
+#include "FPSDemo.h"
+
+namespace ShooterTelemetryReader
+{
+	/** Size of one record in an uncompressed block: three byte columns and seven four byte columns */
+	static constexpr uint32 BytesPerRecord = 3 * sizeof(uint8) + 7 * sizeof(uint32);
+
+	static const TCHAR* TypeNames[(int32)EShooterTelemetryType::Num] =
+	{
+		TEXT("Kill"), TEXT("Death"), TEXT("Damage"), TEXT("Shot"), TEXT("Position"), TEXT("Score")
+	};
+
+	/** Combat totals of one player or team */
+	struct FCombatTotals
+	{
+		int32 Kills = 0;
+		int32 Deaths = 0;
+		int32 Shots = 0;
+		int32 Hits = 0;
+		double DamageDealt = 0.0;
+		double DamageTaken = 0.0;
+		int32 PositionSamples = 0;
+	};
+
+	/** Formats a world time in milliseconds as mm:ss.mmm */
+	static FString FormatTime(uint32 TimeMs)
+	{
+		return FString::Printf(TEXT("%02u:%02u.%03u"), TimeMs / 60000, (TimeMs / 1000) % 60, TimeMs % 1000);
+	}
+
+	/** Logs a table of combat totals */
+	static void LogTotals(const TCHAR* Label, const TMap<int32, FCombatTotals>& Totals)
+	{
+		UE_LOG(LogFPSDemo, Display, TEXT("%s:"), Label);
+
+		TArray<int32> Keys;
+		Totals.GetKeys(Keys);
+		Keys.Sort();
+
+		for (int32 Key : Keys)
+		{
+			const FCombatTotals& Entry = Totals[Key];
+			const float HitRate = Entry.Shots > 0 ? 100.0f * Entry.Hits / Entry.Shots : 0.0f;
+
+			UE_LOG(LogFPSDemo, Display, TEXT("  %-6d kills=%-5d deaths=%-5d shots=%-7d damage events=%-6d (%5.1f%% of shots) dealt=%9.1f taken=%9.1f samples=%d"),
+				Key, Entry.Kills, Entry.Deaths, Entry.Shots, Entry.Hits, HitRate, Entry.DamageDealt, Entry.DamageTaken, Entry.PositionSamples);
+		}
+	}
+}
+
+UShooterTelemetryReaderCommandlet::UShooterTelemetryReaderCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UShooterTelemetryReaderCommandlet::Main(const FString& Params)
+{
+	using namespace ShooterTelemetryReader;
+
+	FString FilePath;
+	if (!FParse::Value(*Params, TEXT("file="), FilePath))
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Usage: -run=ShooterTelemetryReader -file=<Match.stlm> [-csv=<Output.csv>]"));
+		return 1;
+	}
+
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("csv="), CsvPath);
+
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not open %s."), *FilePath);
+		return 1;
+	}
+
+	// validate the header
+	uint32 Magic = 0, Version = 0;
+	int64 StartTicks = 0;
+	FString MapName;
+	*Reader << Magic << Version;
+
+	if (Magic != ShooterTelemetryFormat::FileMagic || Version != ShooterTelemetryFormat::FileVersion)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("%s is not a version %u telemetry file."), *FilePath, ShooterTelemetryFormat::FileVersion);
+		return 1;
+	}
+
+	*Reader << StartTicks << MapName;
+
+	TMap<int32, FCombatTotals> PlayerTotals;
+	TMap<int32, FCombatTotals> TeamTotals;
+	TArray<FShooterTelemetryRecord> ScoreTimeline;
+	int32 TypeCounts[(int32)EShooterTelemetryType::Num] = {};
+	uint64 NumRecords = 0;
+	uint64 NumRawBytes = 0;
+	uint64 NumCompressedBytes = 0;
+	uint32 NumBlocks = 0;
+	uint32 LastTimeMs = 0;
+
+	TArray<uint8> CompressedBuffer;
+	TArray<uint8> ColumnBuffer;
+	TArray<FShooterTelemetryRecord> Records;
+
+	TArray<FString> CsvLines;
+	if (!CsvPath.IsEmpty())
+	{
+		CsvLines.Add(TEXT("Type,TimeMs,SubjectId,SubjectTeam,OtherId,OtherTeam,Value,X,Y,Z"));
+	}
+
+	// a file cut off mid block (e.g. a crashed server) still yields every complete block
+	while (Reader->Tell() + 3 * (int64)sizeof(uint32) <= Reader->TotalSize())
+	{
+		uint32 BlockRecords = 0, RawSize = 0, BlockSize = 0;
+		*Reader << BlockRecords << RawSize << BlockSize;
+
+		if (BlockRecords == 0 || BlockRecords > ShooterTelemetryFormat::MaxRecordsPerBlock || RawSize != BlockRecords * BytesPerRecord)
+		{
+			UE_LOG(LogFPSDemo, Error, TEXT("Block %u is corrupt, stopping."), NumBlocks);
+			break;
+		}
+
+		if (Reader->Tell() + (int64)BlockSize > Reader->TotalSize())
+		{
+			UE_LOG(LogFPSDemo, Warning, TEXT("Block %u is truncated, stopping."), NumBlocks);
+			break;
+		}
+
+		CompressedBuffer.SetNumUninitialized(BlockSize);
+		Reader->Serialize(CompressedBuffer.GetData(), BlockSize);
+
+		ColumnBuffer.SetNumUninitialized(RawSize);
+		if (!FCompression::UncompressMemory(NAME_Zlib, ColumnBuffer.GetData(), RawSize, CompressedBuffer.GetData(), BlockSize))
+		{
+			UE_LOG(LogFPSDemo, Error, TEXT("Could not decompress block %u, stopping."), NumBlocks);
+			break;
+		}
+
+		Records.SetNum(BlockRecords);
+		FMemoryReader ColumnReader(ColumnBuffer);
+		ShooterTelemetryFormat::SerializeColumns(ColumnReader, Records);
+
+		++NumBlocks;
+		NumRecords += BlockRecords;
+		NumRawBytes += RawSize;
+		NumCompressedBytes += BlockSize;
+
+		for (const FShooterTelemetryRecord& Record : Records)
+		{
+			if (Record.Type >= (uint8)EShooterTelemetryType::Num)
+			{
+				continue;
+			}
+
+			++TypeCounts[Record.Type];
+			LastTimeMs = FMath::Max(LastTimeMs, Record.TimeMs);
+
+			switch ((EShooterTelemetryType)Record.Type)
+			{
+			case EShooterTelemetryType::Kill:
+				++PlayerTotals.FindOrAdd(Record.SubjectId).Kills;
+				++TeamTotals.FindOrAdd(Record.SubjectTeam).Kills;
+				break;
+
+			case EShooterTelemetryType::Death:
+				++PlayerTotals.FindOrAdd(Record.SubjectId).Deaths;
+				++TeamTotals.FindOrAdd(Record.SubjectTeam).Deaths;
+				break;
+
+			case EShooterTelemetryType::Damage:
+				++PlayerTotals.FindOrAdd(Record.SubjectId).Hits;
+				PlayerTotals.FindOrAdd(Record.SubjectId).DamageDealt += Record.Value;
+				PlayerTotals.FindOrAdd(Record.OtherId).DamageTaken += Record.Value;
+				++TeamTotals.FindOrAdd(Record.SubjectTeam).Hits;
+				TeamTotals.FindOrAdd(Record.SubjectTeam).DamageDealt += Record.Value;
+				TeamTotals.FindOrAdd(Record.OtherTeam).DamageTaken += Record.Value;
+				break;
+
+			case EShooterTelemetryType::Shot:
+				++PlayerTotals.FindOrAdd(Record.SubjectId).Shots;
+				++TeamTotals.FindOrAdd(Record.SubjectTeam).Shots;
+				break;
+
+			case EShooterTelemetryType::Position:
+				++PlayerTotals.FindOrAdd(Record.SubjectId).PositionSamples;
+				++TeamTotals.FindOrAdd(Record.SubjectTeam).PositionSamples;
+				break;
+
+			case EShooterTelemetryType::Score:
+				ScoreTimeline.Add(Record);
+				break;
+
+			default:
+				break;
+			}
+
+			if (!CsvPath.IsEmpty())
+			{
+				CsvLines.Add(FString::Printf(TEXT("%s,%u,%d,%d,%d,%d,%.2f,%.1f,%.1f,%.1f"),
+					TypeNames[Record.Type], Record.TimeMs, Record.SubjectId, Record.SubjectTeam, Record.OtherId, Record.OtherTeam,
+					Record.Value, Record.Location.X, Record.Location.Y, Record.Location.Z));
+			}
+		}
+	}
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Telemetry %s: map %s, started %s UTC, %s of match time"),
+		*FilePath, *MapName, *FDateTime(StartTicks).ToString(), *FormatTime(LastTimeMs));
+
+	UE_LOG(LogFPSDemo, Display, TEXT("%llu records in %u blocks, %llu bytes raw, %llu bytes compressed (%.1fx)"),
+		NumRecords, NumBlocks, NumRawBytes, NumCompressedBytes, NumCompressedBytes > 0 ? (double)NumRawBytes / NumCompressedBytes : 0.0);
+
+	for (int32 Type = 0; Type < (int32)EShooterTelemetryType::Num; ++Type)
+	{
+		UE_LOG(LogFPSDemo, Display, TEXT("  %-10s %d"), TypeNames[Type], TypeCounts[Type]);
+	}
+
+	// NPCs are grouped under INDEX_NONE
+	LogTotals(TEXT("Players (by PlayerId, -1 = NPCs)"), PlayerTotals);
+	LogTotals(TEXT("Teams (255 = unknown)"), TeamTotals);
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Score timeline:"));
+	for (const FShooterTelemetryRecord& Record : ScoreTimeline)
+	{
+		UE_LOG(LogFPSDemo, Display, TEXT("  %s team %d -> %d"), *FormatTime(Record.TimeMs), Record.SubjectTeam, FMath::RoundToInt(Record.Value));
+	}
+
+	if (!CsvPath.IsEmpty())
+	{
+		if (!FFileHelper::SaveStringArrayToFile(CsvLines, *CsvPath))
+		{
+			UE_LOG(LogFPSDemo, Error, TEXT("Could not write %s."), *CsvPath);
+			return 1;
+		}
+
+		UE_LOG(LogFPSDemo, Display, TEXT("Wrote %d rows to %s."), CsvLines.Num() - 1, *CsvPath);
+	}
+
+	return 0;
+}
@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterTelemetryReaderCommandlet.generated.h"
+
+/**
+ *  比赛遥测离线读取工具
+ *  用法：UnrealEditor-Cmd FPSDemo -run=ShooterTelemetryReader -file=<Match.stlm> [-csv=<Output.csv>]
+ *  输出各类记录数量、压缩率、每个玩家和团队的战斗统计以及得分时间线，-csv 把所有记录按行导出
+ */
+UCLASS()
+class UShooterTelemetryReaderCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UShooterTelemetryReaderCommandlet();
+
+	/** Reads the telemetry file */
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,182 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterTimerBenchmark.h"
+#include "TimerManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "FPSDemo.h"
+
+#if !UE_BUILD_SHIPPING
+namespace ShooterTimers
+{
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("Shooter.Timers.Benchmark"),
+		TEXT("Shooter.Timers.Benchmark [NumTimers=10000] [Seconds=5]. Compares insert, cancel and per frame advance costs of the timer wheel against FTimerManager with the given number of live looping timers."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const int32 NumTimers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000;
+			const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 5.0f;
+
+			UShooterTimerBenchmark::Run(World, FMath::Max(NumTimers, 1), FMath::Max(Duration, 0.1f));
+		}));
+}
+#endif
+
+UShooterTimerBenchmark::UShooterTimerBenchmark()
+{
+}
+
+// defined here so the control timer manager can be destroyed with the full type
+UShooterTimerBenchmark::~UShooterTimerBenchmark() = default;
+
+void UShooterTimerBenchmark::Run(UWorld* World, int32 NumTimers, float Duration)
+{
+	if (!UShooterTimerSubsystem::Find(World))
+	{
+		UE_LOG(LogFPSDemo, Warning, TEXT("Shooter.Timers.Benchmark needs a game world"));
+		return;
+	}
+
+	// kept alive by the root set until it finishes
+	UShooterTimerBenchmark* Benchmark = NewObject<UShooterTimerBenchmark>(GetTransientPackage());
+	Benchmark->AddToRoot();
+	Benchmark->Start(World, NumTimers, Duration);
+}
+
+void UShooterTimerBenchmark::Start(UWorld* InWorld, int32 NumTimers, float Duration)
+{
+	UShooterTimerSubsystem* TimerSubsystem = UShooterTimerSubsystem::Find(InWorld);
+
+	World = InWorld;
+	TimerManager = MakeUnique<FTimerManager>();
+
+	WheelHandles.SetNum(NumTimers);
+	TimerManagerHandles.SetNum(NumTimers);
+
+	// both sides get the same delays
+	TArray<float> Delays;
+	Delays.SetNumUninitialized(NumTimers);
+
+	FRandomStream RandomStream(NumTimers);
+	for (float& Delay : Delays)
+	{
+		Delay = RandomStream.FRandRange(0.1f, 10.0f);
+	}
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumTimers; ++Index)
+	{
+		TimerSubsystem->SetTimer(WheelHandles[Index], this, &UShooterTimerBenchmark::OnBenchmarkTimer, Delays[Index], true);
+	}
+	const double WheelInsertSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumTimers; ++Index)
+	{
+		TimerManager->SetTimer(TimerManagerHandles[Index], this, &UShooterTimerBenchmark::OnBenchmarkTimer, Delays[Index], true);
+	}
+	const double TimerManagerInsertSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// cancel and re-set every other timer, like refire and respawn timers do
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumTimers; Index += 2)
+	{
+		TimerSubsystem->ClearTimer(WheelHandles[Index]);
+		TimerSubsystem->SetTimer(WheelHandles[Index], this, &UShooterTimerBenchmark::OnBenchmarkTimer, Delays[Index], true);
+	}
+	const double WheelResetSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumTimers; Index += 2)
+	{
+		TimerManager->ClearTimer(TimerManagerHandles[Index]);
+		TimerManager->SetTimer(TimerManagerHandles[Index], this, &UShooterTimerBenchmark::OnBenchmarkTimer, Delays[Index], true);
+	}
+	const double TimerManagerResetSeconds = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Timer benchmark, %d looping timers"), NumTimers);
+	UE_LOG(LogFPSDemo, Display, TEXT("  insert          wheel %8.3f ms   FTimerManager %8.3f ms"), WheelInsertSeconds * 1000.0, TimerManagerInsertSeconds * 1000.0);
+	UE_LOG(LogFPSDemo, Display, TEXT("  cancel + reset  wheel %8.3f ms   FTimerManager %8.3f ms"), WheelResetSeconds * 1000.0, TimerManagerResetSeconds * 1000.0);
+
+	// the per frame costs are measured in Tick over the next few seconds
+	TimeLeft = Duration;
+}
+
+void UShooterTimerBenchmark::Tick(float DeltaTime)
+{
+	const UShooterTimerSubsystem* TimerSubsystem = UShooterTimerSubsystem::Find(World.Get());
+	if (!TimerSubsystem)
+	{
+		// the world went away mid run
+		Finish();
+		return;
+	}
+
+	// the wheel advances in its own tick, FTimerManager is advanced here alongside the world
+	WheelSeconds += TimerSubsystem->GetLastTickSeconds();
+
+	const double StartTime = FPlatformTime::Seconds();
+	TimerManager->Tick(DeltaTime);
+	TimerManagerSeconds += FPlatformTime::Seconds() - StartTime;
+
+	++Frames;
+
+	TimeLeft -= DeltaTime;
+	if (TimeLeft > 0.0f)
+	{
+		return;
+	}
+
+	UE_LOG(LogFPSDemo, Display, TEXT("  advance         wheel %8.3f ms   FTimerManager %8.3f ms   per frame over %d frames, %d callbacks"),
+		WheelSeconds * 1000.0 / Frames,
+		TimerManagerSeconds * 1000.0 / Frames,
+		Frames, Fired);
+
+	Finish();
+}
+
+ETickableTickType UShooterTimerBenchmark::GetTickableTickType() const
+{
+	// the class default object never runs a benchmark
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterTimerBenchmark::IsTickable() const
+{
+	return TimerManager.IsValid();
+}
+
+UWorld* UShooterTimerBenchmark::GetTickableGameObjectWorld() const
+{
+	return World.Get();
+}
+
+TStatId UShooterTimerBenchmark::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterTimerBenchmark, STATGROUP_Tickables);
+}
+
+void UShooterTimerBenchmark::Finish()
+{
+	if (UShooterTimerSubsystem* TimerSubsystem = UShooterTimerSubsystem::Find(World.Get()))
+	{
+		for (FShooterTimerHandle& Handle : WheelHandles)
+		{
+			TimerSubsystem->ClearTimer(Handle);
+		}
+	}
+
+	WheelHandles.Empty();
+	TimerManagerHandles.Empty();
+	TimerManager.Reset();
+
+	RemoveFromRoot();
+}
+
+void UShooterTimerBenchmark::OnBenchmarkTimer()
+{
+	++Fired;
+}
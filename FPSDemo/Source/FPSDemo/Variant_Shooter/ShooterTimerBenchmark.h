@@ -0,0 +1,72 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Tickable.h"
+#include "ShooterTimerSubsystem.h"
+#include "ShooterTimerBenchmark.generated.h"
+
+/**
+ *  定时器基准测试（开发工具，Shipping 不注册控制台命令）
+ *  功能：
+ *  - Shooter.Timers.Benchmark 插入 NumTimers 个循环定时器，对比时间轮和 FTimerManager 的插入、取消和每帧推进开销
+ *  - 对照组使用独立的 FTimerManager，与世界一起逐帧推进
+ *  - 时间轮的每帧耗时取自 UShooterTimerSubsystem::GetLastTickSeconds
+ *  - 运行期间加入根集，结束后自行释放，生产子系统中不保留任何基准测试状态
+ */
+UCLASS(Transient)
+class FPSDEMO_API UShooterTimerBenchmark : public UObject, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UShooterTimerBenchmark();
+	virtual ~UShooterTimerBenchmark();
+
+	/** 在世界中开始一次基准测试：插入 NumTimers 个循环定时器，在接下来 Duration 秒内与 FTimerManager 对比 */
+	static void Run(UWorld* World, int32 NumTimers, float Duration);
+
+	/** Advances the control timer manager and reports once the duration is over */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Only ticks while a benchmark is running */
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+
+	/** Ticks with the benchmarked world */
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	/** 插入并重置两边的定时器，输出插入和取消的耗时 */
+	void Start(UWorld* InWorld, int32 NumTimers, float Duration);
+
+	/** 清除两边的定时器并释放自己 */
+	void Finish();
+
+	/** 定时器回调 */
+	void OnBenchmarkTimer();
+
+	/** 被测世界 */
+	TWeakObjectPtr<UWorld> World;
+
+	/** 对照组的独立 FTimerManager */
+	TUniquePtr<FTimerManager> TimerManager;
+
+	/** 两边的定时器句柄 */
+	TArray<FShooterTimerHandle> WheelHandles;
+	TArray<FTimerHandle> TimerManagerHandles;
+
+	/** 剩余时间、累计耗时和帧数 */
+	float TimeLeft = 0.0f;
+	double WheelSeconds = 0.0;
+	double TimerManagerSeconds = 0.0;
+	int32 Frames = 0;
+	int32 Fired = 0;
+};
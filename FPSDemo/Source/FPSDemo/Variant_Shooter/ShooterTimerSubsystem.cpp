@@ -0,0 +1,355 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterTimerSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "FPSDemo.h"
+
+DECLARE_CYCLE_STAT(TEXT("Timer Wheel Advance"), STAT_ShooterTimerWheelAdvance, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Timer Wheel Dispatch"), STAT_ShooterTimerWheelDispatch, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Timer Wheel Active Timers"), STAT_ShooterTimerWheelActive, STATGROUP_Shooter);
+
+UShooterTimerSubsystem::UShooterTimerSubsystem()
+{
+	for (int32& SlotHead : SlotHeads)
+	{
+		SlotHead = INDEX_NONE;
+	}
+}
+
+void UShooterTimerSubsystem::ClearWorldTimer(const UObject* WorldContextObject, FShooterTimerHandle& InOutHandle)
+{
+	if (UShooterTimerSubsystem* TimerSubsystem = Find(WorldContextObject))
+	{
+		TimerSubsystem->ClearTimer(InOutHandle);
+	}
+	else
+	{
+		InOutHandle.Invalidate();
+	}
+
+	if (InOutHandle.FallbackHandle.IsValid())
+	{
+		if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+		{
+			World->GetTimerManager().ClearTimer(InOutHandle.FallbackHandle);
+		}
+
+		InOutHandle.FallbackHandle.Invalidate();
+	}
+}
+
+UShooterTimerSubsystem* UShooterTimerSubsystem::Find(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterTimerSubsystem>() : nullptr;
+}
+
+void UShooterTimerSubsystem::SetFallbackTimer(const UObject* WorldContextObject, FShooterTimerHandle& InOutHandle, const FTimerDelegate& Delegate, float Rate, bool bLoop)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogFPSDemo, Warning, TEXT("Timer for %s dropped, it is not in a world"), *GetNameSafe(WorldContextObject));
+		return;
+	}
+
+	// FTimerManager clears the handle first, and only clears it when Rate <= 0, same as the wheel
+	World->GetTimerManager().SetTimer(InOutHandle.FallbackHandle, Delegate, Rate, bLoop);
+}
+
+bool UShooterTimerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterTimerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const uint64 TargetTick = GetWorldTick();
+
+	if (NumActiveTimers == 0)
+	{
+		// nothing to cascade or expire, so skip straight to the current time
+		CurrentTick = FMath::Max(CurrentTick, TargetTick);
+	}
+	else
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ShooterTimerWheelAdvance);
+
+		while (CurrentTick < TargetTick)
+		{
+			AdvanceOneTick();
+		}
+	}
+
+	if (ExpiredTimers.Num() > 0)
+	{
+		DispatchExpiredTimers();
+	}
+
+	SET_DWORD_STAT(STAT_ShooterTimerWheelActive, NumActiveTimers);
+
+	LastTickSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+TStatId UShooterTimerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterTimerSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterTimerSubsystem::ClearTimer(FShooterTimerHandle& InOutHandle)
+{
+	if (const FShooterTimer* Timer = FindTimer(InOutHandle))
+	{
+		// expired timers waiting for dispatch are already out of the wheel
+		if (Timer->Slot != INDEX_NONE)
+		{
+			UnlinkTimer(InOutHandle.Index);
+		}
+
+		FreeTimer(InOutHandle.Index);
+	}
+
+	InOutHandle.Invalidate();
+}
+
+bool UShooterTimerSubsystem::IsTimerActive(const FShooterTimerHandle& Handle) const
+{
+	return FindTimer(Handle) != nullptr;
+}
+
+float UShooterTimerSubsystem::GetTimerRemaining(const FShooterTimerHandle& Handle) const
+{
+	const FShooterTimer* Timer = FindTimer(Handle);
+	if (!Timer)
+	{
+		return -1.0f;
+	}
+
+	return FMath::Max(0.0f, float(Timer->ExpireTick / ShooterTimers::TicksPerSecond - GetWorld()->GetTimeSeconds()));
+}
+
+FShooterTimer& UShooterTimerSubsystem::AllocateTimer(FShooterTimerHandle& OutHandle)
+{
+	int32 Index = FirstFreeTimer;
+	if (Index != INDEX_NONE)
+	{
+		FirstFreeTimer = Timers[Index].Next;
+	}
+	else
+	{
+		Index = Timers.AddDefaulted();
+	}
+
+	FShooterTimer& Timer = Timers[Index];
+	Timer.Serial = NextSerial;
+	Timer.Slot = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+
+	// 0 marks free timers and unset handles
+	if (++NextSerial == 0)
+	{
+		NextSerial = 1;
+	}
+
+	OutHandle.Index = Index;
+	OutHandle.Serial = Timer.Serial;
+
+	++NumActiveTimers;
+
+	return Timer;
+}
+
+void UShooterTimerSubsystem::FreeTimer(int32 Index)
+{
+	FShooterTimer& Timer = Timers[Index];
+	Timer.Object.Reset();
+	Timer.Invoke = nullptr;
+	Timer.Serial = 0;
+	Timer.Slot = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = FirstFreeTimer;
+
+	FirstFreeTimer = Index;
+
+	--NumActiveTimers;
+}
+
+const FShooterTimer* UShooterTimerSubsystem::FindTimer(const FShooterTimerHandle& Handle) const
+{
+	if (!Handle.IsValid() || !Timers.IsValidIndex(Handle.Index))
+	{
+		return nullptr;
+	}
+
+	const FShooterTimer& Timer = Timers[Handle.Index];
+	return Timer.Serial == Handle.Serial ? &Timer : nullptr;
+}
+
+void UShooterTimerSubsystem::ScheduleTimer(int32 Index, float Rate, bool bLoop)
+{
+	FShooterTimer& Timer = Timers[Index];
+
+	// measure the delay from the world time, not the wheel, which only catches up at the end of the frame
+	const uint64 DeadlineTick = uint64(FMath::RoundToDouble((GetWorld()->GetTimeSeconds() + Rate) * ShooterTimers::TicksPerSecond));
+	Timer.ExpireTick = FMath::Clamp(DeadlineTick, CurrentTick + 1, CurrentTick + ShooterTimers::MaxDelayTicks);
+	Timer.IntervalTicks = bLoop ? FMath::Max<uint64>(1, uint64(FMath::RoundToDouble(Rate * ShooterTimers::TicksPerSecond))) : 0;
+
+	InsertTimer(Index);
+}
+
+void UShooterTimerSubsystem::InsertTimer(int32 Index)
+{
+	using namespace ShooterTimers;
+
+	FShooterTimer& Timer = Timers[Index];
+
+	// the level is picked by how far away the deadline is. Timers due this tick (while cascading) land in the slot about to be collected
+	const uint64 Delta = Timer.ExpireTick > CurrentTick ? Timer.ExpireTick - CurrentTick : 0;
+
+	int32 Level = 0;
+	while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+
+	const int32 Slot = Level * SlotsPerLevel + int32((Timer.ExpireTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+
+	Timer.Slot = Slot;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = SlotHeads[Slot];
+
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Prev = Index;
+	}
+
+	SlotHeads[Slot] = Index;
+}
+
+void UShooterTimerSubsystem::UnlinkTimer(int32 Index)
+{
+	FShooterTimer& Timer = Timers[Index];
+
+	if (Timer.Prev != INDEX_NONE)
+	{
+		Timers[Timer.Prev].Next = Timer.Next;
+	}
+	else
+	{
+		SlotHeads[Timer.Slot] = Timer.Next;
+	}
+
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Prev = Timer.Prev;
+	}
+
+	Timer.Slot = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+}
+
+void UShooterTimerSubsystem::AdvanceOneTick()
+{
+	using namespace ShooterTimers;
+
+	++CurrentTick;
+
+	// when a lower level wraps, the matching slot of the level above is spread over the levels below it
+	for (int32 Level = NumLevels - 1; Level > 0; --Level)
+	{
+		if ((CurrentTick & ((uint64(1) << (SlotBits * Level)) - 1)) != 0)
+		{
+			continue;
+		}
+
+		const int32 Slot = Level * SlotsPerLevel + int32((CurrentTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+
+		int32 Index = SlotHeads[Slot];
+		SlotHeads[Slot] = INDEX_NONE;
+
+		while (Index != INDEX_NONE)
+		{
+			const int32 Next = Timers[Index].Next;
+			InsertTimer(Index);
+			Index = Next;
+		}
+	}
+
+	// everything in the current level 0 slot is due
+	const int32 Slot = int32(CurrentTick & (SlotsPerLevel - 1));
+
+	int32 Index = SlotHeads[Slot];
+	SlotHeads[Slot] = INDEX_NONE;
+
+	while (Index != INDEX_NONE)
+	{
+		FShooterTimer& Timer = Timers[Index];
+		const int32 Next = Timer.Next;
+
+		Timer.Slot = INDEX_NONE;
+		Timer.Prev = INDEX_NONE;
+		Timer.Next = INDEX_NONE;
+
+		FShooterTimerHandle& Expired = ExpiredTimers.AddDefaulted_GetRef();
+		Expired.Index = Index;
+		Expired.Serial = Timer.Serial;
+
+		Index = Next;
+	}
+}
+
+void UShooterTimerSubsystem::DispatchExpiredTimers()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterTimerWheelDispatch);
+
+	// callbacks only set and clear timers. Nothing expires until the next advance, so the list is stable
+	for (int32 ExpiredIndex = 0; ExpiredIndex < ExpiredTimers.Num(); ++ExpiredIndex)
+	{
+		const FShooterTimerHandle Handle = ExpiredTimers[ExpiredIndex];
+
+		// an earlier callback in this batch may have cleared it
+		if (!FindTimer(Handle))
+		{
+			continue;
+		}
+
+		// copy the callback out, the pool may grow while it runs
+		FShooterTimer& Timer = Timers[Handle.Index];
+		UObject* Object = Timer.Object.Get();
+		const FShooterTimer::FInvokeFunction Invoke = Timer.Invoke;
+
+		alignas(void*) uint8 Method[sizeof(Timer.Method)];
+		FMemory::Memcpy(Method, Timer.Method, sizeof(Method));
+
+		// reschedule or free first, so the callback can clear or set the same handle
+		if (Timer.IntervalTicks > 0 && Object)
+		{
+			// skip missed calls after a hitch rather than firing them back to back
+			Timer.ExpireTick = FMath::Max(Timer.ExpireTick + Timer.IntervalTicks, CurrentTick + 1);
+			InsertTimer(Handle.Index);
+		}
+		else
+		{
+			FreeTimer(Handle.Index);
+		}
+
+		if (Object)
+		{
+			Invoke(Object, Method);
+		}
+	}
+
+	ExpiredTimers.Reset();
+}
+
+uint64 UShooterTimerSubsystem::GetWorldTick() const
+{
+	return uint64(GetWorld()->GetTimeSeconds() * ShooterTimers::TicksPerSecond);
+}
@@ -0,0 +1,240 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/TimerHandle.h"
+#include "TimerManager.h"
+#include "ShooterTimerSubsystem.generated.h"
+
+namespace ShooterTimers
+{
+	/** 时间轮层数 */
+	constexpr int32 NumLevels = 5;
+
+	/** 每层槽位数的位数 */
+	constexpr int32 SlotBits = 6;
+
+	/** 每层槽位数 */
+	constexpr int32 SlotsPerLevel = 1 << SlotBits;
+
+	/** 每秒的时间轮刻度数（定时器精度 1 毫秒） */
+	constexpr double TicksPerSecond = 1000.0;
+
+	/** 可表示的最大延迟（刻度数，约 12 天） */
+	constexpr uint64 MaxDelayTicks = (uint64(1) << (SlotBits * NumLevels)) - 1;
+}
+
+/**
+ *  游戏定时器句柄
+ *  只包含定时器池下标和序列号，复制和存储都不分配内存
+ *  定时器触发（非循环）或被清除后，旧句柄的序列号不再匹配，自动失效
+ *  世界没有定时器子系统时，SetWorldTimer 改用 FTimerManager，句柄记录在 FallbackHandle
+ */
+struct FShooterTimerHandle
+{
+	/** 定时器池下标 */
+	int32 Index = INDEX_NONE;
+
+	/** 序列号（0 表示无效） */
+	uint32 Serial = 0;
+
+	/** 回退到 FTimerManager 时的句柄 */
+	FTimerHandle FallbackHandle;
+
+	/** 返回句柄是否曾被设置过（不代表定时器仍然活跃） */
+	bool IsValid() const { return Serial != 0; }
+
+	/** 清空句柄 */
+	void Invalidate() { Index = INDEX_NONE; Serial = 0; }
+};
+
+/** 定时器池中的一个定时器 */
+struct FShooterTimer
+{
+	/** 调用成员函数的函数指针，由 SetTimer 为每个类和方法类型实例化 */
+	using FInvokeFunction = void (*)(UObject* Object, const uint8* Method);
+
+	/** 回调对象（销毁后定时器静默丢弃） */
+	TWeakObjectPtr<UObject> Object;
+
+	/** 回调调用函数 */
+	FInvokeFunction Invoke = nullptr;
+
+	/** 按值保存的成员函数指针 */
+	alignas(void*) uint8 Method[16];
+
+	/** 到期的时间轮刻度 */
+	uint64 ExpireTick = 0;
+
+	/** 循环间隔（刻度数，0 = 只触发一次） */
+	uint64 IntervalTicks = 0;
+
+	/** 序列号（0 = 空闲） */
+	uint32 Serial = 0;
+
+	/** 所在槽位（INDEX_NONE = 不在时间轮中） */
+	int32 Slot = INDEX_NONE;
+
+	/** 槽位链表（空闲时 Next 用作空闲链表） */
+	int32 Prev = INDEX_NONE;
+	int32 Next = INDEX_NONE;
+};
+
+/**
+ *  分层时间轮游戏定时器子系统
+ *  功能：
+ *  - 5 层 x 64 槽的分层时间轮，插入和取消都是 O(1)（双向链表，不排序）
+ *  - 定时器存放在复用的池中，句柄和回调（成员函数指针按值保存）都不分配内存
+ *  - 每帧推进时间轮，高层槽位到期时下沉到低层，到期的定时器先收集再批量派发
+ *  - 使用世界时间（遵循暂停和时间膨胀），与 FTimerManager 行为一致
+ *  - SetWorldTimer / ClearWorldTimer 在没有子系统的世界中回退到 FTimerManager，定时器不会被静默丢弃
+ *  - 与 FTimerManager 的性能对比见 UShooterTimerBenchmark（Shooter.Timers.Benchmark）
+ */
+UCLASS()
+class FPSDEMO_API UShooterTimerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UShooterTimerSubsystem();
+
+	/**
+	 *  在对象所在世界设置定时器：有定时器子系统时用时间轮，否则回退到世界的 FTimerManager
+	 *  参数同 SetTimer
+	 */
+	template<class UserClass>
+	static void SetWorldTimer(FShooterTimerHandle& InOutHandle, UserClass* Object, void (UserClass::*Method)(), float Rate, bool bLoop = false)
+	{
+		if (UShooterTimerSubsystem* TimerSubsystem = Find(Object))
+		{
+			TimerSubsystem->SetTimer(InOutHandle, Object, Method, Rate, bLoop);
+		}
+		else if (Object)
+		{
+			SetFallbackTimer(Object, InOutHandle, FTimerDelegate::CreateUObject(Object, Method), Rate, bLoop);
+		}
+	}
+
+	/** 清除 SetWorldTimer 设置的定时器（时间轮和回退的 FTimerManager 两边） */
+	static void ClearWorldTimer(const UObject* WorldContextObject, FShooterTimerHandle& InOutHandle);
+
+	/** 返回对象所在世界的定时器子系统，没有时返回 nullptr */
+	static UShooterTimerSubsystem* Find(const UObject* WorldContextObject);
+
+	/**
+	 *  设置定时器。句柄上已有的定时器会先被清除，Rate <= 0 时只清除
+	 *  @param InOutHandle	定时器句柄
+	 *  @param Object		回调对象
+	 *  @param Method		回调成员函数
+	 *  @param Rate			延迟（秒），循环时也是间隔
+	 *  @param bLoop		是否循环
+	 */
+	template<class UserClass>
+	void SetTimer(FShooterTimerHandle& InOutHandle, UserClass* Object, void (UserClass::*Method)(), float Rate, bool bLoop = false)
+	{
+		using FMethod = void (UserClass::*)();
+		static_assert(sizeof(FMethod) <= sizeof(FShooterTimer::Method), "Member function pointer doesn't fit the timer storage");
+
+		ClearTimer(InOutHandle);
+
+		if (!Object || Rate <= 0.0f)
+		{
+			return;
+		}
+
+		FShooterTimer& Timer = AllocateTimer(InOutHandle);
+		Timer.Object = Object;
+		Timer.Invoke = [](UObject* InObject, const uint8* InMethod)
+		{
+			FMethod TypedMethod;
+			FMemory::Memcpy(&TypedMethod, InMethod, sizeof(FMethod));
+			(static_cast<UserClass*>(InObject)->*TypedMethod)();
+		};
+		FMemory::Memcpy(Timer.Method, &Method, sizeof(FMethod));
+
+		ScheduleTimer(InOutHandle.Index, Rate, bLoop);
+	}
+
+	/** 清除定时器并使句柄失效 */
+	void ClearTimer(FShooterTimerHandle& InOutHandle);
+
+	/** 返回定时器是否仍在等待触发 */
+	bool IsTimerActive(const FShooterTimerHandle& Handle) const;
+
+	/** 返回定时器剩余时间（秒），不活跃时返回 -1 */
+	float GetTimerRemaining(const FShooterTimerHandle& Handle) const;
+
+	/** 返回活跃定时器数量 */
+	int32 GetNumActiveTimers() const { return NumActiveTimers; }
+
+	/** 返回上一帧推进和派发时间轮的耗时（秒） */
+	double GetLastTickSeconds() const { return LastTickSeconds; }
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Advances the wheel to the current world time and dispatches expired timers */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stat id for the tickable object */
+	virtual TStatId GetStatId() const override;
+
+	/** 用世界的 FTimerManager 设置定时器（没有定时器子系统时） */
+	static void SetFallbackTimer(const UObject* WorldContextObject, FShooterTimerHandle& InOutHandle, const FTimerDelegate& Delegate, float Rate, bool bLoop);
+
+	/** 从池中分配一个定时器并写入句柄 */
+	FShooterTimer& AllocateTimer(FShooterTimerHandle& OutHandle);
+
+	/** 归还定时器到池中 */
+	void FreeTimer(int32 Index);
+
+	/** 返回句柄对应的定时器，句柄失效时返回 nullptr */
+	const FShooterTimer* FindTimer(const FShooterTimerHandle& Handle) const;
+
+	/** 计算到期刻度并插入时间轮 */
+	void ScheduleTimer(int32 Index, float Rate, bool bLoop);
+
+	/** 按到期刻度把定时器插入对应层的槽位 */
+	void InsertTimer(int32 Index);
+
+	/** 把定时器从所在槽位摘下 */
+	void UnlinkTimer(int32 Index);
+
+	/** 时间轮前进一个刻度：下沉高层槽位，并收集到期的定时器 */
+	void AdvanceOneTick();
+
+	/** 派发收集到的到期定时器 */
+	void DispatchExpiredTimers();
+
+	/** 返回当前世界时间对应的刻度 */
+	uint64 GetWorldTick() const;
+
+	/** 定时器池 */
+	TArray<FShooterTimer> Timers;
+
+	/** 空闲链表头 */
+	int32 FirstFreeTimer = INDEX_NONE;
+
+	/** 各层各槽位的链表头 */
+	int32 SlotHeads[ShooterTimers::NumLevels * ShooterTimers::SlotsPerLevel];
+
+	/** 本次推进中到期的定时器（跨帧复用内存，派发前回调可能已清除它们） */
+	TArray<FShooterTimerHandle> ExpiredTimers;
+
+	/** 时间轮当前刻度 */
+	uint64 CurrentTick = 0;
+
+	/** 下一个序列号 */
+	uint32 NextSerial = 1;
+
+	/** 活跃定时器数量 */
+	int32 NumActiveTimers = 0;
+
+	/** 上一帧推进和派发时间轮的耗时（秒） */
+	double LastTickSeconds = 0.0;
+};
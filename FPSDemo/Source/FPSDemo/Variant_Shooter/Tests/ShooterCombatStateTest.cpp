@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ShooterCombatState.h"
+#include "Engine/NetSerialization.h"
+
+namespace ShooterCombatStateTest
+{
+	/** A state to send, and what the receiver should end up with */
+	struct FCase
+	{
+		const TCHAR* Name;
+		float HP;
+		uint8 TeamByte;
+		uint8 Flags;
+		float ExpectedHP;
+	};
+
+	static FShooterCombatState MakeState(float HP, uint8 TeamByte, uint8 Flags)
+	{
+		FShooterCombatState State;
+		State.SetHP(HP);
+		State.TeamByte = TeamByte;
+		State.Flags = Flags;
+		return State;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterCombatStateRoundTripTest, "FPSDemo.Shooter.CombatStateRoundTrip",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FShooterCombatStateRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace ShooterCombatStateTest;
+
+	const float MaxHP = MAX_uint16 / FShooterCombatState::HPScale;
+
+	const FCase Cases[] =
+	{
+		{ TEXT("spawned, invulnerable"), 500.0f, 0, ShooterCombatFlags::Invulnerable, 500.0f },
+		{ TEXT("alive, damaged"), 237.5f, 1, 0, 237.5f },
+		{ TEXT("alive, quantized"), 12.34f, 2, 0, 12.3f },
+		{ TEXT("alive, zero health"), 0.0f, 3, 0, 0.0f },
+		{ TEXT("largest small team"), 100.0f, 3, 0, 100.0f },
+		{ TEXT("smallest large team"), 100.0f, 4, 0, 100.0f },
+		{ TEXT("largest team"), 100.0f, 255, ShooterCombatFlags::Invulnerable, 100.0f },
+		{ TEXT("largest health"), MaxHP, 1, 0, MaxHP },
+		{ TEXT("health past the range"), MaxHP * 2.0f, 1, 0, MaxHP },
+		{ TEXT("dead drops health"), 42.0f, 1, ShooterCombatFlags::Dead, 0.0f },
+		{ TEXT("dead, invulnerable"), 0.0f, 200, ShooterCombatFlags::Dead | ShooterCombatFlags::Invulnerable, 0.0f }
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		FShooterCombatState Sent = MakeState(Case.HP, Case.TeamByte, Case.Flags);
+
+		FNetBitWriter Writer(nullptr, 256);
+		bool bWriteSuccess = false;
+		Sent.NetSerialize(Writer, nullptr, bWriteSuccess);
+
+		// the receiver's copy holds stale bits, which partial-byte reads must not leak into the result
+		FShooterCombatState Received;
+		Received.QuantizedHP = 1234;
+		Received.TeamByte = 0xFF;
+		Received.Flags = 0xFF;
+
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		bool bReadSuccess = false;
+		Received.NetSerialize(Reader, nullptr, bReadSuccess);
+
+		const FShooterCombatState Expected = MakeState(Case.ExpectedHP, Case.TeamByte, Case.Flags);
+
+		TestTrue(FString::Printf(TEXT("%s: serialized"), Case.Name), bWriteSuccess && bReadSuccess && !Writer.IsError() && !Reader.IsError());
+		TestEqual(FString::Printf(TEXT("%s: bits read"), Case.Name), Reader.GetPosBits(), Writer.GetNumBits());
+		TestEqual(FString::Printf(TEXT("%s: health"), Case.Name), Received.GetHP(), Expected.GetHP());
+		TestEqual(FString::Printf(TEXT("%s: team"), Case.Name), Received.TeamByte, Expected.TeamByte);
+		TestEqual(FString::Printf(TEXT("%s: flags"), Case.Name), Received.Flags, Expected.Flags);
+		TestTrue(FString::Printf(TEXT("%s: equal to the expected state"), Case.Name), Received == Expected);
+	}
+
+	// several states back to back in one bunch must each read exactly their own bits
+	{
+		FShooterCombatState First = MakeState(99.9f, 4, 0);
+		FShooterCombatState Second = MakeState(0.0f, 1, ShooterCombatFlags::Dead);
+
+		FNetBitWriter Writer(nullptr, 256);
+		bool bSuccess = true;
+		First.NetSerialize(Writer, nullptr, bSuccess);
+		Second.NetSerialize(Writer, nullptr, bSuccess);
+
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		FShooterCombatState ReadFirst;
+		FShooterCombatState ReadSecond;
+		ReadFirst.NetSerialize(Reader, nullptr, bSuccess);
+		ReadSecond.NetSerialize(Reader, nullptr, bSuccess);
+
+		TestTrue(TEXT("Back to back: first state"), ReadFirst == First);
+		TestTrue(TEXT("Back to back: second state"), ReadSecond == Second);
+		TestFalse(TEXT("Back to back: no read error"), Reader.IsError());
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,251 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ShooterCharacter.h"
+#include "ShooterPlayerController.h"
+#include "Weapons/ShooterWeapon.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectArray.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace ShooterRespawnTest
+{
+	/** The player pawn used by the shooter game mode */
+	static const TCHAR* CharacterClassPath = TEXT("/Game/Variant_Shooter/Blueprints/BP_ShooterCharacter.BP_ShooterCharacter_C");
+
+	/** A weapon given to the pawn before each recycle, to exercise the inventory reset */
+	static const TCHAR* WeaponClassPath = TEXT("/Game/Variant_Shooter/Blueprints/Pickups/Weapons/BP_ShooterWeapon_Rifle.BP_ShooterWeapon_Rifle_C");
+
+	/** Player starts placed for the controller's spawn point selection */
+	static constexpr int32 NumPlayerStarts = 10;
+
+	/** Respawns timed on each path */
+	static constexpr int32 NumRespawns = 50;
+
+	/** Cost of one respawn path */
+	struct FRespawnCost
+	{
+		double RespawnMs = 0.0;
+		int32 ObjectsCreated = 0;
+		int32 ObjectsCollected = 0;
+		double GCMs = 0.0;
+	};
+
+	/** Returns the number of live UObjects */
+	static int32 GetNumObjects()
+	{
+		return GUObjectArray.GetObjectArrayNumMinusAvailable();
+	}
+
+	/** Runs a full purge and records how long it took and how many objects it freed */
+	static void CollectAndMeasure(FRespawnCost& Cost)
+	{
+		const int32 NumBefore = GetNumObjects();
+		const double StartTime = FPlatformTime::Seconds();
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+		Cost.GCMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		Cost.ObjectsCollected = NumBefore - GetNumObjects();
+	}
+
+	/** Spawn point for a respawn, spread out so the teleport is never blocked */
+	static FTransform GetSpawnTransform(int32 Index)
+	{
+		return FTransform(FRotator(0.0f, Index * 30.0f, 0.0f), FVector((Index % 10) * 500.0f, (Index / 10) * 500.0f, 1000.0f));
+	}
+
+	/** Returns the number of live weapons owned by the character */
+	static int32 GetNumOwnedWeapons(UWorld* World, const AShooterCharacter* Character)
+	{
+		int32 NumWeapons = 0;
+		for (TActorIterator<AShooterWeapon> It(World); It; ++It)
+		{
+			NumWeapons += (IsValid(*It) && It->GetOwner() == Character) ? 1 : 0;
+		}
+
+		return NumWeapons;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterRespawnCostTest, "FPSDemo.Shooter.RespawnCost",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FShooterRespawnCostTest::RunTest(const FString& Parameters)
+{
+	using namespace ShooterRespawnTest;
+
+	UClass* CharacterClass = LoadClass<AShooterCharacter>(nullptr, CharacterClassPath);
+	UClass* WeaponClass = LoadClass<AShooterWeapon>(nullptr, WeaponClassPath);
+	if (!TestNotNull(TEXT("Shooter character class"), CharacterClass) || !TestNotNull(TEXT("Shooter weapon class"), WeaponClass))
+	{
+		return false;
+	}
+
+	// a standalone game world, so the character runs its authority paths.
+	// The game mode must exist before the actors are initialized, or BeginPlay is never dispatched
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ShooterRespawnTest"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->SetGameMode(FURL());
+	World->InitializeActorsForPlay(FURL());
+
+	// the spawn point subsystem collects the player starts when play begins
+	for (int32 Index = 0; Index < NumPlayerStarts; ++Index)
+	{
+		World->SpawnActor<APlayerStart>(APlayerStart::StaticClass(), GetSpawnTransform(NumRespawns + Index));
+	}
+
+	World->BeginPlay();
+
+	TestTrue(TEXT("World has begun play"), World->HasBegunPlay());
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// the old path: destroy the dead pawn and spawn a new one
+	FRespawnCost SpawnCost;
+	{
+		AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, GetSpawnTransform(0), SpawnParams);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+		const int32 NumBefore = GetNumObjects();
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Index = 1; Index <= NumRespawns && Character; ++Index)
+		{
+			Character->Destroy();
+			Character = World->SpawnActor<AShooterCharacter>(CharacterClass, GetSpawnTransform(Index), SpawnParams);
+		}
+
+		SpawnCost.RespawnMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumRespawns;
+		SpawnCost.ObjectsCreated = GetNumObjects() - NumBefore;
+
+		TestNotNull(TEXT("Spawned respawn"), Character);
+		CollectAndMeasure(SpawnCost);
+
+		if (Character)
+		{
+			Character->Destroy();
+		}
+	}
+
+	// the recycling path: reset and teleport the same pawn
+	FRespawnCost RecycleCost;
+	{
+		AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, GetSpawnTransform(0), SpawnParams);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+		const int32 NumBefore = GetNumObjects();
+		const double StartTime = FPlatformTime::Seconds();
+
+		int32 NumRecycled = 0;
+		for (int32 Index = 1; Index <= NumRespawns && Character; ++Index)
+		{
+			NumRecycled += Character->RecycleForRespawn(GetSpawnTransform(Index)) ? 1 : 0;
+		}
+
+		RecycleCost.RespawnMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumRespawns;
+		RecycleCost.ObjectsCreated = GetNumObjects() - NumBefore;
+
+		TestEqual(TEXT("Recycled respawns"), NumRecycled, NumRespawns);
+		TestTrue(TEXT("Recycled pawn is alive"), Character && !Character->IsDead());
+		CollectAndMeasure(RecycleCost);
+
+		if (Character)
+		{
+			Character->Destroy();
+		}
+	}
+
+	// the controller path used by the game: spawn point selection, pawn recycle, respawn event.
+	// Each life picks up a weapon first, so the inventory reset is timed and checked as well
+	FRespawnCost ControllerCost;
+	{
+		// the C++ controller has no widget classes, so its local HUD setup reports errors here
+		AddExpectedError(TEXT("Could not spawn"), EAutomationExpectedErrorFlags::Contains, 0);
+
+		AShooterPlayerController* Controller = World->SpawnActor<AShooterPlayerController>(AShooterPlayerController::StaticClass());
+		AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, GetSpawnTransform(0), SpawnParams);
+
+		if (TestNotNull(TEXT("Player controller"), Controller) && TestNotNull(TEXT("Controlled character"), Character))
+		{
+			Controller->Possess(Character);
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+			const int32 NumBefore = GetNumObjects();
+			const double StartTime = FPlatformTime::Seconds();
+
+			int32 NumRecycled = 0;
+			int32 NumWeaponsLeft = 0;
+			int32 NumFullMagazines = 0;
+
+			for (int32 Index = 1; Index <= NumRespawns; ++Index)
+			{
+				Character->AddWeaponClass(WeaponClass);
+
+				// a fresh life gets a fresh weapon, not the one carried into the previous death
+				for (TActorIterator<AShooterWeapon> It(World); It; ++It)
+				{
+					NumFullMagazines += (It->GetOwner() == Character && It->GetBulletCount() == It->GetMagazineSize()) ? 1 : 0;
+				}
+
+				NumRecycled += Controller->RecyclePawn(Character) ? 1 : 0;
+				NumWeaponsLeft += GetNumOwnedWeapons(World, Character);
+			}
+
+			ControllerCost.RespawnMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumRespawns;
+			ControllerCost.ObjectsCreated = GetNumObjects() - NumBefore;
+
+			TestEqual(TEXT("Controller recycled respawns"), NumRecycled, NumRespawns);
+			TestTrue(TEXT("Controller still possesses the recycled pawn"), Controller->GetPawn() == Character);
+			TestEqual(TEXT("Weapons left after recycling"), NumWeaponsLeft, 0);
+			TestEqual(TEXT("Weapons picked up with a full magazine"), NumFullMagazines, NumRespawns);
+			TestFalse(TEXT("Controller recycled pawn is dead"), Character->IsDead());
+			CollectAndMeasure(ControllerCost);
+
+			// don't let the controller respawn the pawn we're tearing down
+			Character->OnDestroyed.RemoveAll(Controller);
+			Controller->UnPossess();
+		}
+
+		if (Character)
+		{
+			Character->Destroy();
+		}
+
+		if (Controller)
+		{
+			Controller->Destroy();
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("Destroy/spawn: %.3f ms per respawn, %d UObjects created, GC freed %d in %.2f ms"),
+		SpawnCost.RespawnMs, SpawnCost.ObjectsCreated, SpawnCost.ObjectsCollected, SpawnCost.GCMs));
+
+	AddInfo(FString::Printf(TEXT("Recycle: %.3f ms per respawn, %d UObjects created, GC freed %d in %.2f ms"),
+		RecycleCost.RespawnMs, RecycleCost.ObjectsCreated, RecycleCost.ObjectsCollected, RecycleCost.GCMs));
+
+	AddInfo(FString::Printf(TEXT("Controller recycle with weapon pickup: %.3f ms per respawn, %d UObjects created, GC freed %d in %.2f ms"),
+		ControllerCost.RespawnMs, ControllerCost.ObjectsCreated, ControllerCost.ObjectsCollected, ControllerCost.GCMs));
+
+	// recycling must not leave garbage behind, which is the point of it
+	TestTrue(TEXT("Recycling creates fewer UObjects than destroy/spawn"), RecycleCost.ObjectsCreated < SpawnCost.ObjectsCreated);
+	TestTrue(TEXT("Recycling leaves less for the GC than destroy/spawn"), RecycleCost.ObjectsCollected < SpawnCost.ObjectsCollected);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "ShooterDamageSubsystem.h"
 #include "ShooterBulletCounterUI.generated.h"
 
 /**
@@ -23,4 +24,32 @@ public:
 	/** Allows Blueprint to update sub-widgets with the new life total and play a damage effect on the HUD */
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "Damaged"))
 	void BP_Damaged(float LifePercent);
+
+	/** Allows Blueprint to show hit markers for the hits confirmed by the server this frame */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "HitsConfirmed"))
+	void BP_HitsConfirmed(const TArray<FShooterHitConfirm>& Hits);
+
+	/** Allows Blueprint to show a kill feed message on a remote client */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "ShowKillFeed"))
+	void BP_ShowKillFeed(const FString& KillerName, const FString& VictimName);
+
+	/** Allows Blueprint to show the death screen on a remote client */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "ShowDeathScreen"))
+	void BP_ShowDeathScreen(const FString& KillerName, float RespawnTime);
+
+	/** Allows Blueprint to hide the death screen on a remote client */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "HideDeathScreen"))
+	void BP_HideDeathScreen();
+
+	/** Allows Blueprint to show the killcam overlay */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "KillcamStarted"))
+	void BP_KillcamStarted(float Duration);
+
+	/** Allows Blueprint to play a shot during the killcam */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "KillcamShot"))
+	void BP_KillcamShot(const FVector& Location, const FRotator& Rotation, bool bFromKiller);
+
+	/** Allows Blueprint to hide the killcam overlay */
+	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "KillcamEnded"))
+	void BP_KillcamEnded();
 };
@@ -5,6 +5,7 @@
 
 /** * 存放玩家数据的公共结构体
  * 将其放在单独的文件中，供 GameMode 和 UI 共同使用，避免重名冲突
+ * 以 PlayerState 的 PlayerId 为键（服务器和客户端一致，控制器指针在客户端无效）
  */
 USTRUCT(BlueprintType)
 struct FPlayerStats
@@ -12,7 +13,7 @@ struct FPlayerStats
 	GENERATED_BODY()
 
 	UPROPERTY(BlueprintReadOnly)
-	TObjectPtr<APlayerController> PlayerController = nullptr;
+	int32 PlayerId = INDEX_NONE;
 
 	UPROPERTY(BlueprintReadOnly)
 	int32 Kills = 0;
@@ -25,6 +26,6 @@ struct FPlayerStats
 
 	FPlayerStats() {}
 
-	FPlayerStats(APlayerController* InPC)
-		: PlayerController(InPC), Kills(0), Deaths(0), Assists(0) {}
+	FPlayerStats(int32 InPlayerId)
+		: PlayerId(InPlayerId), Kills(0), Deaths(0), Assists(0) {}
 };
\ No newline at end of file
@@ -2,4 +2,61 @@
 
 
 #include "ShooterUI.h"
+#include "ShooterGameState.h"
+#include "Engine/World.h"
 
+void UShooterUI::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (UWorld* World = GetWorld())
+	{
+		if (World->GetGameState())
+		{
+			BindMatchClock(World->GetGameState());
+		}
+		else
+		{
+			// clients can build the UI before the GameState replicates
+			GameStateSetHandle = World->GameStateSetEvent.AddUObject(this, &UShooterUI::BindMatchClock);
+		}
+	}
+}
+
+void UShooterUI::NativeDestruct()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GameStateSetEvent.Remove(GameStateSetHandle);
+		GameStateSetHandle.Reset();
+
+		if (AShooterGameState* ShooterGameState = World->GetGameState<AShooterGameState>())
+		{
+			ShooterGameState->OnRemainingTimeChanged.RemoveDynamic(this, &UShooterUI::OnRemainingTimeChanged);
+		}
+	}
+
+	Super::NativeDestruct();
+}
+
+void UShooterUI::BindMatchClock(AGameStateBase* GameState)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GameStateSetEvent.Remove(GameStateSetHandle);
+		GameStateSetHandle.Reset();
+	}
+
+	if (AShooterGameState* ShooterGameState = Cast<AShooterGameState>(GameState))
+	{
+		ShooterGameState->OnRemainingTimeChanged.AddUniqueDynamic(this, &UShooterUI::OnRemainingTimeChanged);
+
+		// the clock only broadcasts when the displayed second changes, so show the current time right away
+		BP_UpdateRemainingTime(ShooterGameState->GetRemainingTime());
+	}
+}
+
+void UShooterUI::OnRemainingTimeChanged(float RemainingTime)
+{
+	BP_UpdateRemainingTime(RemainingTime);
+}
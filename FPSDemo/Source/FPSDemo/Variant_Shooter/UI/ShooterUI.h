@@ -9,11 +9,13 @@
 
 // Forward declarations
 class APlayerController;
+class AGameStateBase;
 
 
 
 /**
  *  Simple scoreboard UI for a first person shooter game
+ *  Binds itself to the GameState's match clock, so the remaining time updates on whichever machine shows it
  */
 UCLASS(abstract)
 class FPSDEMO_API UShooterUI : public UUserWidget
@@ -58,4 +60,22 @@ public:
 	/** Hides game end screen (called when UI is initialized to ensure end screen is hidden) */
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta = (DisplayName = "Hide Game End Screen"))
 	void BP_HideGameEndScreen();
+
+protected:
+
+	/** Binds to the match clock */
+	virtual void NativeConstruct() override;
+
+	/** Unbinds from the match clock */
+	virtual void NativeDestruct() override;
+
+	/** Binds to the GameState's remaining time, once it exists */
+	void BindMatchClock(AGameStateBase* GameState);
+
+	/** Forwards the match clock to Blueprint */
+	UFUNCTION()
+	void OnRemainingTimeChanged(float RemainingTime);
+
+	/** Handle for the GameState set event, while waiting for the GameState to replicate */
+	FDelegateHandle GameStateSetHandle;
 };
@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterLatencyReportCommandlet.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "FPSDemo.h"
+
+UShooterLatencyReportCommandlet::UShooterLatencyReportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UShooterLatencyReportCommandlet::Main(const FString& Params)
+{
+	TArray<FString> FilePaths;
+
+	FString FileList;
+	if (FParse::Value(*Params, TEXT("files="), FileList))
+	{
+		FileList.ParseIntoArray(FilePaths, TEXT("+"));
+	}
+
+	// by default, everything the headless test dumped on exit
+	FString Directory = FPaths::ProjectSavedDir() / TEXT("Profiling");
+	FParse::Value(*Params, TEXT("dir="), Directory);
+
+	if (FilePaths.Num() == 0)
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *(Directory / TEXT("LatencyTrace_*.csv")), true, false);
+
+		for (const FString& FileName : FileNames)
+		{
+			FilePaths.Add(Directory / FileName);
+		}
+	}
+
+	if (FilePaths.Num() == 0)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Usage: -run=ShooterLatencyReport [-dir=<directory>] [-files=<a.csv+b.csv>]. No latency trace files found in %s."), *Directory);
+		return 1;
+	}
+
+	// samples per span, merged over all machines
+	TMap<FString, TArray<float>> SpanSamples;
+
+	for (const FString& FilePath : FilePaths)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath) || Lines.Num() == 0 || Lines[0] != TEXT("Span,Milliseconds"))
+		{
+			UE_LOG(LogFPSDemo, Error, TEXT("%s is not a latency trace file."), *FilePath);
+			return 1;
+		}
+
+		for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+		{
+			FString Span, Milliseconds;
+			if (Lines[LineIndex].Split(TEXT(","), &Span, &Milliseconds))
+			{
+				SpanSamples.FindOrAdd(Span).Add(FCString::Atof(*Milliseconds));
+			}
+		}
+
+		UE_LOG(LogFPSDemo, Display, TEXT("Read %d samples from %s"), Lines.Num() - 1, *FilePath);
+	}
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Input to hit latency over %d files:"), FilePaths.Num());
+
+	SpanSamples.KeySort(TLess<FString>());
+
+	for (TPair<FString, TArray<float>>& Pair : SpanSamples)
+	{
+		TArray<float>& Samples = Pair.Value;
+		Samples.Sort();
+
+		double Sum = 0.0;
+		for (float Sample : Samples)
+		{
+			Sum += Sample;
+		}
+
+		UE_LOG(LogFPSDemo, Display, TEXT("  %-20s n=%-7d mean=%8.2f p50=%8.2f p90=%8.2f p99=%8.2f max=%8.2f ms"),
+			*Pair.Key, Samples.Num(), Sum / Samples.Num(), ShooterStats::Percentile(Samples, 0.5f), ShooterStats::Percentile(Samples, 0.9f), ShooterStats::Percentile(Samples, 0.99f), Samples.Last());
+	}
+
+	return 0;
+}
@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterLatencyReportCommandlet.generated.h"
+
+/**
+ *  输入到命中延迟的汇总工具（多客户端无头测试用）
+ *  用法：UnrealEditor-Cmd FPSDemo -run=ShooterLatencyReport [-dir=<目录>] [-files=<a.csv+b.csv>]
+ *  合并服务器和所有客户端 Shooter.LatencyTrace.Dump 导出的 CSV，按耗时段输出总体分位数
+ */
+UCLASS()
+class UShooterLatencyReportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UShooterLatencyReportCommandlet();
+
+	/** Merges the files and logs the report */
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,311 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterLatencyTrace.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/MiscTrace.h"
+#include "FPSDemo.h"
+
+namespace ShooterLatencyTrace
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Shooter.LatencyTrace.Enable"),
+		bEnabled,
+		TEXT("Traces the first shot of every trigger pull from the fire input to the hit confirmation. Must be enabled on clients and server."));
+
+	static float Timeout = 5.0f;
+	static FAutoConsoleVariableRef CVarTimeout(
+		TEXT("Shooter.LatencyTrace.Timeout"),
+		Timeout,
+		TEXT("Seconds after which a traced shot that never got a hit confirmation (a miss) is dropped."));
+
+	static int32 MaxSamples = 100000;
+	static FAutoConsoleVariableRef CVarMaxSamples(
+		TEXT("Shooter.LatencyTrace.MaxSamples"),
+		MaxSamples,
+		TEXT("Maximum number of samples kept per span. Later samples are ignored until the next reset."));
+
+	static bool bDumpOnExit = false;
+	static FAutoConsoleVariableRef CVarDumpOnExit(
+		TEXT("Shooter.LatencyTrace.DumpOnExit"),
+		bDumpOnExit,
+		TEXT("Writes the latency samples to Saved/Profiling when the world is torn down. Used by headless multi-client tests."));
+
+	/** A duration between two stages recorded on the same machine */
+	struct FSpan
+	{
+		EShooterLatencyStage Start;
+		EShooterLatencyStage End;
+		const TCHAR* Name;
+	};
+
+	static const FSpan Spans[] =
+	{
+		{ EShooterLatencyStage::Input, EShooterLatencyStage::Replicated, TEXT("InputToProjectile") },
+		{ EShooterLatencyStage::Input, EShooterLatencyStage::ConfirmReceived, TEXT("InputToHitConfirm") },
+		{ EShooterLatencyStage::ServerReceive, EShooterLatencyStage::Spawn, TEXT("ReceiveToSpawn") },
+		{ EShooterLatencyStage::Spawn, EShooterLatencyStage::Hit, TEXT("ProjectileFlight") },
+		{ EShooterLatencyStage::Hit, EShooterLatencyStage::ConfirmSent, TEXT("HitToConfirmSent") },
+		{ EShooterLatencyStage::ServerReceive, EShooterLatencyStage::ConfirmSent, TEXT("ServerTotal") }
+	};
+
+	static const TCHAR* StageNames[(int32)EShooterLatencyStage::Num] =
+	{
+		TEXT("Input"), TEXT("ServerReceive"), TEXT("Spawn"), TEXT("Replicated"), TEXT("Hit"), TEXT("ConfirmSent"), TEXT("ConfirmReceived")
+	};
+
+	/** Insights region name for a span of one shot. Matches across client and server traces */
+	static FString GetRegionName(uint64 TraceId, const FSpan& Span)
+	{
+		return FString::Printf(TEXT("Shot %u:%u %s"), uint32(TraceId >> 32), uint32(TraceId), Span.Name);
+	}
+
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("Shooter.LatencyTrace.Report"),
+		TEXT("Logs the latency percentiles of every span measured on this machine."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UShooterLatencyTraceSubsystem* LatencyTrace = World ? World->GetSubsystem<UShooterLatencyTraceSubsystem>() : nullptr)
+			{
+				LatencyTrace->LogReport();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs DumpCommand(
+		TEXT("Shooter.LatencyTrace.Dump"),
+		TEXT("Writes the latency samples to a CSV file. Optional argument: output path."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (const UShooterLatencyTraceSubsystem* LatencyTrace = World ? World->GetSubsystem<UShooterLatencyTraceSubsystem>() : nullptr)
+			{
+				const FString FilePath = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("LatencyTrace_%s_%u.csv"), *FDateTime::Now().ToString(), FPlatformProcess::GetCurrentProcessId());
+				LatencyTrace->DumpToFile(FilePath);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("Shooter.LatencyTrace.Reset"),
+		TEXT("Clears the latency samples and the shots in flight."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterLatencyTraceSubsystem* LatencyTrace = World ? World->GetSubsystem<UShooterLatencyTraceSubsystem>() : nullptr)
+			{
+				LatencyTrace->Reset();
+			}
+		}));
+}
+
+bool UShooterLatencyTraceSubsystem::IsEnabled()
+{
+	return ShooterLatencyTrace::bEnabled;
+}
+
+uint64 UShooterLatencyTraceSubsystem::MakeTraceId(const APawn* Shooter, uint32 InputIndex)
+{
+	// PlayerIds are unique per server and replicated, so client and server build the same id
+	const APlayerState* PlayerState = Shooter ? Shooter->GetPlayerState() : nullptr;
+	if (!PlayerState || InputIndex == 0)
+	{
+		return 0;
+	}
+
+	return (uint64(uint32(PlayerState->GetPlayerId())) << 32) | InputIndex;
+}
+
+int32 UShooterLatencyTraceSubsystem::GetNumSpans()
+{
+	return UE_ARRAY_COUNT(ShooterLatencyTrace::Spans);
+}
+
+const TCHAR* UShooterLatencyTraceSubsystem::GetSpanName(int32 SpanIndex)
+{
+	return ShooterLatencyTrace::Spans[SpanIndex].Name;
+}
+
+bool UShooterLatencyTraceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterLatencyTraceSubsystem::Deinitialize()
+{
+	const bool bHasSamples = SpanSamples.ContainsByPredicate([](const TArray<float>& Samples) { return Samples.Num() > 0; });
+
+	if (bHasSamples)
+	{
+		LogReport();
+
+		if (ShooterLatencyTrace::bDumpOnExit)
+		{
+			DumpToFile(FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("LatencyTrace_%s_%u.csv"), *FDateTime::Now().ToString(), FPlatformProcess::GetCurrentProcessId()));
+		}
+	}
+
+	Reset();
+
+	Super::Deinitialize();
+}
+
+void UShooterLatencyTraceSubsystem::RecordStage(uint64 TraceId, EShooterLatencyStage Stage)
+{
+	using namespace ShooterLatencyTrace;
+
+	if (!IsEnabled() || TraceId == 0)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	// misses never reach the last stage, drop them once in a while
+	if (Now - LastEvictTime > 1.0)
+	{
+		EvictStaleTraces(Now);
+	}
+
+	FShooterLatencyTrace& Trace = ActiveTraces.FindOrAdd(TraceId);
+	if (Trace.RecordedStages == 0)
+	{
+		Trace.StartTime = Now;
+	}
+
+	// a listen server host sees some stages twice, keep the first
+	if (Trace.HasStage(Stage))
+	{
+		return;
+	}
+
+	Trace.StageTimes[(int32)Stage] = Now;
+	Trace.RecordedStages |= 1 << (uint8)Stage;
+
+	TRACE_BOOKMARK(TEXT("Shot %u:%u %s"), uint32(TraceId >> 32), uint32(TraceId), StageNames[(int32)Stage]);
+
+	if (SpanSamples.Num() == 0)
+	{
+		SpanSamples.SetNum(GetNumSpans());
+	}
+
+	for (int32 SpanIndex = 0; SpanIndex < GetNumSpans(); ++SpanIndex)
+	{
+		const FSpan& Span = Spans[SpanIndex];
+
+		if (Span.Start == Stage)
+		{
+			TRACE_BEGIN_REGION(*GetRegionName(TraceId, Span));
+		}
+		else if (Span.End == Stage && Trace.HasStage(Span.Start))
+		{
+			TRACE_END_REGION(*GetRegionName(TraceId, Span));
+
+			if (SpanSamples[SpanIndex].Num() < MaxSamples)
+			{
+				SpanSamples[SpanIndex].Add(float((Now - Trace.StageTimes[(int32)Span.Start]) * 1000.0));
+			}
+		}
+	}
+
+	// the shooter's hit confirmation ends the trace. A dedicated server never sees it
+	const bool bLastStage = Stage == EShooterLatencyStage::ConfirmReceived
+		|| (Stage == EShooterLatencyStage::ConfirmSent && GetWorld()->GetNetMode() == NM_DedicatedServer);
+
+	if (bLastStage)
+	{
+		const FShooterLatencyTrace FinishedTrace = Trace;
+		ActiveTraces.Remove(TraceId);
+		FinishTrace(TraceId, FinishedTrace);
+	}
+}
+
+void UShooterLatencyTraceSubsystem::EvictStaleTraces(double Now)
+{
+	LastEvictTime = Now;
+
+	for (auto It = ActiveTraces.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().StartTime > ShooterLatencyTrace::Timeout)
+		{
+			FinishTrace(It.Key(), It.Value());
+			It.RemoveCurrent();
+			++NumUnfinishedTraces;
+		}
+	}
+}
+
+void UShooterLatencyTraceSubsystem::FinishTrace(uint64 TraceId, const FShooterLatencyTrace& Trace)
+{
+	using namespace ShooterLatencyTrace;
+
+	// close the regions of spans that never ended, so Insights doesn't stretch them to the end of the capture
+	for (const FSpan& Span : Spans)
+	{
+		if (Trace.HasStage(Span.Start) && !Trace.HasStage(Span.End))
+		{
+			TRACE_END_REGION(*GetRegionName(TraceId, Span));
+		}
+	}
+}
+
+void UShooterLatencyTraceSubsystem::LogReport() const
+{
+	using namespace ShooterLatencyTrace;
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Latency trace (%s): %d shots in flight, %d timed out"),
+		GetWorld()->GetNetMode() == NM_Client ? TEXT("client") : TEXT("server"), ActiveTraces.Num(), NumUnfinishedTraces);
+
+	for (int32 SpanIndex = 0; SpanIndex < SpanSamples.Num(); ++SpanIndex)
+	{
+		TArray<float> Sorted = SpanSamples[SpanIndex];
+		if (Sorted.Num() == 0)
+		{
+			continue;
+		}
+
+		Sorted.Sort();
+
+		UE_LOG(LogFPSDemo, Display, TEXT("  %-20s n=%-7d p50=%8.2f p90=%8.2f p99=%8.2f max=%8.2f ms"),
+			Spans[SpanIndex].Name, Sorted.Num(), ShooterStats::Percentile(Sorted, 0.5f), ShooterStats::Percentile(Sorted, 0.9f), ShooterStats::Percentile(Sorted, 0.99f), Sorted.Last());
+	}
+}
+
+bool UShooterLatencyTraceSubsystem::DumpToFile(const FString& FilePath) const
+{
+	FString Csv = TEXT("Span,Milliseconds\n");
+
+	for (int32 SpanIndex = 0; SpanIndex < SpanSamples.Num(); ++SpanIndex)
+	{
+		for (float Sample : SpanSamples[SpanIndex])
+		{
+			Csv += FString::Printf(TEXT("%s,%.3f\n"), GetSpanName(SpanIndex), Sample);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *FilePath))
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not write latency trace file %s."), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogFPSDemo, Log, TEXT("Wrote latency samples to %s."), *FilePath);
+	return true;
+}
+
+void UShooterLatencyTraceSubsystem::Reset()
+{
+	for (const TPair<uint64, FShooterLatencyTrace>& Pair : ActiveTraces)
+	{
+		FinishTrace(Pair.Key, Pair.Value);
+	}
+
+	ActiveTraces.Empty();
+	SpanSamples.Empty();
+	NumUnfinishedTraces = 0;
+}
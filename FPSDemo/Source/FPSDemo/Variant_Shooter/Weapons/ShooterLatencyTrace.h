@@ -0,0 +1,120 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterLatencyTrace.generated.h"
+
+class APawn;
+
+/** 一次射击从输入到命中确认经过的阶段 */
+enum class EShooterLatencyStage : uint8
+{
+	/** 客户端：按下开火 */
+	Input,
+
+	/** 服务器：收到开火 RPC */
+	ServerReceive,
+
+	/** 服务器：生成投射物 */
+	Spawn,
+
+	/** 客户端：投射物复制到射击者 */
+	Replicated,
+
+	/** 服务器：投射物命中 */
+	Hit,
+
+	/** 服务器：命中确认批次发出 */
+	ConfirmSent,
+
+	/** 客户端：收到命中确认 */
+	ConfirmReceived,
+
+	Num
+};
+
+/** 一次追踪中的射击在本机记录到的阶段 */
+struct FShooterLatencyTrace
+{
+	/** 本机第一次记录到这次射击的时间（秒，FPlatformTime） */
+	double StartTime = 0.0;
+
+	/** 各阶段的本机时间（秒，FPlatformTime） */
+	double StageTimes[(int32)EShooterLatencyStage::Num] = {};
+
+	/** 已记录阶段的位掩码 */
+	uint8 RecordedStages = 0;
+
+	/** 返回阶段是否已记录 */
+	bool HasStage(EShooterLatencyStage Stage) const { return (RecordedStages & (1 << (uint8)Stage)) != 0; }
+};
+
+/**
+ *  输入到命中延迟追踪器
+ *  功能：
+ *  - 通过 Shooter.LatencyTrace.Enable 开启（客户端和服务器都需要开启，关闭时热路径上只多一次分支判断）
+ *  - 每次扣动扳机的第一发射击分配一个关联 ID（射击者 PlayerId + 输入序号），随开火 RPC、投射物、伤害和命中确认传递
+ *  - 每台机器只比较自己的时钟：客户端得到输入到投射物、输入到命中确认，服务器得到收到到生成、飞行、命中到确认
+ *  - 每个阶段输出 Unreal Insights 书签，每段耗时输出 Insights 区域（-trace=default,region,bookmark）
+ *  - Shooter.LatencyTrace.Report 输出本机各段的分位数，Shooter.LatencyTrace.Dump 导出 CSV，
+ *    多客户端无头测试中由 ShooterLatencyReport commandlet 合并所有机器的 CSV 输出总体分位数
+ */
+UCLASS()
+class FPSDEMO_API UShooterLatencyTraceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 返回追踪是否开启（热路径上唯一的开销） */
+	static bool IsEnabled();
+
+	/** 由射击者的 PlayerId 和本地输入序号组成关联 ID，射击者没有 PlayerState 时返回 0 */
+	static uint64 MakeTraceId(const APawn* Shooter, uint32 InputIndex);
+
+	/** 返回耗时段数量 */
+	static int32 GetNumSpans();
+
+	/** 返回耗时段名称（CSV 和报告中使用） */
+	static const TCHAR* GetSpanName(int32 SpanIndex);
+
+	/** 记录一个阶段（同一阶段只记录第一次），结束的耗时段加入统计 */
+	void RecordStage(uint64 TraceId, EShooterLatencyStage Stage);
+
+	/** 输出各耗时段的分位数 */
+	void LogReport() const;
+
+	/** 将各耗时段的样本写入 CSV 文件 */
+	bool DumpToFile(const FString& FilePath) const;
+
+	/** 清空进行中的追踪和样本 */
+	void Reset();
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Reports and optionally dumps the samples before the world goes away */
+	virtual void Deinitialize() override;
+
+	/** 结束超时的追踪（未命中的射击永远等不到确认） */
+	void EvictStaleTraces(double Now);
+
+	/** 结束追踪，关闭仍然打开的 Insights 区域 */
+	void FinishTrace(uint64 TraceId, const FShooterLatencyTrace& Trace);
+
+	/** 进行中的追踪 */
+	TMap<uint64, FShooterLatencyTrace> ActiveTraces;
+
+	/** 各耗时段的样本（毫秒） */
+	TArray<TArray<float>> SpanSamples;
+
+	/** 因超时结束的追踪数量 */
+	int32 NumUnfinishedTraces = 0;
+
+	/** 上次清理超时追踪的时间 */
+	double LastEvictTime = 0.0;
+};
@@ -7,8 +7,11 @@
 #include "Components/StaticMeshComponent.h"
 #include "ShooterWeaponHolder.h"
 #include "ShooterWeapon.h"
+#include "ShooterWeaponDefinition.h"
+#include "Engine/AssetManager.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
+#include "ShooterTimerSubsystem.h"
+#include "ShooterRoundSubsystem.h"
 
 AShooterPickup::AShooterPickup()
 {
@@ -42,7 +45,20 @@ void AShooterPickup::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
 
-	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
+	if (WeaponDefinitionId.IsValid())
+	{
+#if WITH_EDITOR
+		// preview the definition mesh in the editor only. Game worlds stream it in asynchronously
+		if (!GetWorld()->IsGameWorld() && UAssetManager::IsInitialized())
+		{
+			if (const UShooterWeaponDefinition* Definition = Cast<UShooterWeaponDefinition>(UAssetManager::Get().GetPrimaryAssetPath(WeaponDefinitionId).TryLoad()))
+			{
+				Mesh->SetStaticMesh(Definition->PickupMesh.LoadSynchronous());
+			}
+		}
+#endif // WITH_EDITOR
+
+	} else if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
 	{
 		// set the mesh
 		Mesh->SetStaticMesh(WeaponData->StaticMesh.LoadSynchronous());
@@ -53,11 +69,41 @@ void AShooterPickup::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
+	if (WeaponDefinitionId.IsValid())
+	{
+		// stream in the weapon definition. The pickup stays inert until it's loaded
+		DefinitionHandle = UShooterWeaponDefinition::LoadWeaponDefinition(GetWorld(), WeaponDefinitionId, FStreamableDelegate::CreateUObject(this, &AShooterPickup::OnWeaponDefinitionLoaded));
+
+	} else if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
 	{
 		// copy the weapon class
 		WeaponClass = WeaponData->WeaponToSpawn;
 	}
+
+	// round resets restore this pickup in place
+	if (UShooterRoundSubsystem* Round = GetWorld()->GetSubsystem<UShooterRoundSubsystem>())
+	{
+		Round->RegisterPickup(this);
+	}
+}
+
+void AShooterPickup::OnWeaponDefinitionLoaded()
+{
+	const UShooterWeaponDefinition* Definition = UAssetManager::Get().GetPrimaryAssetObject<UShooterWeaponDefinition>(WeaponDefinitionId);
+
+	if (!Definition)
+	{
+		return;
+	}
+
+	// copy the weapon class
+	WeaponClass = Definition->WeaponClass.Get();
+
+	// set the mesh. Not loaded on dedicated servers
+	if (UStaticMesh* PickupMesh = Definition->PickupMesh.Get())
+	{
+		Mesh->SetStaticMesh(PickupMesh);
+	}
 }
 
 void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -65,11 +111,29 @@ void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, RespawnTimer);
+
+	if (UShooterRoundSubsystem* Round = GetWorld()->GetSubsystem<UShooterRoundSubsystem>())
+	{
+		Round->UnregisterPickup(this);
+	}
+
+	// stop waiting on the definition bundles
+	if (DefinitionHandle.IsValid())
+	{
+		DefinitionHandle->CancelHandle();
+		DefinitionHandle.Reset();
+	}
 }
 
 void AShooterPickup::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	// ignore overlaps until the weapon definition has streamed in
+	if (!WeaponClass)
+	{
+		return;
+	}
+
 	// have we collided against a weapon holder?
 	if (IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(OtherActor))
 	{
@@ -85,7 +149,7 @@ void AShooterPickup::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 		SetActorTickEnabled(false);
 
 		// schedule the respawn
-		GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterPickup::RespawnPickup, RespawnTime, false);
+		UShooterTimerSubsystem::SetWorldTimer(RespawnTimer, this, &AShooterPickup::RespawnPickup, RespawnTime, false);
 	}
 }
 
@@ -106,3 +170,13 @@ void AShooterPickup::FinishRespawn()
 	// enable tick
 	SetActorTickEnabled(true);
 }
+
+void AShooterPickup::ResetForRound()
+{
+	// cancel a pending respawn
+	UShooterTimerSubsystem::ClearWorldTimer(this, RespawnTimer);
+
+	// show and enable the pickup right away
+	SetActorHiddenInGame(false);
+	FinishRespawn();
+}
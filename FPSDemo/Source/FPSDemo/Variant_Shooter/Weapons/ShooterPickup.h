@@ -6,6 +6,8 @@
 #include "GameFramework/Actor.h"
 #include "Engine/DataTable.h"
 #include "Engine/StaticMesh.h"
+#include "Engine/StreamableManager.h"
+#include "ShooterTimerSubsystem.h"
 #include "ShooterPickup.generated.h"
 
 class USphereComponent;
@@ -51,6 +53,13 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Pickup")
 	FDataTableRowHandle WeaponType;
 
+	/** 武器定义资产 ID。设置后优先于 WeaponType，武器类和拾取网格通过 AssetManager 异步加载 */
+	UPROPERTY(EditAnywhere, Category="Pickup", meta = (AllowedTypes = "ShooterWeapon"))
+	FPrimaryAssetId WeaponDefinitionId;
+
+	/** 保持武器定义 Bundle 处于加载状态的句柄 */
+	TSharedPtr<FStreamableHandle> DefinitionHandle;
+
 	/** Type to weapon to grant on pickup. Set from the weapon data table. */
 	TSubclassOf<AShooterWeapon> WeaponClass;
 	
@@ -59,7 +68,7 @@ protected:
 	float RespawnTime = 4.0f;
 
 	/** Timer to respawn the pickup */
-	FTimerHandle RespawnTimer;
+	FShooterTimerHandle RespawnTimer;
 
 public:	
 	
@@ -77,6 +86,9 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	/** 武器定义加载完成回调：设置武器类和拾取网格 */
+	void OnWeaponDefinitionLoaded();
+
 	/** Handles collision overlap */
 	UFUNCTION()
 	virtual void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -93,4 +105,9 @@ protected:
 	/** Enables this pickup after respawning */
 	UFUNCTION(BlueprintCallable, Category="Pickup")
 	void FinishRespawn();
+
+public:
+
+	/** 回合重置：取消重生定时器并立即恢复为可拾取状态（不播放重生动画） */
+	void ResetForRound();
 };
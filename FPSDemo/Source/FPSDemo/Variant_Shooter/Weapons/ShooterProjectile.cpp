@@ -11,8 +11,11 @@
 #include "GameFramework/Controller.h"
 #include "Engine/OverlapResult.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
+#include "ShooterTimerSubsystem.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "ShooterShotTrace.h"
+#include "ShooterLatencyTrace.h"
 
 AShooterProjectile::AShooterProjectile()
 {
@@ -47,6 +50,33 @@ void AShooterProjectile::BeginPlay()
 	
 	// ignore the pawn that shot this projectile
 	CollisionComponent->IgnoreActorWhenMoving(GetInstigator(), true);
+
+	// the shooter's client sees its traced shot arrive
+	if (LatencyTraceId != 0 && !HasAuthority())
+	{
+		if (UShooterLatencyTraceSubsystem* LatencyTrace = GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>())
+		{
+			LatencyTrace->RecordStage(LatencyTraceId, EShooterLatencyStage::Replicated);
+		}
+	}
+}
+
+void AShooterProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// set once before the first replication, only the shooter needs it
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_OwnerOnly;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterProjectile, LatencyTraceId, Params);
+}
+
+void AShooterProjectile::SetLatencyTraceId(uint64 TraceId)
+{
+	LatencyTraceId = TraceId;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterProjectile, LatencyTraceId, this);
 }
 
 void AShooterProjectile::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -54,7 +84,16 @@ void AShooterProjectile::EndPlay(EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the destruction timer
-	GetWorld()->GetTimerManager().ClearTimer(DestructionTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, DestructionTimer);
+
+	// a traced projectile that never hit anything expired
+	if (ShotTraceSequence != 0 && !bHit)
+	{
+		if (UShooterShotTraceSubsystem* ShotTrace = GetWorld()->GetSubsystem<UShooterShotTraceSubsystem>())
+		{
+			ShotTrace->SetOutcome(ShotTraceSequence, EShooterShotOutcome::Expired);
+		}
+	}
 }
 
 void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
@@ -73,6 +112,24 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 
 	bHit = true;
 
+	// the traced shot reached its target, the hit confirmation follows at the end of the frame
+	if (LatencyTraceId != 0)
+	{
+		if (UShooterLatencyTraceSubsystem* LatencyTrace = GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>())
+		{
+			LatencyTrace->RecordStage(LatencyTraceId, EShooterLatencyStage::Hit);
+		}
+	}
+
+	// record the shot outcome
+	if (ShotTraceSequence != 0)
+	{
+		if (UShooterShotTraceSubsystem* ShotTrace = GetWorld()->GetSubsystem<UShooterShotTraceSubsystem>())
+		{
+			ShotTrace->SetOutcome(ShotTraceSequence, Cast<APawn>(Other) ? EShooterShotOutcome::HitPawn : EShooterShotOutcome::HitWorld);
+		}
+	}
+
 	// disable collision on the projectile
 	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
@@ -98,7 +155,7 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 	// check if we should schedule deferred destruction of the projectile
 	if (DeferredDestructionTime > 0.0f)
 	{
-		GetWorld()->GetTimerManager().SetTimer(DestructionTimer, this, &AShooterProjectile::OnDeferredDestruction, DeferredDestructionTime, false);
+		UShooterTimerSubsystem::SetWorldTimer(DestructionTimer, this, &AShooterProjectile::OnDeferredDestruction, DeferredDestructionTime, false);
 
 	} else {
 
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "ShooterTimerSubsystem.h"
 #include "ShooterProjectile.generated.h"
 
 class USphereComponent;
@@ -73,13 +74,29 @@ protected:
 	float DeferredDestructionTime = 5.0f;
 
 	/** Timer to handle deferred destruction of this projectile */
-	FTimerHandle DestructionTimer;
+	FShooterTimerHandle DestructionTimer;
+
+	/** 射击追踪记录序号（0 = 未追踪） */
+	uint32 ShotTraceSequence = 0;
+
+	/** 延迟追踪关联 ID（0 = 未追踪），只复制给射击者 */
+	UPROPERTY(Replicated)
+	uint64 LatencyTraceId = 0;
 
 public:	
 
 	/** Constructor */
 	AShooterProjectile();
 
+	/** 设置射击追踪记录序号，命中或销毁时会回写结果 */
+	void SetShotTraceSequence(uint32 Sequence) { ShotTraceSequence = Sequence; }
+
+	/** 服务器端：设置延迟追踪关联 ID，命中时记录阶段并随伤害传到命中确认 */
+	void SetLatencyTraceId(uint64 TraceId);
+
+	/** 返回延迟追踪关联 ID */
+	uint64 GetLatencyTraceId() const { return LatencyTraceId; }
+
 protected:
 	
 	/** Gameplay initialization */
@@ -88,6 +105,9 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Get the lifetime replicated props */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Handles collision */
 	virtual void NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
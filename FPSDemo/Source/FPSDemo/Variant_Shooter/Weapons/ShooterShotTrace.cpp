@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterShotTrace.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Serialization/Archive.h"
+#include "FPSDemo.h"
+
+namespace ShooterShotTrace
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Shooter.ShotTrace.Enable"),
+		bEnabled,
+		TEXT("Records client aim, server aim, spawn transform, latency and outcome for every player shot. Must be enabled on clients and server."));
+
+	static int32 Capacity = 8192;
+	static FAutoConsoleVariableRef CVarCapacity(
+		TEXT("Shooter.ShotTrace.Capacity"),
+		Capacity,
+		TEXT("Number of shot records kept in the ring buffer. Applied the next time the buffer is reset."));
+
+	static FAutoConsoleCommandWithWorldAndArgs DumpCommand(
+		TEXT("Shooter.ShotTrace.Dump"),
+		TEXT("Writes the shot trace ring buffer to a binary file. Optional argument: output path."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (const UShooterShotTraceSubsystem* ShotTrace = World ? World->GetSubsystem<UShooterShotTraceSubsystem>() : nullptr)
+			{
+				const FString FilePath = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("ShotTrace_%s.bin"), *FDateTime::Now().ToString());
+				ShotTrace->DumpToFile(FilePath);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("Shooter.ShotTrace.Reset"),
+		TEXT("Clears the shot trace ring buffer."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UShooterShotTraceSubsystem* ShotTrace = World ? World->GetSubsystem<UShooterShotTraceSubsystem>() : nullptr)
+			{
+				ShotTrace->Reset();
+			}
+		}));
+}
+
+bool UShooterShotTraceSubsystem::IsEnabled()
+{
+	return ShooterShotTrace::bEnabled;
+}
+
+bool UShooterShotTraceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+uint32 UShooterShotTraceSubsystem::RecordShot(const FVector& ServerAim, const FTransform& SpawnTransform, uint16 ShotIndex, uint16 LatencyMs, const FVector* ClientAim)
+{
+	if (!IsEnabled())
+	{
+		return 0;
+	}
+
+	// allocate the ring buffer once, on first use
+	if (Records.Num() == 0)
+	{
+		Records.SetNum(FMath::Max(1, ShooterShotTrace::Capacity));
+	}
+
+	const uint32 Sequence = NextSequence++;
+	FShooterShotRecord& Record = Records[(Sequence - 1) % Records.Num()];
+
+	const FRotator SpawnRotation = SpawnTransform.Rotator();
+
+	Record.Sequence = Sequence;
+	Record.ServerTime = GetWorld()->GetTimeSeconds();
+	Record.ServerAim = FVector3f(ServerAim);
+	Record.SpawnLocation = FVector3f(SpawnTransform.GetLocation());
+	Record.SpawnPitch = FRotator::CompressAxisToShort(SpawnRotation.Pitch);
+	Record.SpawnYaw = FRotator::CompressAxisToShort(SpawnRotation.Yaw);
+	Record.LatencyMs = LatencyMs;
+	Record.ShotIndex = ShotIndex;
+	Record.Flags = 0;
+	Record.Outcome = (uint8)EShooterShotOutcome::Pending;
+	Record.ClientAim = FVector3f::ZeroVector;
+
+	if (ClientAim)
+	{
+		Record.ClientAim = FVector3f(*ClientAim);
+		Record.Flags |= ShooterShotTraceFlags::HasClientAim;
+	}
+
+	return Sequence;
+}
+
+void UShooterShotTraceSubsystem::SetClientAim(uint32 Sequence, const FVector& ClientAim)
+{
+	if (FShooterShotRecord* Record = FindRecord(Sequence))
+	{
+		Record->ClientAim = FVector3f(ClientAim);
+		Record->Flags |= ShooterShotTraceFlags::HasClientAim;
+	}
+}
+
+void UShooterShotTraceSubsystem::SetOutcome(uint32 Sequence, EShooterShotOutcome Outcome)
+{
+	if (FShooterShotRecord* Record = FindRecord(Sequence))
+	{
+		// keep the first resolved outcome
+		if (Record->Outcome == (uint8)EShooterShotOutcome::Pending)
+		{
+			Record->Outcome = (uint8)Outcome;
+		}
+	}
+}
+
+FShooterShotRecord* UShooterShotTraceSubsystem::FindRecord(uint32 Sequence)
+{
+	if (Sequence == 0 || Records.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// the slot may have been overwritten by a newer shot
+	FShooterShotRecord& Record = Records[(Sequence - 1) % Records.Num()];
+	return Record.Sequence == Sequence ? &Record : nullptr;
+}
+
+bool UShooterShotTraceSubsystem::DumpToFile(const FString& FilePath) const
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+
+	if (!Writer)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not open shot trace file %s for writing."), *FilePath);
+		return false;
+	}
+
+	// find the oldest record still in the buffer
+	const uint32 Capacity = Records.Num();
+	const uint32 LastSequence = NextSequence - 1;
+	const uint32 FirstSequence = LastSequence > Capacity ? LastSequence - Capacity + 1 : 1;
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	uint32 Count = Capacity > 0 ? LastSequence - FirstSequence + 1 : 0;
+
+	*Writer << Magic << Version << Count;
+
+	// write the records oldest first
+	for (uint32 Sequence = FirstSequence; Count > 0 && Sequence <= LastSequence; ++Sequence)
+	{
+		FShooterShotRecord Record = Records[(Sequence - 1) % Capacity];
+		*Writer << Record;
+	}
+
+	UE_LOG(LogFPSDemo, Log, TEXT("Wrote %u shot trace records to %s."), Count, *FilePath);
+
+	return Writer->Close();
+}
+
+void UShooterShotTraceSubsystem::Reset()
+{
+	Records.Empty();
+	NextSequence = 1;
+}
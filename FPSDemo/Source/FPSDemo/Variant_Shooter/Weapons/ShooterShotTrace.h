@@ -0,0 +1,130 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterShotTrace.generated.h"
+
+/** 射击结果 */
+enum class EShooterShotOutcome : uint8
+{
+	/** 投射物仍在飞行 */
+	Pending,
+
+	/** 击中了角色 */
+	HitPawn,
+
+	/** 击中了场景或其他物体 */
+	HitWorld,
+
+	/** 投射物在命中任何物体前被销毁 */
+	Expired
+};
+
+/** 射击记录标志位 */
+namespace ShooterShotTraceFlags
+{
+	/** 记录中包含客户端上报的瞄准点 */
+	constexpr uint8 HasClientAim = 1 << 0;
+}
+
+/**
+ *  一次服务器射击的紧凑记录
+ *  文件中逐字段序列化（见 operator<<），不依赖结构体内存布局
+ */
+struct FShooterShotRecord
+{
+	/** 全局递增的记录序号（0 表示无效） */
+	uint32 Sequence = 0;
+
+	/** 服务器开火时间（秒） */
+	float ServerTime = 0.0f;
+
+	/** 客户端计算的瞄准点 */
+	FVector3f ClientAim = FVector3f::ZeroVector;
+
+	/** 服务器计算的瞄准点 */
+	FVector3f ServerAim = FVector3f::ZeroVector;
+
+	/** 投射物生成位置 */
+	FVector3f SpawnLocation = FVector3f::ZeroVector;
+
+	/** 投射物生成朝向（Pitch/Yaw 量化为 16 位） */
+	uint16 SpawnPitch = 0;
+	uint16 SpawnYaw = 0;
+
+	/** 射击者连接的延迟（毫秒） */
+	uint16 LatencyMs = 0;
+
+	/** 武器本地射击计数（用于匹配客户端上报） */
+	uint16 ShotIndex = 0;
+
+	/** ShooterShotTraceFlags 位掩码 */
+	uint8 Flags = 0;
+
+	/** EShooterShotOutcome */
+	uint8 Outcome = (uint8)EShooterShotOutcome::Pending;
+
+	friend FArchive& operator<<(FArchive& Ar, FShooterShotRecord& Record)
+	{
+		Ar << Record.Sequence << Record.ServerTime;
+		Ar << Record.ClientAim << Record.ServerAim << Record.SpawnLocation;
+		Ar << Record.SpawnPitch << Record.SpawnYaw << Record.LatencyMs << Record.ShotIndex;
+		Ar << Record.Flags << Record.Outcome;
+		return Ar;
+	}
+};
+
+/**
+ *  射击登记追踪器
+ *  功能：
+ *  - 通过 Shooter.ShotTrace.Enable 开启（默认关闭，关闭时每次射击只多一次分支判断）
+ *  - 将每次服务器射击的客户端瞄准点、服务器瞄准点、生成变换、延迟和结果写入固定大小的环形缓冲区
+ *  - 通过 Shooter.ShotTrace.Dump 导出为二进制文件，由 ShooterShotTraceAnalyzer commandlet 离线分析
+ */
+UCLASS()
+class FPSDEMO_API UShooterShotTraceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 文件头魔数 'SHTR' */
+	static constexpr uint32 FileMagic = 0x52544853;
+
+	/** 文件格式版本 */
+	static constexpr uint32 FileVersion = 1;
+
+	/** 返回追踪是否开启（热路径上唯一的开销） */
+	static bool IsEnabled();
+
+	/** 记录一次服务器射击，返回记录序号（追踪关闭时返回 0） */
+	uint32 RecordShot(const FVector& ServerAim, const FTransform& SpawnTransform, uint16 ShotIndex, uint16 LatencyMs, const FVector* ClientAim);
+
+	/** 为已记录的射击补充客户端瞄准点（客户端上报晚于服务器开火时调用） */
+	void SetClientAim(uint32 Sequence, const FVector& ClientAim);
+
+	/** 更新已记录射击的结果 */
+	void SetOutcome(uint32 Sequence, EShooterShotOutcome Outcome);
+
+	/** 将缓冲区中的记录按时间顺序写入文件 */
+	bool DumpToFile(const FString& FilePath) const;
+
+	/** 清空缓冲区 */
+	void Reset();
+
+protected:
+
+	/** Only create for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** 按序号查找记录（已被覆盖时返回 nullptr） */
+	FShooterShotRecord* FindRecord(uint32 Sequence);
+
+	/** 环形缓冲区（首次记录时按 Shooter.ShotTrace.Capacity 分配） */
+	TArray<FShooterShotRecord> Records;
+
+	/** 下一个记录序号 */
+	uint32 NextSequence = 1;
+};
@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterShotTraceAnalyzerCommandlet.h"
+#include "ShooterShotTrace.h"
+#include "HAL/FileManager.h"
+#include "Misc/Parse.h"
+#include "FPSDemo.h"
+
+namespace ShooterShotTraceAnalyzer
+{
+	/** Logs the distribution of a set of error samples */
+	static void LogDistribution(const TCHAR* Label, TArray<float>& Samples, const TCHAR* Units)
+	{
+		if (Samples.Num() == 0)
+		{
+			UE_LOG(LogFPSDemo, Display, TEXT("  %-24s no samples"), Label);
+			return;
+		}
+
+		Samples.Sort();
+
+		double Sum = 0.0;
+		for (float Sample : Samples)
+		{
+			Sum += Sample;
+		}
+
+		UE_LOG(LogFPSDemo, Display, TEXT("  %-24s n=%-7d mean=%8.2f p50=%8.2f p90=%8.2f p99=%8.2f max=%8.2f %s"),
+			Label, Samples.Num(), Sum / Samples.Num(), ShooterStats::Percentile(Samples, 0.5f), ShooterStats::Percentile(Samples, 0.9f), ShooterStats::Percentile(Samples, 0.99f), Samples.Last(), Units);
+	}
+}
+
+UShooterShotTraceAnalyzerCommandlet::UShooterShotTraceAnalyzerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UShooterShotTraceAnalyzerCommandlet::Main(const FString& Params)
+{
+	using namespace ShooterShotTraceAnalyzer;
+
+	FString FilePath;
+	if (!FParse::Value(*Params, TEXT("file="), FilePath))
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Usage: -run=ShooterShotTraceAnalyzer -file=<ShotTrace.bin>"));
+		return 1;
+	}
+
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("Could not open %s."), *FilePath);
+		return 1;
+	}
+
+	// validate the header
+	uint32 Magic = 0, Version = 0, Count = 0;
+	*Reader << Magic << Version << Count;
+
+	if (Magic != UShooterShotTraceSubsystem::FileMagic || Version != UShooterShotTraceSubsystem::FileVersion)
+	{
+		UE_LOG(LogFPSDemo, Error, TEXT("%s is not a version %u shot trace file."), *FilePath, UShooterShotTraceSubsystem::FileVersion);
+		return 1;
+	}
+
+	// latency buckets, in milliseconds
+	static constexpr int32 NumLatencyBuckets = 5;
+	static const uint16 LatencyBucketLimits[NumLatencyBuckets] = { 50, 100, 150, 250, MAX_uint16 };
+	static const TCHAR* LatencyBucketNames[NumLatencyBuckets] = { TEXT("latency <50ms"), TEXT("latency 50-100ms"), TEXT("latency 100-150ms"), TEXT("latency 150-250ms"), TEXT("latency >250ms") };
+
+	TArray<float> DistanceErrors;
+	TArray<float> AngleErrors;
+	TArray<float> LatencyDistanceErrors[NumLatencyBuckets];
+	int32 OutcomeCounts[(int32)EShooterShotOutcome::Expired + 1] = {};
+	int32 MissingClientAim = 0;
+
+	DistanceErrors.Reserve(Count);
+	AngleErrors.Reserve(Count);
+
+	for (uint32 i = 0; i < Count && !Reader->AtEnd(); ++i)
+	{
+		FShooterShotRecord Record;
+		*Reader << Record;
+
+		if (Record.Outcome <= (uint8)EShooterShotOutcome::Expired)
+		{
+			++OutcomeCounts[Record.Outcome];
+		}
+
+		if (!(Record.Flags & ShooterShotTraceFlags::HasClientAim))
+		{
+			++MissingClientAim;
+			continue;
+		}
+
+		// distance between the aim points
+		const float DistanceError = FVector3f::Distance(Record.ClientAim, Record.ServerAim);
+		DistanceErrors.Add(DistanceError);
+
+		// angle between the aim directions as seen from the muzzle
+		const FVector3f ClientDir = (Record.ClientAim - Record.SpawnLocation).GetSafeNormal();
+		const FVector3f ServerDir = (Record.ServerAim - Record.SpawnLocation).GetSafeNormal();
+		AngleErrors.Add(FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(FVector3f::DotProduct(ClientDir, ServerDir), -1.0f, 1.0f))));
+
+		for (int32 Bucket = 0; Bucket < NumLatencyBuckets; ++Bucket)
+		{
+			if (Record.LatencyMs < LatencyBucketLimits[Bucket] || Bucket == NumLatencyBuckets - 1)
+			{
+				LatencyDistanceErrors[Bucket].Add(DistanceError);
+				break;
+			}
+		}
+	}
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Shot trace %s: %u shots, %d without client aim"), *FilePath, Count, MissingClientAim);
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Aim error (client vs server):"));
+	LogDistribution(TEXT("distance"), DistanceErrors, TEXT("cm"));
+	LogDistribution(TEXT("angle"), AngleErrors, TEXT("deg"));
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Aim distance error by latency:"));
+	for (int32 Bucket = 0; Bucket < NumLatencyBuckets; ++Bucket)
+	{
+		LogDistribution(LatencyBucketNames[Bucket], LatencyDistanceErrors[Bucket], TEXT("cm"));
+	}
+
+	UE_LOG(LogFPSDemo, Display, TEXT("Outcomes: pending %d, hit pawn %d, hit world %d, expired %d"),
+		OutcomeCounts[(int32)EShooterShotOutcome::Pending], OutcomeCounts[(int32)EShooterShotOutcome::HitPawn],
+		OutcomeCounts[(int32)EShooterShotOutcome::HitWorld], OutcomeCounts[(int32)EShooterShotOutcome::Expired]);
+
+	return 0;
+}
@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterShotTraceAnalyzerCommandlet.generated.h"
+
+/**
+ *  射击追踪离线分析工具
+ *  用法：UnrealEditor-Cmd FPSDemo -run=ShooterShotTraceAnalyzer -file=<ShotTrace.bin>
+ *  输出客户端/服务器瞄准误差分布（整体及按延迟分段）和射击结果统计
+ */
+UCLASS()
+class UShooterShotTraceAnalyzerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UShooterShotTraceAnalyzerCommandlet();
+
+	/** Runs the analysis */
+	virtual int32 Main(const FString& Params) override;
+};
@@ -6,12 +6,27 @@
 #include "Engine/World.h"
 #include "ShooterProjectile.h"
 #include "ShooterWeaponHolder.h"
+#include "ShooterWeaponDefinition.h"
+#include "ShooterShotTrace.h"
+#include "ShooterLatencyTrace.h"
+#include "ShooterTelemetry.h"
+#include "ShooterAnimationBudgetSubsystem.h"
+#include "ShooterKillcamSubsystem.h"
+#include "ShooterReplicationGraph.h"
+#include "FPSDemoCharacter.h"
+#include "ShooterCharacter.h"
+#include "GameFramework/PlayerState.h"
 #include "Components/SceneComponent.h"
-#include "TimerManager.h"
+#include "ShooterTimerSubsystem.h"
 #include "Animation/AnimInstance.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Engine/SkeletalMesh.h"
+#include "Animation/AnimMontage.h"
 #include "GameFramework/Pawn.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "FPSDemo.h"
 
 AShooterWeapon::AShooterWeapon()
 {
@@ -32,8 +47,11 @@ AShooterWeapon::AShooterWeapon()
 	FirstPersonMesh->SetFirstPersonPrimitiveType(EFirstPersonPrimitiveType::FirstPerson);
 	FirstPersonMesh->bOnlyOwnerSee = true;
 
-	// create the third person mesh
-	ThirdPersonMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Third Person Mesh"));
+	// create the third person mesh. It shares its owner's animation budget significance
+	USkeletalMeshComponentBudgeted* BudgetedMesh = CreateDefaultSubobject<USkeletalMeshComponentBudgeted>(TEXT("Third Person Mesh"));
+	BudgetedMesh->SetAutoRegisterWithBudgetAllocator(false);
+
+	ThirdPersonMesh = BudgetedMesh;
 	ThirdPersonMesh->SetupAttachment(RootComponent);
 
 	ThirdPersonMesh->SetCollisionProfileName(FName("NoCollision"));
@@ -54,20 +72,57 @@ void AShooterWeapon::BeginPlay()
 
 	// fill the first ammo clip
 	CurrentBullets = MagazineSize;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentBullets, this);
 
 	// attach the meshes to the owner
 	WeaponOwner->AttachWeaponMeshes(this);
+
+	// only keep the meshes this machine actually renders
+	UpdateMeshesForViewer();
+
+	// let the animation budget update the third person mesh at its owner's rate
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->RegisterComponent(Cast<ACharacter>(PawnOwner), ThirdPersonMesh);
+	}
+
+	// stream in the definition bundles needed on this machine
+	if (WeaponDefinition)
+	{
+		DefinitionHandle = UShooterWeaponDefinition::LoadWeaponDefinition(GetWorld(), WeaponDefinition->GetPrimaryAssetId(), FStreamableDelegate::CreateUObject(this, &AShooterWeapon::OnWeaponDefinitionLoaded));
+	}
 }
 
 void AShooterWeapon::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the refire timer
-	GetWorld()->GetTimerManager().ClearTimer(RefireTimer);
-	
-	// clear the reload timer
-	GetWorld()->GetTimerManager().ClearTimer(ReloadTimer);
+	// clear the refire and reload timers
+	UShooterTimerSubsystem::ClearWorldTimer(this, RefireTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, ReloadTimer);
+
+	// stop budgeting the third person mesh
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->UnregisterComponent(ThirdPersonMesh);
+	}
+
+	// stop waiting on the definition bundles
+	if (DefinitionHandle.IsValid())
+	{
+		DefinitionHandle->CancelHandle();
+		DefinitionHandle.Reset();
+	}
+}
+
+void AShooterWeapon::UpdateMeshesForViewer()
+{
+	// first person meshes are only seen by the owning player. The server still reads the muzzle socket from them, so they keep posing there
+	const AFPSDemoCharacter* OwnerCharacter = Cast<AFPSDemoCharacter>(PawnOwner);
+	AFPSDemoCharacter::SetMeshComponentRelevant(FirstPersonMesh, OwnerCharacter && OwnerCharacter->IsFirstPersonViewer(), HasAuthority());
+
+	// third person meshes are seen by remote players and cast the owner's shadow. Dedicated servers render neither
+	AFPSDemoCharacter::SetMeshComponentRelevant(ThirdPersonMesh, GetNetMode() != NM_DedicatedServer);
 }
 
 void AShooterWeapon::OnOwnerDestroyed(AActor* DestroyedActor)
@@ -76,11 +131,42 @@ void AShooterWeapon::OnOwnerDestroyed(AActor* DestroyedActor)
 	Destroy();
 }
 
+void AShooterWeapon::OnWeaponDefinitionLoaded()
+{
+	if (!WeaponDefinition || !IsValid(this))
+	{
+		return;
+	}
+
+	// apply the meshes. These are only loaded on machines that render
+	if (USkeletalMesh* LoadedFirstPersonMesh = WeaponDefinition->FirstPersonMesh.Get())
+	{
+		FirstPersonMesh->SetSkeletalMesh(LoadedFirstPersonMesh);
+	}
+
+	if (USkeletalMesh* LoadedThirdPersonMesh = WeaponDefinition->ThirdPersonMesh.Get())
+	{
+		ThirdPersonMesh->SetSkeletalMesh(LoadedThirdPersonMesh);
+	}
+
+	// if we're already active, let the owner pick up the streamed anim instance classes
+	if (WeaponOwner && !IsHidden())
+	{
+		WeaponOwner->OnWeaponActivated(this);
+	}
+}
+
 void AShooterWeapon::ActivateWeapon()
 {
 	// unhide this weapon
 	SetActorHiddenInGame(false);
 
+	// the weapon in hand replicates to everyone who sees its holder
+	if (HasAuthority())
+	{
+		UShooterReplicationGraph::SetWeaponActive(this, true);
+	}
+
 	// notify the owner
 	WeaponOwner->OnWeaponActivated(this);
 }
@@ -99,6 +185,12 @@ void AShooterWeapon::DeactivateWeapon()
 	// hide the weapon
 	SetActorHiddenInGame(true);
 
+	// holstered weapons only replicate to the owner
+	if (HasAuthority())
+	{
+		UShooterReplicationGraph::SetWeaponActive(this, false);
+	}
+
 	// notify the owner
 	WeaponOwner->OnWeaponDeactivated(this);
 }
@@ -122,7 +214,7 @@ void AShooterWeapon::StartFiring()
 		// if we're full auto, schedule the next shot
 		if (bFullAuto)
 		{
-			GetWorld()->GetTimerManager().SetTimer(RefireTimer, this, &AShooterWeapon::Fire, TimeSinceLastShot, false);
+			UShooterTimerSubsystem::SetWorldTimer(RefireTimer, this, &AShooterWeapon::Fire, TimeSinceLastShot, false);
 		}
 
 	}
@@ -133,8 +225,11 @@ void AShooterWeapon::StopFiring()
 	// lower the firing flag
 	bIsFiring = false;
 
+	// a trigger pull that never fired has nothing left to trace
+	PendingLatencyTraceId = 0;
+
 	// clear the refire timer
-	GetWorld()->GetTimerManager().ClearTimer(RefireTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, RefireTimer);
 }
 
 bool AShooterWeapon::CanReload() const
@@ -159,6 +254,7 @@ void AShooterWeapon::StartReload()
 
 	// Set reloading flag
 	bIsReloading = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, bIsReloading, this);
 
 	// Stop firing if we're firing
 	if (bIsFiring)
@@ -167,13 +263,13 @@ void AShooterWeapon::StartReload()
 	}
 
 	// Play reload montage
-	if (WeaponOwner && ReloadMontage)
+	if (WeaponOwner && GetReloadMontage())
 	{
-		WeaponOwner->PlayFiringMontage(ReloadMontage);
+		WeaponOwner->PlayFiringMontage(GetReloadMontage());
 	}
 
 	// Schedule reload completion
-	GetWorld()->GetTimerManager().SetTimer(ReloadTimer, this, &AShooterWeapon::ReloadComplete, ReloadTime, false);
+	UShooterTimerSubsystem::SetWorldTimer(ReloadTimer, this, &AShooterWeapon::ReloadComplete, ReloadTime, false);
 }
 
 void AShooterWeapon::StopReload()
@@ -186,9 +282,10 @@ void AShooterWeapon::StopReload()
 
 	// Clear reloading flag
 	bIsReloading = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, bIsReloading, this);
 
 	// Clear reload timer
-	GetWorld()->GetTimerManager().ClearTimer(ReloadTimer);
+	UShooterTimerSubsystem::ClearWorldTimer(this, ReloadTimer);
 }
 
 void AShooterWeapon::ReloadComplete()
@@ -201,9 +298,11 @@ void AShooterWeapon::ReloadComplete()
 
 	// Fill the magazine
 	CurrentBullets = MagazineSize;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentBullets, this);
 
 	// Clear reloading flag
 	bIsReloading = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, bIsReloading, this);
 
 	// Update the weapon HUD
 	if (WeaponOwner)
@@ -233,13 +332,35 @@ void AShooterWeapon::Fire()
 		StopFiring();
 		return;
 	}
+
+	// the definition's bundle may still be streaming in right after the weapon spawned.
+	// Hold the trigger pull without spending ammo and retry, rather than loading the class synchronously
+	if (!IsReadyToFire())
+	{
+		UShooterTimerSubsystem::SetWorldTimer(RefireTimer, this, &AShooterWeapon::Fire, RefireRate, false);
+		return;
+	}
 	
+	// count the shot on both client and server so shot traces can be matched up
+	++ShotCounter;
+
 	// fire a projectile at the target
-	FireProjectile(WeaponOwner->GetWeaponTargetLocation());
+	const FVector TargetLocation = WeaponOwner->GetWeaponTargetLocation();
+	FireProjectile(TargetLocation);
+
+	// report our local aim to the server so it can be compared against the server's
+	if (!HasAuthority() && UShooterShotTraceSubsystem::IsEnabled() && PawnOwner && PawnOwner->IsLocallyControlled())
+	{
+		ServerReportClientAim(ShotCounter, TargetLocation);
+	}
 
 	// update the time of our last shot
 	TimeOfLastShot = GetWorld()->GetTimeSeconds();
 
+	// shooters animate at a higher budget priority
+	ReportCombat();
+	ReportShot();
+
 	// make noise so the AI perception system can hear us
 	MakeNoise(ShotLoudness, PawnOwner, PawnOwner->GetActorLocation(), ShotNoiseRange, ShotNoiseTag);
 
@@ -247,11 +368,11 @@ void AShooterWeapon::Fire()
 	if (bFullAuto)
 	{
 		// schedule the next shot
-		GetWorld()->GetTimerManager().SetTimer(RefireTimer, this, &AShooterWeapon::Fire, RefireRate, false);
+		UShooterTimerSubsystem::SetWorldTimer(RefireTimer, this, &AShooterWeapon::Fire, RefireRate, false);
 	} else {
 
 		// for semi-auto weapons, schedule the cooldown notification
-		GetWorld()->GetTimerManager().SetTimer(RefireTimer, this, &AShooterWeapon::FireCooldownExpired, RefireRate, false);
+		UShooterTimerSubsystem::SetWorldTimer(RefireTimer, this, &AShooterWeapon::FireCooldownExpired, RefireRate, false);
 
 	}
 }
@@ -270,6 +391,14 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 		return;
 	}
 
+	// Fire waits for the projectile class, so this only trips on a misconfigured weapon
+	const TSubclassOf<AShooterProjectile> ProjectileType = GetProjectileClass();
+	if (!ProjectileType)
+	{
+		UE_LOG(LogFPSDemo, Warning, TEXT("%s: no projectile class, shot skipped."), *GetName());
+		return;
+	}
+
 	// get the projectile transform
 	FTransform ProjectileTransform = CalculateProjectileSpawnTransform(TargetLocation);
 	
@@ -280,16 +409,44 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 	SpawnParams.Owner = GetOwner();
 	SpawnParams.Instigator = PawnOwner;
 
-	AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(ProjectileClass, ProjectileTransform, SpawnParams);
+	AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(ProjectileType, ProjectileTransform, SpawnParams);
+
+	// record the shot for client/server discrepancy analysis
+	if (Projectile && UShooterShotTraceSubsystem::IsEnabled())
+	{
+		Projectile->SetShotTraceSequence(RecordShotTrace(TargetLocation, ProjectileTransform));
+	}
+
+	// match telemetry
+	if (Projectile)
+	{
+		if (UShooterTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UShooterTelemetrySubsystem>())
+		{
+			Telemetry->RecordCombat(EShooterTelemetryType::Shot, PawnOwner ? PawnOwner->GetController() : nullptr, nullptr, 0.0f, ProjectileTransform.GetLocation());
+		}
+	}
+
+	// carry the trigger pull's latency trace on its first projectile
+	if (Projectile && PendingLatencyTraceId != 0)
+	{
+		if (UShooterLatencyTraceSubsystem* LatencyTrace = GetWorld()->GetSubsystem<UShooterLatencyTraceSubsystem>())
+		{
+			LatencyTrace->RecordStage(PendingLatencyTraceId, EShooterLatencyStage::Spawn);
+		}
+
+		Projectile->SetLatencyTraceId(PendingLatencyTraceId);
+		PendingLatencyTraceId = 0;
+	}
 
 	// play the firing montage
-	WeaponOwner->PlayFiringMontage(FiringMontage);
+	WeaponOwner->PlayFiringMontage(GetFiringMontage());
 
 	// add recoil
 	WeaponOwner->AddWeaponRecoil(FiringRecoil);
 
 	// consume bullets
 	--CurrentBullets;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterWeapon, CurrentBullets, this);
 
 	// update the weapon HUD (will be replicated to clients via OnRep_CurrentBullets)
 	WeaponOwner->UpdateWeaponHUD(CurrentBullets, MagazineSize);
@@ -310,31 +467,204 @@ FTransform AShooterWeapon::CalculateProjectileSpawnTransform(const FVector& Targ
 	return FTransform(AimRot, SpawnLoc, FVector::OneVector);
 }
 
-const TSubclassOf<UAnimInstance>& AShooterWeapon::GetFirstPersonAnimInstanceClass() const
+uint32 AShooterWeapon::RecordShotTrace(const FVector& TargetLocation, const FTransform& ProjectileTransform)
+{
+	// only player shots have a client aim to compare against
+	if (!PawnOwner || !PawnOwner->IsPlayerControlled())
+	{
+		return 0;
+	}
+
+	UShooterShotTraceSubsystem* ShotTrace = GetWorld()->GetSubsystem<UShooterShotTraceSubsystem>();
+	if (!ShotTrace)
+	{
+		return 0;
+	}
+
+	const APlayerState* PlayerState = PawnOwner->GetPlayerState();
+	const uint16 LatencyMs = PlayerState ? static_cast<uint16>(FMath::Min(PlayerState->GetPingInMilliseconds(), (float)MAX_uint16)) : 0;
+
+	FShooterPendingShotAim& Pending = PendingShotAims[ShotCounter % NumPendingShotAims];
+
+	// locally controlled shots aim on the server, so both aims are the same.
+	// Otherwise use the client report if it arrived before this shot
+	const FVector* ClientAim = nullptr;
+
+	if (PawnOwner->IsLocallyControlled())
+	{
+		ClientAim = &TargetLocation;
+
+	} else if (Pending.ShotIndex == ShotCounter && Pending.bHasClientAim)
+	{
+		ClientAim = &Pending.ClientAim;
+	}
+
+	const uint32 Sequence = ShotTrace->RecordShot(TargetLocation, ProjectileTransform, ShotCounter, LatencyMs, ClientAim);
+
+	// remember the record so a late client report can fill it in
+	Pending.ShotIndex = ShotCounter;
+	Pending.RecordSequence = Sequence;
+	Pending.bHasRecord = true;
+	Pending.bHasClientAim = ClientAim != nullptr;
+
+	return Sequence;
+}
+
+void AShooterWeapon::ServerReportClientAim_Implementation(uint16 ShotIndex, FVector_NetQuantize10 ClientAim)
 {
+	// skip reports dropped by the owner connection's rate limit
+	AShooterCharacter* OwnerCharacter = Cast<AShooterCharacter>(PawnOwner);
+	if (OwnerCharacter && OwnerCharacter->ConsumeThrottledRPC(EShooterServerRPC::ReportClientAim))
+	{
+		return;
+	}
+
+	if (!UShooterShotTraceSubsystem::IsEnabled())
+	{
+		return;
+	}
+
+	FShooterPendingShotAim& Pending = PendingShotAims[ShotIndex % NumPendingShotAims];
+
+	// has the server already recorded this shot?
+	if (Pending.ShotIndex == ShotIndex && Pending.bHasRecord)
+	{
+		if (UShooterShotTraceSubsystem* ShotTrace = GetWorld()->GetSubsystem<UShooterShotTraceSubsystem>())
+		{
+			ShotTrace->SetClientAim(Pending.RecordSequence, ClientAim);
+		}
+
+		Pending.bHasClientAim = true;
+		return;
+	}
+
+	// hold on to the report until the server fires this shot
+	Pending.ShotIndex = ShotIndex;
+	Pending.RecordSequence = 0;
+	Pending.ClientAim = ClientAim;
+	Pending.bHasClientAim = true;
+	Pending.bHasRecord = false;
+}
+
+bool AShooterWeapon::ServerReportClientAim_Validate(uint16 ShotIndex, FVector_NetQuantize10 ClientAim)
+{
+	if (ClientAim.ContainsNaN())
+	{
+		return false;
+	}
+
+	// limited by the same per connection token buckets as the character's RPCs
+	AShooterCharacter* OwnerCharacter = Cast<AShooterCharacter>(PawnOwner);
+	return !OwnerCharacter || OwnerCharacter->CheckServerRPCRate(EShooterServerRPC::ReportClientAim);
+}
+
+TSubclassOf<AShooterProjectile> AShooterWeapon::GetProjectileClass() const
+{
+	if (WeaponDefinition && !WeaponDefinition->ProjectileClass.IsNull())
+	{
+		// the legacy reference covers the window before the definition's bundle has streamed in
+		if (UClass* LoadedClass = WeaponDefinition->ProjectileClass.Get())
+		{
+			return LoadedClass;
+		}
+	}
+
+	return ProjectileClass;
+}
+
+UAnimMontage* AShooterWeapon::GetReloadMontage() const
+{
+	if (WeaponDefinition && !WeaponDefinition->ReloadMontage.IsNull())
+	{
+		if (UAnimMontage* LoadedMontage = WeaponDefinition->ReloadMontage.Get())
+		{
+			return LoadedMontage;
+		}
+	}
+
+	return ReloadMontage;
+}
+
+UAnimMontage* AShooterWeapon::GetFiringMontage() const
+{
+	if (WeaponDefinition && !WeaponDefinition->FiringMontage.IsNull())
+	{
+		if (UAnimMontage* LoadedMontage = WeaponDefinition->FiringMontage.Get())
+		{
+			return LoadedMontage;
+		}
+	}
+
+	return FiringMontage;
+}
+
+TSubclassOf<UAnimInstance> AShooterWeapon::GetFirstPersonAnimInstanceClass() const
+{
+	// the anim classes are only in the Client bundle, so dedicated servers keep using the legacy reference
+	if (WeaponDefinition && !WeaponDefinition->FirstPersonAnimInstanceClass.IsNull())
+	{
+		if (UClass* LoadedClass = WeaponDefinition->FirstPersonAnimInstanceClass.Get())
+		{
+			return LoadedClass;
+		}
+	}
+
 	return FirstPersonAnimInstanceClass;
 }
 
-const TSubclassOf<UAnimInstance>& AShooterWeapon::GetThirdPersonAnimInstanceClass() const
+TSubclassOf<UAnimInstance> AShooterWeapon::GetThirdPersonAnimInstanceClass() const
 {
+	if (WeaponDefinition && !WeaponDefinition->ThirdPersonAnimInstanceClass.IsNull())
+	{
+		if (UClass* LoadedClass = WeaponDefinition->ThirdPersonAnimInstanceClass.Get())
+		{
+			return LoadedClass;
+		}
+	}
+
 	return ThirdPersonAnimInstanceClass;
 }
 
-void AShooterWeapon::OnRep_CurrentBullets()
+void AShooterWeapon::OnRep_CurrentBullets(int32 PreviousBullets)
 {
 	// Update HUD when bullet count changes on clients
 	if (WeaponOwner)
 	{
 		WeaponOwner->UpdateWeaponHUD(CurrentBullets, MagazineSize);
 	}
+
+	// remote shooters only tell us they fired through their ammo count
+	ReportCombat();
+
+	// a reload raises the count, only a drop is a shot
+	if (CurrentBullets < PreviousBullets)
+	{
+		ReportShot();
+	}
+}
+
+void AShooterWeapon::ReportCombat()
+{
+	if (UShooterAnimationBudgetSubsystem* AnimBudget = GetWorld()->GetSubsystem<UShooterAnimationBudgetSubsystem>())
+	{
+		AnimBudget->ReportCombat(PawnOwner);
+	}
+}
+
+void AShooterWeapon::ReportShot()
+{
+	if (UShooterKillcamSubsystem* Killcam = GetWorld()->GetSubsystem<UShooterKillcamSubsystem>())
+	{
+		Killcam->ReportShot(PawnOwner);
+	}
 }
 
 void AShooterWeapon::OnRep_IsReloading()
 {
 	// Play reload montage on clients if reloading
-	if (bIsReloading && WeaponOwner && ReloadMontage)
+	if (bIsReloading && WeaponOwner && GetReloadMontage())
 	{
-		WeaponOwner->PlayFiringMontage(ReloadMontage);
+		WeaponOwner->PlayFiringMontage(GetReloadMontage());
 	}
 }
 
@@ -342,6 +672,10 @@ void AShooterWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AShooterWeapon, CurrentBullets);
-	DOREPLIFETIME(AShooterWeapon, bIsReloading);
+	// push model: only properties explicitly marked dirty get compared
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterWeapon, CurrentBullets, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterWeapon, bIsReloading, Params);
 }
@@ -6,6 +6,9 @@
 #include "GameFramework/Actor.h"
 #include "ShooterWeaponHolder.h"
 #include "Animation/AnimInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/NetSerialization.h"
+#include "ShooterTimerSubsystem.h"
 #include "ShooterWeapon.generated.h"
 
 class IShooterWeaponHolder;
@@ -13,6 +16,26 @@ class AShooterProjectile;
 class USkeletalMeshComponent;
 class UAnimMontage;
 class UAnimInstance;
+class UShooterWeaponDefinition;
+
+/** 等待与服务器射击匹配的客户端瞄准上报（射击追踪用） */
+struct FShooterPendingShotAim
+{
+	/** 武器射击计数 */
+	uint16 ShotIndex = 0;
+
+	/** 服务器已写入的追踪记录序号 */
+	uint32 RecordSequence = 0;
+
+	/** 客户端上报的瞄准点 */
+	FVector ClientAim = FVector::ZeroVector;
+
+	/** 是否已收到客户端上报 */
+	bool bHasClientAim = false;
+
+	/** 服务器是否已记录这次射击 */
+	bool bHasRecord = false;
+};
 
 /**
  *  基础武器类
@@ -46,7 +69,14 @@ protected:
 	/** 武器持有者接口指针（玩家角色或 AI NPC） */
 	IShooterWeaponHolder* WeaponOwner;
 
-	/** 此武器发射的投射物类型 */
+	/** 武器定义资产。设置后投射物、网格和动画都从定义中按 Bundle 异步加载，下方的直接引用仅作为旧数据的回退 */
+	UPROPERTY(EditDefaultsOnly, Category="Weapon")
+	TObjectPtr<UShooterWeaponDefinition> WeaponDefinition;
+
+	/** 保持武器定义 Bundle 处于加载状态的句柄 */
+	TSharedPtr<FStreamableHandle> DefinitionHandle;
+
+	/** 此武器发射的投射物类型（旧数据，设置 WeaponDefinition 后应留空） */
 	UPROPERTY(EditAnywhere, Category="Ammo")
 	TSubclassOf<AShooterProjectile> ProjectileClass;
 
@@ -62,11 +92,11 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Ammo", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float ReloadTime = 2.0f;
 
-	/** Animation montage to play when reloading this weapon */
+	/** Animation montage to play when reloading this weapon. Legacy, leave empty when WeaponDefinition is set */
 	UPROPERTY(EditAnywhere, Category="Animation")
 	UAnimMontage* ReloadMontage;
 	
-	/** Animation montage to play when firing this weapon */
+	/** Animation montage to play when firing this weapon. Legacy, leave empty when WeaponDefinition is set */
 	UPROPERTY(EditAnywhere, Category="Animation")
 	UAnimMontage* FiringMontage;
 
@@ -113,10 +143,10 @@ protected:
 	bool bIsReloading = false;
 
 	/** Timer to handle full auto refiring */
-	FTimerHandle RefireTimer;
+	FShooterTimerHandle RefireTimer;
 
 	/** Timer to handle reload completion */
-	FTimerHandle ReloadTimer;
+	FShooterTimerHandle ReloadTimer;
 
 	/** Cast pawn pointer to the owner for AI perception system interactions */
 	TObjectPtr<APawn> PawnOwner;
@@ -133,6 +163,16 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Perception")
 	FName ShotNoiseTag = FName("Shot");
 
+	/** 射击计数（客户端和服务器各自递增，服务器在每次开火 RPC 时对齐到客户端的序号，用于匹配射击追踪记录） */
+	uint16 ShotCounter = 0;
+
+	/** 最近几次射击的客户端瞄准上报，按 ShotIndex 取模索引 */
+	static constexpr int32 NumPendingShotAims = 16;
+	FShooterPendingShotAim PendingShotAims[NumPendingShotAims];
+
+	/** 服务器端：下一发投射物携带的延迟追踪关联 ID（0 = 未追踪） */
+	uint64 PendingLatencyTraceId = 0;
+
 public:	
 
 	/** Constructor */
@@ -152,6 +192,9 @@ protected:
 	UFUNCTION()
 	void OnOwnerDestroyed(AActor* DestroyedActor);
 
+	/** 武器定义 Bundle 加载完成回调：应用网格并刷新持有者的动画蓝图 */
+	void OnWeaponDefinitionLoaded();
+
 public:
 
 	/** Activates this weapon and gets it ready to fire */
@@ -160,6 +203,9 @@ public:
 	/** Deactivates this weapon */
 	void DeactivateWeapon();
 
+	/** 按拥有者在本机的视角启用或停用第一/第三人称网格（拥有者的控制器变化时也会调用） */
+	void UpdateMeshesForViewer();
+
 	/** Start firing this weapon */
 	void StartFiring();
 
@@ -178,6 +224,18 @@ public:
 	/** Returns true if the weapon is currently reloading */
 	bool IsReloading() const { return bIsReloading; }
 
+	/** Returns true if the weapon is currently firing */
+	bool IsFiring() const { return bIsFiring; }
+
+	/** 返回下一发射击的序号（客户端随开火 RPC 发送给服务器） */
+	uint16 GetNextShotIndex() const { return ShotCounter + 1; }
+
+	/** 服务器端：把下一发射击的序号对齐到客户端，使客户端的瞄准上报与服务器的射击记录一一对应 */
+	void SetNextShotIndex(uint16 ShotIndex) { ShotCounter = ShotIndex - 1; }
+
+	/** 服务器端：让下一发投射物携带延迟追踪关联 ID（一次扣动扳机只追踪第一发） */
+	void SetLatencyTraceId(uint64 TraceId) { PendingLatencyTraceId = TraceId; }
+
 protected:
 
 	/** Fire the weapon */
@@ -195,6 +253,25 @@ protected:
 	/** Calculates the spawn transform for projectiles shot by this weapon */
 	FTransform CalculateProjectileSpawnTransform(const FVector& TargetLocation) const;
 
+	/** 服务器端：将本次射击写入射击追踪，返回记录序号 */
+	uint32 RecordShotTrace(const FVector& TargetLocation, const FTransform& ProjectileTransform);
+
+	/** 服务器 RPC：客户端上报本地计算的瞄准点（仅在开启射击追踪时发送） */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerReportClientAim(uint16 ShotIndex, FVector_NetQuantize10 ClientAim);
+
+	/** 返回投射物类型（优先使用武器定义中已加载的类型，否则回退到旧的直接引用，都没有时返回 nullptr） */
+	TSubclassOf<AShooterProjectile> GetProjectileClass() const;
+
+	/** 返回武器是否可以射击（投射物类型已可用）。Bundle 加载完成前射击会被推迟，不消耗弹药 */
+	bool IsReadyToFire() const { return GetProjectileClass() != nullptr; }
+
+	/** 返回换弹蒙太奇（Client Bundle 未加载且没有旧引用时返回 nullptr，例如专用服务器） */
+	UAnimMontage* GetReloadMontage() const;
+
+	/** 返回射击蒙太奇（Client Bundle 未加载且没有旧引用时返回 nullptr，例如专用服务器） */
+	UAnimMontage* GetFiringMontage() const;
+
 public:
 
 	/** Returns the first person mesh */
@@ -205,11 +282,14 @@ public:
 	UFUNCTION(BlueprintPure, Category="Weapon")
 	USkeletalMeshComponent* GetThirdPersonMesh() const { return ThirdPersonMesh; };
 
-	/** Returns the first person anim instance class */
-	const TSubclassOf<UAnimInstance>& GetFirstPersonAnimInstanceClass() const;
+	/** Returns the first person anim instance class, falling back to the legacy reference until the definition's is loaded */
+	TSubclassOf<UAnimInstance> GetFirstPersonAnimInstanceClass() const;
 
-	/** Returns the third person anim instance class */
-	const TSubclassOf<UAnimInstance>& GetThirdPersonAnimInstanceClass() const;
+	/** Returns the third person anim instance class, falling back to the legacy reference until the definition's is loaded */
+	TSubclassOf<UAnimInstance> GetThirdPersonAnimInstanceClass() const;
+
+	/** Returns the weapon definition asset, if any */
+	UShooterWeaponDefinition* GetWeaponDefinition() const { return WeaponDefinition; }
 
 	/** Returns the magazine size */
 	int32 GetMagazineSize() const { return MagazineSize; };
@@ -221,12 +301,18 @@ protected:
 
 	/** Replication function for CurrentBullets */
 	UFUNCTION()
-	void OnRep_CurrentBullets();
+	void OnRep_CurrentBullets(int32 PreviousBullets);
 
 	/** Replication function for bIsReloading */
 	UFUNCTION()
 	void OnRep_IsReloading();
 
+	/** Tells the animation budget that our owner is in combat */
+	void ReportCombat();
+
+	/** Tells the killcam buffer that our owner fired */
+	void ReportShot();
+
 	/** Get the lifetime replicated props */
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 };
@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterWeaponDefinition.h"
+#include "Engine/AssetManager.h"
+#include "Engine/World.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/StaticMesh.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/AnimInstance.h"
+#include "ShooterWeapon.h"
+#include "ShooterProjectile.h"
+#include "FPSDemo.h"
+
+const FPrimaryAssetType UShooterWeaponDefinition::WeaponAssetType = FName("ShooterWeapon");
+const FName UShooterWeaponDefinition::ServerBundle = FName("Server");
+const FName UShooterWeaponDefinition::ClientBundle = FName("Client");
+
+FPrimaryAssetId UShooterWeaponDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(WeaponAssetType, GetFName());
+}
+
+TArray<FName> UShooterWeaponDefinition::GetBundlesForWorld(const UWorld* World)
+{
+	TArray<FName> Bundles;
+
+	const ENetMode NetMode = World ? World->GetNetMode() : NM_Standalone;
+
+	// anything with authority runs the weapon logic
+	if (NetMode != NM_Client)
+	{
+		Bundles.Add(ServerBundle);
+	}
+
+	// anything that renders needs the visuals. Dedicated servers never load them
+	if (NetMode != NM_DedicatedServer)
+	{
+		Bundles.Add(ClientBundle);
+	}
+
+	return Bundles;
+}
+
+TSharedPtr<FStreamableHandle> UShooterWeaponDefinition::LoadWeaponDefinition(const UWorld* World, const FPrimaryAssetId& DefinitionId, FStreamableDelegate OnLoaded)
+{
+	if (!DefinitionId.IsValid() || !UAssetManager::IsInitialized())
+	{
+		UE_LOG(LogFPSDemo, Warning, TEXT("Could not load weapon definition %s."), *DefinitionId.ToString());
+		return nullptr;
+	}
+
+	// the asset manager calls the delegate right away if everything is already in memory
+	return UAssetManager::Get().LoadPrimaryAsset(DefinitionId, GetBundlesForWorld(World), MoveTemp(OnLoaded));
+}
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/StreamableManager.h"
+#include "ShooterWeaponDefinition.generated.h"
+
+class AShooterWeapon;
+class AShooterProjectile;
+class UAnimMontage;
+class UAnimInstance;
+class USkeletalMesh;
+class UStaticMesh;
+
+/**
+ *  武器定义（Primary Data Asset）
+ *  功能：
+ *  - 集中保存一种武器的所有资源引用（武器类、投射物、网格、动画）
+ *  - 所有引用都是软引用，并按 Asset Bundle 分组：
+ *    "Server" = 服务器运行游戏逻辑所需的数据（武器类、投射物类）
+ *    "Client" = 表现数据（网格、蒙太奇、动画蓝图），以及复制到客户端的投射物类（避免收到第一个投射物时同步加载）
+ *  - 通过 AssetManager 异步加载，专用服务器只加载 "Server" 包，不会加载任何动画或网格
+ */
+UCLASS(BlueprintType, Const)
+class FPSDEMO_API UShooterWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/** AssetManager 中武器定义的 Primary Asset 类型 */
+	static const FPrimaryAssetType WeaponAssetType;
+
+	/** 服务器游戏逻辑数据包名称 */
+	static const FName ServerBundle;
+
+	/** 客户端表现数据包名称 */
+	static const FName ClientBundle;
+
+	/** 武器显示名称 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Weapon")
+	FText DisplayName;
+
+	/** 拾取/装备时生成的武器 Actor 类型 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Weapon", meta = (AssetBundles = "Server,Client"))
+	TSoftClassPtr<AShooterWeapon> WeaponClass;
+
+	/** 武器发射的投射物类型（服务器生成投射物，客户端通过复制接收，两边都需要预加载） */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Weapon", meta = (AssetBundles = "Server,Client"))
+	TSoftClassPtr<AShooterProjectile> ProjectileClass;
+
+	/** 拾取物上显示的静态网格 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Visuals", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UStaticMesh> PickupMesh;
+
+	/** 第一人称武器骨骼网格 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Visuals", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<USkeletalMesh> FirstPersonMesh;
+
+	/** 第三人称武器骨骼网格 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Visuals", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<USkeletalMesh> ThirdPersonMesh;
+
+	/** 换弹动画蒙太奇 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Animation", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UAnimMontage> ReloadMontage;
+
+	/** 射击动画蒙太奇 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Animation", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UAnimMontage> FiringMontage;
+
+	/** 武器激活时第一人称角色网格使用的动画蓝图 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Animation", meta = (AssetBundles = "Client"))
+	TSoftClassPtr<UAnimInstance> FirstPersonAnimInstanceClass;
+
+	/** 武器激活时第三人称角色网格使用的动画蓝图 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Animation", meta = (AssetBundles = "Client"))
+	TSoftClassPtr<UAnimInstance> ThirdPersonAnimInstanceClass;
+
+public:
+
+	/** Returns the primary asset id used by the asset manager */
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	/** 根据世界的网络模式返回需要加载的 Bundle（专用服务器只加载 Server，纯客户端只加载 Client） */
+	static TArray<FName> GetBundlesForWorld(const UWorld* World);
+
+	/** 通过 AssetManager 异步加载武器定义及其对应的 Bundle，加载完成后执行回调 */
+	static TSharedPtr<FStreamableHandle> LoadWeaponDefinition(const UWorld* World, const FPrimaryAssetId& DefinitionId, FStreamableDelegate OnLoaded);
+};